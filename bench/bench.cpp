@@ -0,0 +1,224 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "random.h"
+#include "seq.h"
+
+namespace {
+
+struct entry {
+  std::string name;
+  bench::bench_fn fn;
+  std::vector<std::size_t> params;
+};
+
+void calibration(bench::state& state) {
+  std::uint64_t value{state.get_param()};
+  while (state.keep_running()) {
+    for (int step{0}; step < 1000; ++step) {
+      value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+      bench::do_not_optimize(value);
+    }
+  }
+  state.set_items(state.get_iterations() * 1000);
+}
+
+// the calibration always comes first, see bench::CALIBRATION
+std::vector<entry>& registry() {
+  static std::vector<entry> entries{
+      entry{bench::CALIBRATION, calibration, {1}}};
+  return entries;
+}
+
+bool matches(const std::string& name, const std::string& filter) {
+  if (name == bench::CALIBRATION) return true;
+  std::size_t start{0};
+  while (start <= filter.length()) {
+    std::size_t stop = filter.find(',', start);
+    if (stop == std::string::npos) stop = filter.length();
+    if (name.find(filter.substr(start, stop - start)) != std::string::npos)
+      return true;
+    start = stop + 1;
+  }
+  return false;
+}
+
+double run_once(const entry& curr, std::size_t param, std::size_t iterations,
+                const bench::options& opts, std::size_t& items) {
+  randomiser::seed(opts.seed);
+  bench::state run(param, iterations);
+  curr.fn(run);
+  items = run.get_items();
+  return std::max(run.get_elapsed_ns(), 1.0);
+}
+
+std::string json_escape(const std::string& text) {
+  std::string escaped;
+  for (char curr : text) {
+    if (curr == '"' || curr == '\\') escaped.push_back('\\');
+    escaped.push_back(curr);
+  }
+  return escaped;
+}
+
+}  // namespace
+
+bench::state::state(std::size_t param, std::size_t iterations)
+    : param{param}, iterations{iterations} {}
+
+bool bench::state::keep_running() {
+  if (this->done == 0 && !this->is_running) this->resume();
+  if (this->done++ < this->iterations) return true;
+  this->pause();
+  return false;
+}
+
+void bench::state::pause() {
+  if (!this->is_running) return;
+  this->elapsed += clock::now() - this->started;
+  this->is_running = false;
+}
+
+void bench::state::resume() {
+  if (this->is_running) return;
+  this->started = clock::now();
+  this->is_running = true;
+}
+
+double bench::state::get_elapsed_ns() const {
+  return std::chrono::duration<double, std::nano>(this->elapsed).count();
+}
+
+void bench::add(const std::string& name, bench::bench_fn fn,
+                const std::vector<std::size_t>& params) {
+  registry().push_back(entry{name, std::move(fn), params});
+}
+
+std::vector<bench::result> bench::run_all(const bench::options& opts) {
+  /* every run starts from the same seed, so inputs do not depend on which
+   * benchmarks were filtered out. The iteration count grows until a run
+   * takes at least min_time; the calibrating runs double as warm-up.
+   * Repetitions reuse that count and the median is reported.
+   */
+  std::vector<bench::result> results;
+  const double min_ns = opts.min_time * 1e9;
+  for (const entry& curr : registry()) {
+    if (!matches(curr.name, opts.filter)) continue;
+    for (std::size_t param : curr.params) {
+      if (param > opts.max_param) continue;
+      std::size_t iterations{1};
+      std::size_t items{0};
+      std::vector<double> samples{
+          run_once(curr, param, iterations, opts, items)};
+      while (samples.back() < min_ns && iterations < 1000000000) {
+        std::size_t estimate = static_cast<std::size_t>(
+            min_ns / samples.back() * iterations * 1.2);
+        iterations = std::clamp(estimate, iterations + 1, iterations * 100);
+        samples = {run_once(curr, param, iterations, opts, items)};
+      }
+      while (samples.size() < std::max<std::size_t>(opts.repetitions, 1)) {
+        samples.push_back(run_once(curr, param, iterations, opts, items));
+      }
+      std::sort(samples.begin(), samples.end());
+      double median = (samples.size() % 2)
+                          ? samples[samples.size() / 2]
+                          : (samples[samples.size() / 2 - 1] +
+                             samples[samples.size() / 2]) / 2;
+      double per_iter = median / iterations;
+      results.push_back(bench::result{curr.name, param, iterations, per_iter,
+                                      items ? items * 1e9 / median : 0.0});
+      std::cout << std::left << std::setw(32) << curr.name << std::right
+                << std::setw(12) << param << std::setw(12) << iterations
+                << std::setw(16) << std::fixed << std::setprecision(1)
+                << per_iter << " ns" << std::endl;
+    }
+  }
+  return results;
+}
+
+std::string bench::to_json(const std::vector<bench::result>& results,
+                           const bench::options& opts) {
+  std::ostringstream out;
+  std::time_t now = std::time(nullptr);
+  out << "{\n  \"context\": {\n"
+      << "    \"date\": " << now << ",\n"
+      << "    \"seed\": " << opts.seed << ",\n"
+      << "    \"min_time\": " << opts.min_time << ",\n"
+      << "    \"repetitions\": " << opts.repetitions << ",\n"
+      << "    \"inline_codons\": " << CODON_SEQ_INLINE_CODONS << "\n"
+      << "  },\n  \"benchmarks\": [";
+  out << std::setprecision(6) << std::fixed;
+  for (std::size_t idx{0}; idx < results.size(); ++idx) {
+    const bench::result& curr = results[idx];
+    out << ((idx) ? ",\n" : "\n") << "    {\"name\": \""
+        << json_escape(curr.name) << "\", \"param\": " << curr.param
+        << ", \"iterations\": " << curr.iterations
+        << ", \"ns_per_iter\": " << curr.ns_per_iter
+        << ", \"items_per_second\": " << curr.items_per_second << "}";
+  }
+  out << "\n  ],\n  \"exponents\": [";
+  std::vector<bench::exponent> exponents{bench::fit_exponents(results)};
+  for (std::size_t idx{0}; idx < exponents.size(); ++idx) {
+    out << ((idx) ? ",\n" : "\n") << "    {\"name\": \""
+        << json_escape(exponents[idx].name)
+        << "\", \"exponent\": " << exponents[idx].value << "}";
+  }
+  out << "\n  ]\n}\n";
+  return out.str();
+}
+
+std::vector<bench::exponent> bench::fit_exponents(
+    const std::vector<bench::result>& results) {
+  std::vector<bench::exponent> exponents;
+  std::size_t first{0};
+  while (first < results.size()) {
+    std::size_t last{first};
+    while (last < results.size() && results[last].name == results[first].name)
+      ++last;
+    if (last - first >= 3) {
+      double sum_x{0}, sum_y{0}, sum_xx{0}, sum_xy{0};
+      for (std::size_t idx{first}; idx < last; ++idx) {
+        double x = std::log(static_cast<double>(results[idx].param));
+        double y = std::log(results[idx].ns_per_iter);
+        sum_x += x;
+        sum_y += y;
+        sum_xx += x * x;
+        sum_xy += x * y;
+      }
+      double count = static_cast<double>(last - first);
+      double denominator = count * sum_xx - sum_x * sum_x;
+      if (denominator > 0) {
+        exponents.push_back(bench::exponent{
+            results[first].name,
+            (count * sum_xy - sum_x * sum_y) / denominator});
+      }
+    }
+    first = last;
+  }
+  return exponents;
+}
+
+const std::vector<std::size_t>& bench::seq_lengths() {
+  static const std::vector<std::size_t> lengths{
+      100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+  return lengths;
+}
+
+std::string bench::random_bases(std::size_t len) {
+  static const char alphabet[] = "AGCT";
+  std::string bases_str(len, 'A');
+  for (char& curr : bases_str) curr = alphabet[randomiser::get_int(0, 3)];
+  return bases_str;
+}
@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "codon.h"
+
+namespace {
+
+// every benchmark walks the same batch of random codons per iteration
+constexpr std::size_t BATCH_CODONS = 1024;
+
+std::vector<codon::Codon> random_codons(std::size_t amount) {
+  std::string bases_str{bench::random_bases(amount * 3)};
+  std::vector<codon::Codon> codons;
+  codons.reserve(amount);
+  for (std::size_t idx{0}; idx < amount; ++idx) {
+    codons.emplace_back(bases_str.substr(idx * 3, 3));
+  }
+  return codons;
+}
+
+void bench_codon_from_str(bench::state& state) {
+  std::string bases_str{bench::random_bases(state.get_param() * 3)};
+  std::vector<std::string> triplets;
+  for (std::size_t idx{0}; idx < state.get_param(); ++idx) {
+    triplets.push_back(bases_str.substr(idx * 3, 3));
+  }
+  while (state.keep_running()) {
+    for (const std::string& triplet : triplets) {
+      codon::Codon curr(triplet);
+      bench::do_not_optimize(curr);
+    }
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_codon_from_base(bench::state& state) {
+  std::vector<codon::Codon> codons{random_codons(state.get_param())};
+  while (state.keep_running()) {
+    for (const codon::Codon& source : codons) {
+      codon::Codon curr(source.get_base_at(1));
+      bench::do_not_optimize(curr);
+    }
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_codon_get_bases_len(bench::state& state) {
+  std::vector<codon::Codon> codons{random_codons(state.get_param())};
+  while (state.keep_running()) {
+    int total{0};
+    for (const codon::Codon& curr : codons) total += curr.get_bases_len();
+    bench::do_not_optimize(total);
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_codon_get_bases_str(bench::state& state) {
+  std::vector<codon::Codon> codons{random_codons(state.get_param())};
+  while (state.keep_running()) {
+    for (const codon::Codon& curr : codons) {
+      std::string bases_str{curr.get_bases_str()};
+      bench::do_not_optimize(bases_str);
+    }
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_codon_pop(bench::state& state) {
+  std::vector<codon::Codon> codons{random_codons(state.get_param())};
+  while (state.keep_running()) {
+    for (codon::Codon curr : codons) {
+      codon::base popped{curr.pop(2)};
+      bench::do_not_optimize(popped);
+    }
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_codon_squeeze(bench::state& state) {
+  // chains the expelled base through the batch like Seq's shifts do
+  std::vector<codon::Codon> codons{random_codons(state.get_param())};
+  codon::base hopping{codon::base::A};
+  while (state.keep_running()) {
+    for (codon::Codon& curr : codons) hopping = curr.squeeze_left(hopping);
+    for (codon::Codon& curr : codons) hopping = curr.squeeze_right(hopping);
+    bench::do_not_optimize(hopping);
+  }
+  state.set_items(state.get_iterations() * state.get_param() * 2);
+}
+
+}  // namespace
+
+void bench::register_codon_benches() {
+  bench::add("codon/from_str", bench_codon_from_str, {BATCH_CODONS});
+  bench::add("codon/from_base", bench_codon_from_base, {BATCH_CODONS});
+  bench::add("codon/get_bases_len", bench_codon_get_bases_len,
+             {BATCH_CODONS});
+  bench::add("codon/get_bases_str", bench_codon_get_bases_str,
+             {BATCH_CODONS});
+  bench::add("codon/pop", bench_codon_pop, {BATCH_CODONS});
+  bench::add("codon/squeeze", bench_codon_squeeze, {BATCH_CODONS});
+}
@@ -0,0 +1,97 @@
+#include <cstddef>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "fastq.h"
+#include "gzip.h"
+#include "pipeline.h"
+#include "seq.h"
+
+namespace {
+
+// reads per FASTQ file, 150 bp each like a typical short-read run
+const std::vector<std::size_t> FASTQ_READS{1000, 10000, 100000};
+constexpr std::size_t FASTQ_READ_LEN = 150;
+
+std::string make_fastq(std::size_t num_reads) {
+  std::string fastq;
+  std::string qualities(FASTQ_READ_LEN, 'F');
+  for (std::size_t idx{0}; idx < num_reads; ++idx) {
+    fastq += "@read_" + std::to_string(idx) + '\n';
+    fastq += bench::random_bases(FASTQ_READ_LEN);
+    fastq += "\n+\n" + qualities + '\n';
+  }
+  return fastq;
+}
+
+void bench_fastq_reader(bench::state& state) {
+  std::string fastq{make_fastq(state.get_param())};
+  codon::io::SeqRecord record;
+  while (state.keep_running()) {
+    state.pause();
+    std::istringstream in(fastq);
+    state.resume();
+    codon::io::FastqReader reader(in);
+    while (reader.next(record)) bench::do_not_optimize(record);
+  }
+  state.set_items(state.get_iterations() * state.get_param() *
+                  FASTQ_READ_LEN);
+}
+
+/* the same reads as BGZF, inflated on the shared pool while the reader
+ * parses; threads 1 inflates on the reading thread like plain gzip would
+ */
+void run_bgzf_reader(bench::state& state, unsigned threads) {
+  std::string fastq{make_fastq(state.get_param())};
+  std::string bgzf{codon::io::bgzf_compress(fastq)};
+  codon::io::SeqRecord record;
+  while (state.keep_running()) {
+    state.pause();
+    std::istringstream in(bgzf);
+    state.resume();
+    codon::io::DecompressStreambuf buffer(in, threads);
+    std::istream decompressed(&buffer);
+    decompressed.exceptions(std::ios::badbit);
+    codon::io::FastqReader reader(decompressed);
+    while (reader.next(record)) bench::do_not_optimize(record);
+  }
+  state.set_items(state.get_iterations() * state.get_param() *
+                  FASTQ_READ_LEN);
+}
+
+void bench_bgzf_serial(bench::state& state) { run_bgzf_reader(state, 1); }
+void bench_bgzf_parallel(bench::state& state) { run_bgzf_reader(state, 0); }
+
+// raw records and a fresh Seq per record, for comparison
+void bench_record_reader(bench::state& state) {
+  std::string fastq{make_fastq(state.get_param())};
+  codon::pipeline::RawRecord raw;
+  while (state.keep_running()) {
+    state.pause();
+    std::istringstream in(fastq);
+    state.resume();
+    codon::pipeline::RecordReader reader(in);
+    std::size_t index{0};
+    while (reader.next(raw)) {
+      codon::pipeline::Record record{
+          codon::pipeline::parse_record(raw, index++)};
+      bench::do_not_optimize(record);
+    }
+  }
+  state.set_items(state.get_iterations() * state.get_param() *
+                  FASTQ_READ_LEN);
+}
+
+}  // namespace
+
+void bench::register_io_benches() {
+  bench::add("io/fastq_reader", bench_fastq_reader, FASTQ_READS);
+  bench::add("io/record_reader", bench_record_reader, FASTQ_READS);
+  if (codon::io::has_zlib) {
+    bench::add("io/bgzf_serial", bench_bgzf_serial, FASTQ_READS);
+    bench::add("io/bgzf_parallel", bench_bgzf_parallel, FASTQ_READS);
+  }
+}
@@ -0,0 +1,103 @@
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+namespace {
+
+void print_usage() {
+  std::cerr << "usage: codon_bench [--filter=<substring>[,...]] "
+               "[--max-len=<bp>]\n"
+               "                   [--min-time=<seconds>] "
+               "[--repetitions=<n>] [--seed=<n>]\n"
+               "                   [--json=<file>] [--compare=<baseline>] "
+               "[--threshold=<fraction>]\n"
+               "sequence benchmarks run from 100 bp up to --max-len "
+               "(default 1000000, at most 100000000)\n"
+               "--compare exits with 1 if a benchmark got slower than the "
+               "baseline by more than --threshold (default 0.25)\n";
+}
+
+bool read_flag(const std::string& arg, const std::string& flag,
+               std::string& value) {
+  if (arg.rfind(flag + "=", 0) != 0) return false;
+  value = arg.substr(flag.length() + 1);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::options opts;
+  std::string json_path;
+  std::string baseline_path;
+  double threshold{0.25};
+  for (int idx{1}; idx < argc; ++idx) {
+    std::string arg{argv[idx]};
+    std::string value;
+    if (read_flag(arg, "--filter", value)) {
+      opts.filter = value;
+    } else if (read_flag(arg, "--max-len", value)) {
+      opts.max_param = std::strtoull(value.c_str(), nullptr, 10);
+    } else if (read_flag(arg, "--min-time", value)) {
+      opts.min_time = std::strtod(value.c_str(), nullptr);
+    } else if (read_flag(arg, "--repetitions", value)) {
+      opts.repetitions = std::strtoull(value.c_str(), nullptr, 10);
+    } else if (read_flag(arg, "--compare", value)) {
+      baseline_path = value;
+    } else if (read_flag(arg, "--threshold", value)) {
+      threshold = std::strtod(value.c_str(), nullptr);
+    } else if (read_flag(arg, "--seed", value)) {
+      opts.seed = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (read_flag(arg, "--json", value)) {
+      json_path = value;
+    } else {
+      print_usage();
+      return (arg == "--help" || arg == "-h") ? 0 : 1;
+    }
+  }
+
+  // fail early on a broken baseline instead of after the whole run
+  std::vector<bench::result> baseline;
+  if (!baseline_path.empty()) {
+    try {
+      baseline = bench::load_json(baseline_path);
+    } catch (const std::runtime_error& error) {
+      std::cerr << error.what() << "\n";
+      return 1;
+    }
+  }
+
+  bench::register_codon_benches();
+  bench::register_seq_benches();
+  bench::register_scaling_benches();
+  bench::register_io_benches();
+  std::vector<bench::result> results{bench::run_all(opts)};
+
+  std::vector<bench::exponent> exponents{bench::fit_exponents(results)};
+  if (!exponents.empty()) std::cout << "\ntime per call ~ param^k\n";
+  for (const bench::exponent& curr : exponents) {
+    std::cout << std::left << std::setw(32) << curr.name << std::right
+              << "k = " << std::fixed << std::setprecision(2) << curr.value
+              << "\n";
+  }
+
+  if (!json_path.empty()) {
+    std::ofstream out(json_path);
+    if (!out) {
+      std::cerr << "Could not open '" << json_path << "' for writing\n";
+      return 1;
+    }
+    out << bench::to_json(results, opts);
+  }
+  if (!baseline_path.empty()) {
+    std::cout << "\n";
+    if (bench::compare(baseline, results, threshold, std::cout)) return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,103 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "codon.h"
+#include "random.h"
+#include "seq.h"
+
+namespace {
+
+/* Each iteration applies one edit at a random position and undoes the
+ * length change with the opposite edit at another random position, so the
+ * sequence keeps its size while its layout fragments like under real
+ * variant application. Only the benchmarked edit is timed; positions are
+ * drawn while the timer is paused. Time per operation against length is
+ * fitted to length^k, see bench::fit_exponents().
+ */
+enum class edit_op { insert_base, pop_base, insert_codon, pop_codon };
+
+codon::locator random_locator(const codon::Seq& seq) {
+  std::size_t bases{seq.get_seq_trulen("bp")};
+  return seq.locate(randomiser::get_int(0, static_cast<int>(bases) - 1));
+}
+
+void apply(codon::Seq& seq, edit_op op, codon::locator locator) {
+  static const codon::Codon insert("GAT");
+  switch (op) {
+    case edit_op::insert_base:
+      seq.insert_base(codon::base::C, locator);
+      break;
+    case edit_op::pop_base:
+      bench::do_not_optimize(seq.pop_base(locator));
+      break;
+    case edit_op::insert_codon:
+      seq.insert_codon(insert, locator);
+      break;
+    case edit_op::pop_codon:
+      bench::do_not_optimize(seq.pop_codon(locator, 3));
+      break;
+  }
+}
+
+edit_op opposite(edit_op op) {
+  switch (op) {
+    case edit_op::insert_base:
+      return edit_op::pop_base;
+    case edit_op::pop_base:
+      return edit_op::insert_base;
+    case edit_op::insert_codon:
+      return edit_op::pop_codon;
+    default:
+      return edit_op::insert_codon;
+  }
+}
+
+template <edit_op op>
+void bench_scaling(bench::state& state) {
+  codon::Seq seq(bench::random_bases(state.get_param()));
+  while (state.keep_running()) {
+    state.pause();
+    codon::locator target{random_locator(seq)};
+    state.resume();
+    apply(seq, op, target);
+    state.pause();
+    apply(seq, opposite(op), random_locator(seq));
+    state.resume();
+  }
+  state.set_items(state.get_iterations());
+}
+
+void bench_scaling_mixed(bench::state& state) {
+  // all four edits in random order, the length is kept within 2x
+  codon::Seq seq(bench::random_bases(state.get_param()));
+  while (state.keep_running()) {
+    state.pause();
+    edit_op op{static_cast<edit_op>(randomiser::get_int(0, 3))};
+    std::size_t bases{seq.get_seq_trulen("bp")};
+    bool is_pop = (op == edit_op::pop_base || op == edit_op::pop_codon);
+    if ((is_pop && bases < state.get_param() / 2 + 3) ||
+        (!is_pop && bases > state.get_param() * 2)) {
+      op = opposite(op);
+    }
+    codon::locator target{random_locator(seq)};
+    state.resume();
+    apply(seq, op, target);
+  }
+  state.set_items(state.get_iterations());
+}
+
+}  // namespace
+
+void bench::register_scaling_benches() {
+  const std::vector<std::size_t>& lengths{bench::seq_lengths()};
+  bench::add("scaling/insert_base", bench_scaling<edit_op::insert_base>,
+             lengths);
+  bench::add("scaling/pop_base", bench_scaling<edit_op::pop_base>, lengths);
+  bench::add("scaling/insert_codon", bench_scaling<edit_op::insert_codon>,
+             lengths);
+  bench::add("scaling/pop_codon", bench_scaling<edit_op::pop_codon>,
+             lengths);
+  bench::add("scaling/mixed", bench_scaling_mixed, lengths);
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "codon.h"
+#include "seq.h"
+#include "wild_seq.h"
+
+namespace {
+
+/* reads per batch for the vector growth benchmarks. Reads are long enough
+ * to live on the heap, inline codons are always copied on relocation.
+ */
+const std::vector<std::size_t> BATCH_READS{1000, 10000, 100000};
+constexpr std::size_t READ_LEN = 3 * CODON_SEQ_INLINE_CODONS + 300;
+
+// locator of a base in the middle, for operations with a linear tail
+codon::locator middle_of(const codon::Seq& seq) {
+  return codon::locator(seq.get_seq_len() / 2, 2);
+}
+
+void bench_seq_parse(bench::state& state) {
+  std::string bases_str{bench::random_bases(state.get_param())};
+  while (state.keep_running()) {
+    codon::Seq seq(bases_str);
+    bench::do_not_optimize(seq);
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_seq_get_seq_str(bench::state& state) {
+  codon::Seq seq(bench::random_bases(state.get_param()));
+  while (state.keep_running()) {
+    std::string bases_str{seq.get_seq_str()};
+    bench::do_not_optimize(bases_str);
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+// random bases with a gap of 100 N every 1000 bases, like a scaffold
+std::string scaffold_of(std::size_t len) {
+  std::string symbols{bench::random_bases(len)};
+  for (std::size_t pos{900}; pos < len; pos += 1000) {
+    symbols.replace(pos, std::min<std::size_t>(100, len - pos),
+                    std::min<std::size_t>(100, len - pos), 'N');
+  }
+  return symbols;
+}
+
+void bench_wild_parse(bench::state& state) {
+  std::string symbols{scaffold_of(state.get_param())};
+  while (state.keep_running()) {
+    codon::WildSeq seq(symbols);
+    bench::do_not_optimize(seq);
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_wild_get_seq_str(bench::state& state) {
+  codon::WildSeq seq(scaffold_of(state.get_param()));
+  while (state.keep_running()) {
+    std::string symbols{seq.get_seq_str()};
+    bench::do_not_optimize(symbols);
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_seq_right_shift(bench::state& state) {
+  codon::Seq seq(bench::random_bases(state.get_param()));
+  while (state.keep_running()) {
+    seq.right_shift(0);
+    state.pause();
+    seq.left_shift(0);
+    state.resume();
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_seq_left_shift(bench::state& state) {
+  codon::Seq seq(bench::random_bases(state.get_param()));
+  while (state.keep_running()) {
+    state.pause();
+    seq.right_shift(0);
+    state.resume();
+    seq.left_shift(0);
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+void bench_seq_insert_base(bench::state& state) {
+  codon::Seq seq(bench::random_bases(state.get_param()));
+  codon::locator target{middle_of(seq)};
+  while (state.keep_running()) {
+    seq.insert_base(codon::base::G, target);
+    state.pause();
+    seq.pop_base(target);
+    state.resume();
+  }
+  state.set_items(state.get_iterations());
+}
+
+void bench_seq_insert_codon(bench::state& state) {
+  codon::Seq seq(bench::random_bases(state.get_param()));
+  codon::locator target{middle_of(seq)};
+  const codon::Codon insert("GAT");
+  while (state.keep_running()) {
+    seq.insert_codon(insert, target);
+    state.pause();
+    seq.pop_codon(target, 3);
+    state.resume();
+  }
+  state.set_items(state.get_iterations());
+}
+
+void bench_seq_pop_codon(bench::state& state) {
+  codon::Seq seq(bench::random_bases(state.get_param()));
+  codon::locator target{middle_of(seq)};
+  const codon::Codon insert("GAT");
+  while (state.keep_running()) {
+    codon::Codon popped{seq.pop_codon(target, 3)};
+    bench::do_not_optimize(popped);
+    state.pause();
+    seq.insert_codon(insert, target);
+    state.resume();
+  }
+  state.set_items(state.get_iterations());
+}
+
+/* pre-change behaviour of std::vector<Seq>: without a noexcept move every
+ * reallocation copies each sequence, which this wrapper reproduces
+ */
+struct copied_seq {
+  codon::Seq seq;
+
+  explicit copied_seq(const std::string& bases_str) : seq{bases_str} {}
+  copied_seq(const copied_seq& other) = default;
+  copied_seq(copied_seq&& other) : seq{other.seq} {}
+};
+
+template <typename T>
+void bench_vector_growth(bench::state& state) {
+  // parsing stays outside of the timed region, only hand-over and growth
+  std::vector<T> reads;
+  reads.reserve(state.get_param());
+  for (std::size_t idx{0}; idx < state.get_param(); ++idx) {
+    reads.emplace_back(bench::random_bases(READ_LEN));
+  }
+  while (state.keep_running()) {
+    std::vector<T> batch;
+    for (T& read : reads) batch.push_back(std::move(read));
+    bench::do_not_optimize(batch);
+    state.pause();
+    reads.swap(batch);
+    batch.clear();
+    state.resume();
+  }
+  state.set_items(state.get_iterations() * state.get_param());
+}
+
+}  // namespace
+
+void bench::register_seq_benches() {
+  const std::vector<std::size_t>& lengths{bench::seq_lengths()};
+  bench::add("seq/parse", bench_seq_parse, lengths);
+  bench::add("seq/get_seq_str", bench_seq_get_seq_str, lengths);
+  bench::add("seq/right_shift", bench_seq_right_shift, lengths);
+  bench::add("seq/left_shift", bench_seq_left_shift, lengths);
+  bench::add("seq/insert_base", bench_seq_insert_base, lengths);
+  bench::add("seq/insert_codon", bench_seq_insert_codon, lengths);
+  bench::add("seq/pop_codon", bench_seq_pop_codon, lengths);
+  bench::add("wild/parse", bench_wild_parse, lengths);
+  bench::add("wild/get_seq_str", bench_wild_get_seq_str, lengths);
+  bench::add("seq/vector_growth/move", bench_vector_growth<codon::Seq>,
+             BATCH_READS);
+  bench::add("seq/vector_growth/copy", bench_vector_growth<copied_seq>,
+             BATCH_READS);
+}
@@ -0,0 +1,213 @@
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+
+namespace {
+
+/* just enough JSON for the files written by bench::to_json: objects,
+ * arrays, strings without unicode escapes and numbers. Anything else
+ * is rejected with std::runtime_error.
+ */
+class json_reader {
+  const std::string& text;
+  std::size_t pos{0};
+
+ public:
+  explicit json_reader(const std::string& text) : text{text} {}
+
+  bool consume(char token) {
+    this->skip_space();
+    if (this->pos < this->text.length() && this->text[this->pos] == token) {
+      ++this->pos;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char token) {
+    if (!this->consume(token)) {
+      throw std::runtime_error("Malformed benchmark JSON: expected '" +
+                               std::string(1, token) + "' at offset " +
+                               std::to_string(this->pos) + ".");
+    }
+  }
+
+  std::string read_string() {
+    this->expect('"');
+    std::string value;
+    while (this->pos < this->text.length() && this->text[this->pos] != '"') {
+      if (this->text[this->pos] == '\\') ++this->pos;
+      if (this->pos < this->text.length())
+        value.push_back(this->text[this->pos++]);
+    }
+    this->expect('"');
+    return value;
+  }
+
+  double read_number() {
+    this->skip_space();
+    const char* first = this->text.c_str() + this->pos;
+    char* last{nullptr};
+    double value = std::strtod(first, &last);
+    if (last == first) {
+      throw std::runtime_error(
+          "Malformed benchmark JSON: expected a number at offset " +
+          std::to_string(this->pos) + ".");
+    }
+    this->pos += last - first;
+    return value;
+  }
+
+  void skip_value() {
+    if (this->consume('{')) {
+      this->for_each_member(
+          [this](const std::string&) { this->skip_value(); });
+    } else if (this->consume('[')) {
+      this->for_each_element([this] { this->skip_value(); });
+    } else if (this->peek() == '"') {
+      this->read_string();
+    } else {
+      this->read_number();
+    }
+  }
+
+  // call after the opening brace, fn has to consume the member's value
+  template <typename Fn>
+  void for_each_member(Fn fn) {
+    if (this->consume('}')) return;
+    do {
+      std::string key{this->read_string()};
+      this->expect(':');
+      fn(key);
+    } while (this->consume(','));
+    this->expect('}');
+  }
+
+  // call after the opening bracket, fn has to consume one element
+  template <typename Fn>
+  void for_each_element(Fn fn) {
+    if (this->consume(']')) return;
+    do {
+      fn();
+    } while (this->consume(','));
+    this->expect(']');
+  }
+
+ private:
+  void skip_space() {
+    while (this->pos < this->text.length() &&
+           std::isspace(static_cast<unsigned char>(this->text[this->pos])))
+      ++this->pos;
+  }
+
+  char peek() {
+    this->skip_space();
+    return (this->pos < this->text.length()) ? this->text[this->pos] : '\0';
+  }
+};
+
+using result_key = std::pair<std::string, std::size_t>;
+
+}  // namespace
+
+std::vector<bench::result> bench::load_json(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("Could not open '" + path + "'.");
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string text{buffer.str()};
+
+  std::vector<bench::result> results;
+  json_reader reader(text);
+  reader.expect('{');
+  reader.for_each_member([&](const std::string& key) {
+    if (key != "benchmarks") {
+      reader.skip_value();
+      return;
+    }
+    reader.expect('[');
+    reader.for_each_element([&] {
+      bench::result curr{"", 0, 0, 0.0, 0.0};
+      reader.expect('{');
+      reader.for_each_member([&](const std::string& field) {
+        if (field == "name") {
+          curr.name = reader.read_string();
+        } else if (field == "param") {
+          curr.param = static_cast<std::size_t>(reader.read_number());
+        } else if (field == "iterations") {
+          curr.iterations = static_cast<std::size_t>(reader.read_number());
+        } else if (field == "ns_per_iter") {
+          curr.ns_per_iter = reader.read_number();
+        } else if (field == "items_per_second") {
+          curr.items_per_second = reader.read_number();
+        } else {
+          reader.skip_value();
+        }
+      });
+      results.push_back(curr);
+    });
+  });
+  return results;
+}
+
+std::size_t bench::compare(const std::vector<bench::result>& baseline,
+                           const std::vector<bench::result>& current,
+                           double threshold, std::ostream& out) {
+  std::map<result_key, double> reference;
+  for (const bench::result& curr : baseline) {
+    reference[{curr.name, curr.param}] = curr.ns_per_iter;
+  }
+  // baseline timings are scaled to this machine when both calibrated
+  double scale{1.0};
+  for (const bench::result& curr : current) {
+    auto found = reference.find({bench::CALIBRATION, curr.param});
+    if (curr.name == bench::CALIBRATION && found != reference.end())
+      scale = curr.ns_per_iter / found->second;
+  }
+
+  out << std::left << std::setw(32) << "benchmark" << std::right
+      << std::setw(12) << "param" << std::setw(16) << "baseline ns"
+      << std::setw(16) << "current ns" << std::setw(10) << "change"
+      << "  status\n";
+  std::size_t regressions{0};
+  for (const bench::result& curr : current) {
+    if (curr.name == bench::CALIBRATION) continue;
+    out << std::left << std::setw(32) << curr.name << std::right
+        << std::setw(12) << curr.param << std::fixed << std::setprecision(1);
+    auto found = reference.find({curr.name, curr.param});
+    if (found == reference.end()) {
+      out << std::setw(16) << "-" << std::setw(16) << curr.ns_per_iter
+          << std::setw(10) << "-" << "  new\n";
+      continue;
+    }
+    double expected = found->second * scale;
+    double ratio = curr.ns_per_iter / expected;
+    const char* status = "ok";
+    if (ratio > 1.0 + threshold) {
+      status = "SLOWER";
+      ++regressions;
+    } else if (ratio < 1.0 / (1.0 + threshold)) {
+      status = "faster";
+    }
+    std::ostringstream change;
+    change << std::showpos << std::fixed << std::setprecision(1)
+           << (ratio - 1.0) * 100 << "%";
+    out << std::setw(16) << expected << std::setw(16) << curr.ns_per_iter
+        << std::setw(10) << change.str() << "  " << status << "\n";
+  }
+  out << "machine scale " << std::setprecision(3) << scale << ", threshold "
+      << std::setprecision(0) << threshold * 100 << "%, " << regressions
+      << " regression(s)\n";
+  return regressions;
+}
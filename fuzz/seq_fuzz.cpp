@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "codon.h"
+#include "seq.h"
+
+/* Differential fuzzing of codon::Seq against a std::string holding the same
+ * bases. A trace is a start sequence and a list of edits; positions are
+ * taken modulo the current length, so any subset of a trace still runs.
+ * After every step get_seq_str() and the length have to match the model.
+ *
+ * Standalone (default) it runs random traces and shrinks the first failing
+ * one before printing it. Built with CODON_LIBFUZZER the same traces are
+ * decoded from libFuzzer input and a mismatch aborts.
+ */
+
+namespace {
+
+enum class op_kind : std::uint8_t {
+  insert_base,
+  insert_codon,
+  pop_base,
+  pop_codon,
+  insert_seq,
+  erase,
+  left_shift,
+  right_shift,
+  compact,
+  num_kinds
+};
+
+/* pos with the top bit set picks a codon and a shift directly, like the
+ * unit tests do, which also reaches VOIDs and the room behind partial
+ * codons. Otherwise it is a base position handed to Seq::locate().
+ *
+ * arg is the base for insert_base, length and bases of the codon for
+ * insert_codon and insert_seq, size_cut for pop_codon and the length of
+ * an erase
+ */
+struct op {
+  op_kind kind;
+  std::uint32_t pos;
+  std::uint8_t arg;
+};
+
+struct trace {
+  std::string initial;
+  std::vector<op> ops;
+};
+
+struct failure {
+  std::size_t step;
+  std::string message;
+};
+
+constexpr char BASE_CHARS[4] = {'A', 'G', 'C', 'T'};
+constexpr std::uint32_t RAW_LOCATOR = 0x80000000u;
+
+struct target {
+  codon::locator locator;
+  std::size_t pos;
+};
+
+// bases in front of the locator, a shift behind a partial codon points past
+std::optional<target> pick(const codon::Seq& seq, std::size_t len,
+                           std::uint32_t pos) {
+  if (!(pos & RAW_LOCATOR)) return target{seq.locate(pos % len), pos % len};
+  std::size_t first{seq.get_first_idx()};
+  std::size_t idx{first + pos % (seq.get_last_idx() - first + 1)};
+  codon::locator locator(idx, 1 + static_cast<int>((pos >> 16) % 3));
+  if (!seq.is_locator_valid(locator)) return std::nullopt;
+  std::size_t before{0};
+  for (std::size_t curr{0}; curr < idx; ++curr) {
+    before += seq.get_codon_at(codon::locator(curr, 1)).get_bases_len();
+  }
+  int codon_len{seq.get_codon_at(codon::locator(idx, 1)).get_bases_len()};
+  return target{locator, before + std::min(locator.shift - 1, codon_len)};
+}
+
+std::string codon_bases(std::uint8_t arg) {
+  std::string bases;
+  for (int idx{0}; idx <= arg % 3; ++idx) {
+    bases.push_back(BASE_CHARS[(arg >> (2 + 2 * idx)) & 3]);
+  }
+  return bases;
+}
+
+// with the position as it is applied to seq
+std::string describe(const op& curr, const codon::Seq& seq, std::size_t len) {
+  std::string pos{" at " + std::to_string(curr.pos % len)};
+  if (curr.pos & RAW_LOCATOR) {
+    std::size_t first{seq.get_first_idx()};
+    pos = " at {" +
+          std::to_string(first +
+                         curr.pos % (seq.get_last_idx() - first + 1)) +
+          ", " + std::to_string(1 + (curr.pos >> 16) % 3) + "}";
+  }
+  switch (curr.kind) {
+    case op_kind::insert_base:
+      return "insert_base " + std::string(1, BASE_CHARS[curr.arg & 3]) + pos;
+    case op_kind::insert_codon:
+      return "insert_codon " + codon_bases(curr.arg) + pos;
+    case op_kind::pop_base:
+      return "pop_base" + pos;
+    case op_kind::pop_codon:
+      return "pop_codon " + std::to_string(1 + curr.arg % 3) + pos;
+    case op_kind::insert_seq:
+      return "insert_seq " + codon_bases(curr.arg) + codon_bases(~curr.arg) +
+             pos;
+    case op_kind::erase:
+      return "erase " + std::to_string(1 + curr.arg % 8) + pos;
+    case op_kind::left_shift:
+      return "left_shift";
+    case op_kind::right_shift:
+      return "right_shift";
+    default:
+      return "compact";
+  }
+}
+
+// applies curr to both, a step without room for it leaves both untouched
+void apply(codon::Seq& seq, std::string& model, const op& curr) {
+  std::size_t pos{curr.pos % model.length()};
+  switch (curr.kind) {
+    case op_kind::insert_base: {
+      std::optional<target> at{pick(seq, model.length(), curr.pos)};
+      if (!at) return;
+      seq.insert_base(static_cast<codon::base>(curr.arg & 3), at->locator);
+      model.insert(at->pos, 1, BASE_CHARS[curr.arg & 3]);
+      break;
+    }
+    case op_kind::insert_codon: {
+      std::optional<target> at{pick(seq, model.length(), curr.pos)};
+      if (!at) return;
+      std::string bases{codon_bases(curr.arg)};
+      seq.insert_codon(codon::Codon(bases), at->locator);
+      model.insert(at->pos, bases);
+      break;
+    }
+    case op_kind::pop_base: {
+      if (model.length() < 2) return;
+      codon::base popped{seq.pop_base(seq.locate(pos))};
+      if (codon::base_to_str(popped) != model[pos])
+        throw std::logic_error("pop_base returned the wrong base");
+      model.erase(pos, 1);
+      break;
+    }
+    case op_kind::pop_codon: {
+      std::size_t cut = 1 + curr.arg % 3;
+      std::optional<target> at{pick(seq, model.length(), curr.pos)};
+      if (!at || model.length() <= cut) return;
+      pos = at->pos;
+      codon::Codon popped{seq.pop_codon(at->locator, cut)};
+      std::string expected{model.substr(pos, cut)};
+      std::string popped_str{popped.is_empty() ? "" : popped.get_bases_str()};
+      if (popped_str != expected) {
+        throw std::logic_error("pop_codon returned '" + popped_str +
+                               "' instead of '" + expected + "'");
+      }
+      model.erase(pos, cut);
+      break;
+    }
+    case op_kind::insert_seq: {
+      std::optional<target> at{pick(seq, model.length(), curr.pos)};
+      if (!at) return;
+      std::string bases{codon_bases(curr.arg) + codon_bases(~curr.arg)};
+      seq.insert_seq(codon::Seq(bases), at->locator);
+      model.insert(at->pos, bases);
+      break;
+    }
+    case op_kind::erase: {
+      std::size_t len = 1 + curr.arg % 8;
+      if (pos + len > model.length() || model.length() <= len) return;
+      seq.erase(seq.locate(pos), seq.locate(pos + len - 1));
+      model.erase(pos, len);
+      break;
+    }
+    case op_kind::left_shift: {
+      // INFO: refused when every codon in front is full, the model agrees
+      try {
+        seq.left_shift(0);
+      } catch (const std::invalid_argument&) {
+      }
+      break;
+    }
+    case op_kind::right_shift: {
+      seq.right_shift(0);
+      break;
+    }
+    default: {
+      seq.compact();
+      break;
+    }
+  }
+}
+
+std::optional<failure> run(const trace& input) {
+  std::string model{input.initial};
+  try {
+    codon::Seq seq(model);
+    for (std::size_t step{0}; step < input.ops.size(); ++step) {
+      try {
+        apply(seq, model, input.ops[step]);
+      } catch (const std::exception& error) {
+        return failure{step, std::string("threw: ") + error.what()};
+      }
+      std::string actual{seq.get_seq_str()};
+      if (actual != model) {
+        return failure{step,
+                       "expected " + model + "\n           got " + actual};
+      }
+      if (seq.get_seq_trulen("bp") != model.length()) {
+        return failure{step, "get_seq_trulen(\"bp\") is " +
+                                 std::to_string(seq.get_seq_trulen("bp")) +
+                                 " for " + std::to_string(model.length()) +
+                                 " bases"};
+      }
+    }
+  } catch (const std::exception& error) {
+    return failure{0, std::string("construction threw: ") + error.what()};
+  }
+  return std::nullopt;
+}
+
+/* removes chunks of ops, halving the chunk size down to single ops, then
+ * trims the start sequence. Any failure counts, not only the original one.
+ */
+[[maybe_unused]] trace minimize(trace input) {
+  std::optional<failure> found{run(input)};
+  input.ops.resize(found->step + 1);
+  // fixes positions to what they were, removing ops then moves them less
+  std::string model{input.initial};
+  codon::Seq seq(model);
+  for (op& curr : input.ops) {
+    if (!(curr.pos & RAW_LOCATOR)) curr.pos %= model.length();
+    try {
+      apply(seq, model, curr);
+    } catch (const std::exception&) {
+      break;
+    }
+  }
+  for (std::size_t chunk{input.ops.size() / 2}; chunk; chunk /= 2) {
+    std::size_t start{0};
+    while (start < input.ops.size()) {
+      trace candidate{input};
+      candidate.ops.erase(
+          candidate.ops.begin() + start,
+          candidate.ops.begin() +
+              std::min(start + chunk, candidate.ops.size()));
+      if (run(candidate)) {
+        input = std::move(candidate);
+      } else {
+        start += chunk;
+      }
+    }
+  }
+  bool shrunk{true};
+  while (shrunk && input.initial.length() > 1) {
+    shrunk = false;
+    for (std::size_t pos : {input.initial.length() - 1, std::size_t{0}}) {
+      trace candidate{input};
+      candidate.initial.erase(pos, 1);
+      if (run(candidate)) {
+        input = std::move(candidate);
+        shrunk = true;
+        break;
+      }
+    }
+  }
+  return input;
+}
+
+// codons separated by '|', VOID included
+std::string layout(const codon::Seq& seq) {
+  std::string codons;
+  for (std::size_t idx{0}; idx < seq.get_seq_len(); ++idx) {
+    if (idx) codons.push_back('|');
+    codons += seq.get_codon_at(codon::locator(idx, 1)).get_bases_str();
+  }
+  return codons;
+}
+
+// replays the trace up to the failing step with the layout after each op
+void print(const trace& input, const failure& found, std::ostream& out) {
+  std::string model{input.initial};
+  codon::Seq seq(model);
+  out << "Seq(\"" << input.initial << "\")\n        " << layout(seq) << "\n";
+  for (std::size_t step{0}; step <= found.step && step < input.ops.size();
+       ++step) {
+    out << "  [" << step << "] "
+        << describe(input.ops[step], seq, model.length()) << "\n";
+    try {
+      apply(seq, model, input.ops[step]);
+      out << "        " << layout(seq) << "\n";
+    } catch (const std::exception& error) {
+      break;
+    }
+  }
+  out << "step " << found.step << ": " << found.message << "\n";
+}
+
+/* one byte start length, one byte per start base, four bytes per op.
+ * The low nibble of an op's first byte picks the kind, bits 4-5 the shift
+ * and bit 7 RAW_LOCATOR, the next two bytes are the low bits of pos.
+ */
+[[maybe_unused]] trace decode(const std::uint8_t* data,
+                              std::size_t size) {
+  trace decoded;
+  std::size_t idx{0};
+  std::size_t len{(size) ? 1u + data[idx++] % 96 : 1u};
+  for (std::size_t base{0}; base < len; ++base) {
+    decoded.initial.push_back(BASE_CHARS[(idx < size) ? data[idx++] & 3 : 0]);
+  }
+  for (; idx + 4 <= size; idx += 4) {
+    std::uint32_t pos{static_cast<std::uint32_t>(data[idx + 1]) |
+                      (static_cast<std::uint32_t>(data[idx + 2]) << 8) |
+                      (static_cast<std::uint32_t>(data[idx] & 0x30u) << 12)};
+    if (data[idx] & 0x80u) pos |= RAW_LOCATOR;
+    decoded.ops.push_back(
+        op{static_cast<op_kind>((data[idx] & 0x0fu) %
+                                static_cast<int>(op_kind::num_kinds)),
+           pos, data[idx + 3]});
+  }
+  return decoded;
+}
+
+[[maybe_unused]] trace generate(std::mt19937& rng, std::size_t max_len,
+                                std::size_t max_ops) {
+  std::uniform_int_distribution<std::size_t> len_dist{1, max_len};
+  std::uniform_int_distribution<std::size_t> ops_dist{1, max_ops};
+  std::uniform_int_distribution<int> byte_dist{0, 255};
+  std::uniform_int_distribution<int> kind_dist{
+      0, static_cast<int>(op_kind::num_kinds) - 1};
+  trace generated;
+  std::size_t len{len_dist(rng)};
+  for (std::size_t idx{0}; idx < len; ++idx) {
+    generated.initial.push_back(BASE_CHARS[byte_dist(rng) & 3]);
+  }
+  std::size_t num_ops{ops_dist(rng)};
+  for (std::size_t idx{0}; idx < num_ops; ++idx) {
+    generated.ops.push_back(op{static_cast<op_kind>(kind_dist(rng)),
+                               static_cast<std::uint32_t>(rng()),
+                               static_cast<std::uint8_t>(byte_dist(rng))});
+  }
+  return generated;
+}
+
+[[maybe_unused]] bool read_flag(const std::string& arg,
+                                const std::string& flag, std::size_t& value) {
+  if (arg.rfind(flag + "=", 0) != 0) return false;
+  value = std::strtoull(arg.c_str() + flag.length() + 1, nullptr, 10);
+  return true;
+}
+
+}  // namespace
+
+#ifdef CODON_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data,
+                                      std::size_t size) {
+  trace input{decode(data, size)};
+  if (std::optional<failure> found{run(input)}) {
+    print(input, *found, std::cerr);
+    std::abort();
+  }
+  return 0;
+}
+#else
+int main(int argc, char** argv) {
+  std::size_t runs{10000};
+  std::size_t seed{1};
+  std::size_t max_len{100};
+  std::size_t max_ops{200};
+  for (int idx{1}; idx < argc; ++idx) {
+    std::string arg{argv[idx]};
+    if (!read_flag(arg, "--runs", runs) && !read_flag(arg, "--seed", seed) &&
+        !read_flag(arg, "--max-len", max_len) &&
+        !read_flag(arg, "--max-ops", max_ops)) {
+      std::cerr << "usage: seq_fuzz [--runs=<n>] [--seed=<n>] "
+                   "[--max-len=<bp>] [--max-ops=<n>]\n";
+      return (arg == "--help" || arg == "-h") ? 0 : 1;
+    }
+  }
+  if (!max_len || !max_ops) {
+    std::cerr << "--max-len and --max-ops have to be at least 1\n";
+    return 1;
+  }
+
+  for (std::size_t curr{0}; curr < runs; ++curr) {
+    // every run has its own seed, so a failure replays with --runs=1
+    std::mt19937 rng{static_cast<std::mt19937::result_type>(seed + curr)};
+    trace input{generate(rng, max_len, max_ops)};
+    if (!run(input)) continue;
+    trace shrunk{minimize(input)};
+    std::cerr << "seq_fuzz: mismatch with --seed=" << seed + curr
+              << ", minimized trace:\n";
+    print(shrunk, *run(shrunk), std::cerr);
+    return 1;
+  }
+  std::cout << "seq_fuzz: " << runs << " traces matched the model\n";
+  return 0;
+}
+#endif
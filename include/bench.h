@@ -0,0 +1,115 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/* Handed to every benchmark function. The timed region is the body of
+ *   while (state.keep_running()) { ... }
+ * and pause()/resume() exclude setup or restore work inside of it.
+ * get_param() is the size the run was registered with (bp for sequences).
+ */
+class state {
+  using clock = std::chrono::steady_clock;
+
+  std::size_t param;
+  std::size_t iterations;
+  std::size_t done{0};
+  std::size_t items{0};
+  clock::time_point started;
+  clock::duration elapsed{0};
+  bool is_running{false};
+
+ public:
+  state(std::size_t param, std::size_t iterations);
+
+  bool keep_running();
+  void pause();
+  void resume();
+
+  std::size_t get_param() const { return this->param; }
+  std::size_t get_iterations() const { return this->iterations; }
+  // processed units (bases, codons, ...) for the throughput column
+  void set_items(std::size_t items) { this->items = items; }
+  std::size_t get_items() const { return this->items; }
+  double get_elapsed_ns() const;
+};
+
+// ns_per_iter is the median over all repetitions
+struct result {
+  std::string name;
+  std::size_t param;
+  std::size_t iterations;
+  double ns_per_iter;
+  double items_per_second;
+};
+
+// filters are substrings separated by commas, a benchmark has to match one
+struct options {
+  std::string filter;
+  std::size_t max_param{1000000};
+  double min_time{0.2};
+  std::size_t repetitions{1};
+  unsigned int seed{42};
+};
+
+/* fixed amount of integer work that runs alongside every selection. The
+ * comparison divides by it, so a baseline recorded on another machine
+ * still tells whether an operation got slower relative to the CPU.
+ */
+constexpr const char* CALIBRATION = "calibration";
+
+using bench_fn = std::function<void(bench::state&)>;
+
+void add(const std::string& name, bench_fn fn,
+         const std::vector<std::size_t>& params);
+std::vector<bench::result> run_all(const bench::options& opts);
+std::string to_json(const std::vector<bench::result>& results,
+                    const bench::options& opts);
+// reads the benchmarks array written by to_json, throws std::runtime_error
+std::vector<bench::result> load_json(const std::string& path);
+
+/* prints a per-benchmark table of baseline against current and returns
+ * how many got slower than 1 + threshold. Benchmarks missing from the
+ * baseline are listed but never fail.
+ */
+std::size_t compare(const std::vector<bench::result>& baseline,
+                    const std::vector<bench::result>& current,
+                    double threshold, std::ostream& out);
+
+/* least-squares fit of log(ns_per_iter) against log(param) for every
+ * benchmark run with at least three params: ~0 is constant per call,
+ * ~1 linear and ~2 a quadratic blow-up
+ */
+struct exponent {
+  std::string name;
+  double value;
+};
+std::vector<bench::exponent> fit_exponents(
+    const std::vector<bench::result>& results);
+
+// sequence lengths from 100 bp to 100 Mbp in powers of ten
+const std::vector<std::size_t>& seq_lengths();
+std::string random_bases(std::size_t len);
+
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const T* sink;
+  sink = &value;
+#endif
+}
+
+// registration, one function per benchmarked module
+void register_codon_benches();
+void register_seq_benches();
+void register_scaling_benches();
+void register_io_benches();
+
+}  // namespace bench
@@ -2,6 +2,7 @@
 #include <bitset>
 #include <cstdint>
 #include <string>
+#include <type_traits>
 
 namespace codon {
 
@@ -13,9 +14,18 @@ class Codon {
   std::uint8_t bases{0};
 
  public:
+  // up to 3 of A, C, G and T, other symbols throw std::invalid_argument
   Codon(const std::string& bases_str);
   Codon(base base);
-  ~Codon();
+  // plain byte: copies are memcpy, containers may relocate it freely
+  Codon(const Codon& other) = default;
+  Codon(Codon&& other) noexcept = default;
+  Codon& operator=(const Codon& other) = default;
+  Codon& operator=(Codon&& other) noexcept = default;
+  ~Codon() = default;
+
+  // raw encoding including the length marker, e.g. 0b01xxxxxx for 3 bases
+  static Codon from_bits(std::uint8_t bits);
 
   bool is_full() const;
   bool is_empty() const;
@@ -35,4 +45,8 @@ class Codon {
   base pop(int loc = 0);
 };
 
+static_assert(std::is_trivially_copyable_v<Codon>,
+              "Codon has to stay a trivially copyable byte");
+static_assert(sizeof(Codon) == 1, "Codon has to stay a single byte");
+
 }  // namespace codon
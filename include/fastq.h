@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "seq.h"
+
+namespace codon {
+namespace io {
+
+// Phred+33 (Sanger, Illumina 1.8+) encodes scores 0 to 93 as '!' to '~'
+constexpr int PHRED_OFFSET = 33;
+constexpr int MAX_PHRED = 93;
+
+/* One FASTQ read. Qualities hold the Phred scores themselves, one byte per
+ * base and without the ASCII offset, so they can be compared or summed
+ * directly. Reusing a SeqRecord for the next read keeps the capacity of
+ * all three members.
+ */
+struct SeqRecord {
+  std::string name;
+  codon::Seq seq{std::string()};
+  std::vector<std::uint8_t> qualities;
+
+  // quality line as in the file
+  std::string get_quality_str() const;
+  double mean_quality() const;
+};
+
+/* Cuts lines out of a stream without copying them: the input is read in
+ * blocks into one buffer and every line is a view into it. "\r\n" line
+ * ends are accepted and a last line may lack its line break. Shared by
+ * FastqReader and pipeline::RecordReader.
+ */
+class LineReader {
+  std::istream* in;
+  std::vector<char> buffer;
+  std::size_t begin{0};
+  std::size_t end{0};
+  bool at_eof{false};
+  std::size_t line_number{0};
+
+ public:
+  static constexpr std::size_t DEFAULT_BUFFER = std::size_t{1} << 20;
+
+  explicit LineReader(std::istream& in,
+                      std::size_t buffer_bytes = DEFAULT_BUFFER);
+
+  /* false at the end of the input. line only lives until the following
+   * call, the buffer grows for lines longer than itself.
+   */
+  bool next(std::string_view& line);
+  // 1-based number of the last line returned
+  std::size_t get_line_number() const { return this->line_number; }
+
+ private:
+  void refill();
+};
+
+/* Streams SeqRecords out of FASTQ. Lines are cut from a LineReader in
+ * place and every field is copied into the record's existing storage, so
+ * once the buffer and the records have grown to the longest read no more
+ * allocations happen.
+ *
+ * Sequence and quality may span several lines, with as many quality
+ * scores as bases. Bases are A, C, G and T in either case; malformed
+ * records throw std::invalid_argument naming the line.
+ */
+class FastqReader {
+  // declared first: lines reads from it
+  std::unique_ptr<std::istream> owned;
+  codon::io::LineReader lines;
+  std::size_t num_records{0};
+  // bases of the current record, sequences may span several lines
+  std::string bases;
+
+ public:
+  static constexpr std::size_t DEFAULT_BUFFER = LineReader::DEFAULT_BUFFER;
+
+  explicit FastqReader(std::istream& in,
+                       std::size_t buffer_bytes = DEFAULT_BUFFER);
+  // gzip and BGZF files are decompressed on the fly, see InputFile
+  explicit FastqReader(const std::string& path,
+                       std::size_t buffer_bytes = DEFAULT_BUFFER,
+                       unsigned threads = 0);
+  FastqReader(const FastqReader&) = delete;
+  FastqReader& operator=(const FastqReader&) = delete;
+
+  // false at the end of the input, record is overwritten otherwise
+  bool next(codon::io::SeqRecord& record);
+  /* refills the first records of batch (growing it up to max_records) and
+   * returns how many were read, 0 at the end of the input. Entries behind
+   * the returned count are left untouched, so handing the same batch in
+   * again reuses every record.
+   */
+  std::size_t next_batch(std::vector<codon::io::SeqRecord>& batch,
+                         std::size_t max_records);
+
+  std::size_t records_read() const { return this->num_records; }
+
+ private:
+  [[noreturn]] void fail(const std::string& message) const;
+};
+
+}  // namespace io
+}  // namespace codon
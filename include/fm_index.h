@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "codon.h"
+#include "mapped_file.h"
+#include "seq.h"
+
+namespace codon {
+namespace index {
+
+namespace detail {
+struct fm_header;
+struct occ_block;
+struct rank_block;
+}  // namespace detail
+
+/* Position of a match: the sequence it was found in (order of construction)
+ * and the base offset inside that sequence.
+ */
+struct hit {
+  std::size_t seq_id;
+  std::size_t offset;
+};
+
+/* Half-open range [first, last) of rows in the sorted suffix matrix.
+ * All suffixes inside share the pattern that was searched so far.
+ */
+struct sa_interval {
+  std::size_t first;
+  std::size_t last;
+
+  bool empty() const { return this->first >= this->last; }
+  std::size_t size() const { return (this->empty()) ? 0 : last - first; }
+};
+
+/* FM-index over one or more Seq objects.
+ *
+ * The sequences are concatenated with a separator between them and a unique
+ * sentinel at the end, the suffix array is built with SA-IS and only every
+ * sa_rate-th text position is kept for locate(). The BWT is stored 2 bits per
+ * base in 64-symbol blocks that also hold the cumulative base counts, so a
+ * single rank query touches exactly one cache line and count() runs in O(m)
+ * for a pattern of m bases regardless of the size of the reference.
+ *
+ * The whole index lives in one contiguous image that save() writes verbatim
+ * and load() maps back into memory without parsing (native endianness).
+ */
+class FMIndex {
+  // 64-bit words keep every section of the image naturally aligned
+  std::vector<std::uint64_t> owned_image;
+  std::unique_ptr<codon::io::MappedFile> mapped_image;
+  const std::uint8_t* image{nullptr};
+  std::size_t image_len{0};
+
+  const detail::fm_header* header{nullptr};
+  const std::uint64_t* seq_starts{nullptr};
+  const detail::occ_block* occ_blocks{nullptr};
+  const detail::rank_block* sample_marks{nullptr};
+  const std::uint64_t* samples{nullptr};
+
+ public:
+  FMIndex(const std::vector<codon::Seq>& seqs, std::size_t sa_rate = 32);
+  FMIndex(const codon::Seq& seq, std::size_t sa_rate = 32);
+  FMIndex(FMIndex&&) noexcept = default;
+  FMIndex& operator=(FMIndex&&) noexcept = default;
+  FMIndex(const FMIndex&) = delete;
+  FMIndex& operator=(const FMIndex&) = delete;
+  ~FMIndex();
+
+  static FMIndex load(const std::string& path);
+  void save(const std::string& path) const;
+
+  std::size_t count(const codon::Seq& pattern) const;
+  std::size_t count(const std::string& pattern) const;
+  std::vector<codon::index::hit> locate(const codon::Seq& pattern) const;
+  std::vector<codon::index::hit> locate(const std::string& pattern) const;
+
+  // building blocks for backtracking / approximate search
+  codon::index::sa_interval full_interval() const;
+  codon::index::sa_interval extend(codon::index::sa_interval interval,
+                                   codon::base base) const;
+  codon::index::hit locate_row(std::size_t row) const;
+
+  std::size_t get_text_len() const;
+  std::size_t get_num_seqs() const;
+  std::size_t get_seq_len(std::size_t seq_id) const;
+  std::size_t get_memory_usage() const;
+
+ private:
+  FMIndex() = default;
+  void attach(const std::uint8_t* image, std::size_t image_len);
+
+  std::size_t occ(codon::base base, std::size_t row) const;
+  std::size_t lf(std::size_t row) const;
+  bool is_sampled(std::size_t row, std::size_t& sample_idx) const;
+  codon::index::sa_interval search(const std::string& pattern) const;
+  codon::index::sa_interval search(const codon::Seq& pattern) const;
+  std::vector<codon::index::hit> collect_hits(
+      codon::index::sa_interval interval) const;
+};
+
+}  // namespace index
+}  // namespace codon
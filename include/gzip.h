@@ -0,0 +1,157 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+#include "queue.h"
+
+// gzip and BGZF input through zlib, set by the CMake option CODON_ZLIB
+#ifndef CODON_ZLIB
+#define CODON_ZLIB 0
+#endif
+
+namespace codon {
+namespace io {
+
+constexpr bool has_zlib = CODON_ZLIB;
+
+enum class compression { none, gzip, bgzf };
+
+/* Tells the format from the first bytes of a file. BGZF is gzip whose
+ * header carries a 'BC' extra field with the block size, which needs the
+ * first 18 bytes; fewer bytes of a gzip file are reported as plain gzip.
+ */
+codon::io::compression detect_compression(const unsigned char* head,
+                                          std::size_t length);
+
+/* Compresses data into BGZF blocks of at most BGZF_BLOCK_DATA bytes each,
+ * followed by the empty end-of-file block, as bgzip writes them. Throws
+ * std::runtime_error when built without zlib.
+ */
+constexpr std::size_t BGZF_BLOCK_DATA = 0xff00;
+std::string bgzf_compress(std::string_view data, int level = 6);
+
+namespace detail {
+
+// one BGZF block, read as a whole and inflated on its own
+struct bgzf_block {
+  std::vector<unsigned char> compressed;
+  std::vector<char> data;
+  // byte offset of the block in the compressed input, for error messages
+  std::size_t offset{0};
+};
+
+struct block_batch {
+  std::vector<codon::io::detail::bgzf_block> blocks;
+  std::size_t count{0};
+};
+
+// zlib state of a plain gzip stream, kept out of this header
+struct inflater;
+
+}  // namespace detail
+
+/* Input buffer that decompresses whatever the wrapped stream holds. The
+ * format is detected from its first bytes: uncompressed input passes
+ * through unchanged, gzip is inflated on the reading thread (a gzip stream
+ * can only be decoded front to back), and so is BGZF with threads == 1.
+ *
+ * BGZF is a series of independent gzip blocks of at most 64 KiB, so with
+ * more threads a background thread reads batches of blocks and inflates
+ * each batch on a ThreadPool (0: ThreadPool::shared(), otherwise a pool of
+ * that many threads). Decompressed batches wait in a small ring of
+ * SpscQueue slots for the reader, and spent batches travel back to be
+ * refilled, so the parser works on one batch while the next ones are
+ * being inflated and no buffers are allocated once the ring is full.
+ *
+ * A buffer on the shared pool must not be read from inside a task of that
+ * pool, the task would wait for blocks the pool cannot inflate while its
+ * batch runs. Constructed inside such a task, e.g. a FastqReader per file
+ * in parallel::for_each_seq(), it therefore inflates on the reading thread
+ * like threads == 1; an own pool (threads > 1) has no such restriction.
+ *
+ * Corrupt input throws std::runtime_error from the reading call. Wrapped
+ * in a plain std::istream that error only surfaces with
+ * exceptions(std::ios::badbit) set, InputFile does that already. The
+ * compressed stream has to outlive the buffer and must not be read by
+ * anyone else meanwhile.
+ */
+class DecompressStreambuf : public std::streambuf {
+  // blocks per batch and thread, and batches decompressed ahead
+  static constexpr std::size_t BLOCKS_PER_THREAD = 4;
+  static constexpr std::size_t RING_BATCHES = 2;
+  static constexpr std::size_t IN_BYTES = std::size_t{1} << 16;
+  static constexpr std::size_t OUT_BYTES = std::size_t{1} << 17;
+
+  std::istream& in;
+  codon::io::compression format{codon::io::compression::none};
+  // header bytes consumed by the detection, served before the stream
+  std::vector<unsigned char> head;
+  std::size_t head_pos{0};
+  // compressed bytes consumed so far
+  std::size_t offset{0};
+
+  // none and gzip: read and inflated in underflow()
+  std::unique_ptr<codon::io::detail::inflater> gzip;
+  std::vector<char> out;
+
+  // bgzf: the ring between the background thread and the reader
+  std::unique_ptr<codon::parallel::ThreadPool> owned_pool;
+  codon::parallel::ThreadPool* pool{nullptr};
+  std::size_t batch_blocks{1};
+  codon::queue::SpscQueue<codon::io::detail::block_batch> ready{
+      RING_BATCHES};
+  codon::queue::SpscQueue<codon::io::detail::block_batch> spare{
+      RING_BATCHES};
+  codon::io::detail::block_batch current;
+  std::size_t next_block{0};
+  std::exception_ptr error;
+  std::thread inflating;
+
+ public:
+  explicit DecompressStreambuf(std::istream& compressed, unsigned threads = 0);
+  DecompressStreambuf(const DecompressStreambuf&) = delete;
+  DecompressStreambuf& operator=(const DecompressStreambuf&) = delete;
+  ~DecompressStreambuf() override;
+
+  codon::io::compression get_format() const { return this->format; }
+
+ protected:
+  int_type underflow() override;
+
+ private:
+  std::size_t read_input(unsigned char* buffer, std::size_t count);
+  bool read_block(codon::io::detail::bgzf_block& block);
+  void inflate_blocks();
+  int_type next_plain();
+  int_type next_gzip();
+  int_type next_bgzf();
+};
+
+/* Opens a FASTA/FASTQ (or any) file for reading, decompressing gzip and
+ * BGZF on the fly (see DecompressStreambuf). Throws std::runtime_error if
+ * the file cannot be opened, or if it is compressed and zlib is missing.
+ */
+class InputFile : public std::istream {
+  std::ifstream file;
+  std::unique_ptr<codon::io::DecompressStreambuf> buffer;
+
+ public:
+  explicit InputFile(const std::string& path, unsigned threads = 0);
+
+  codon::io::compression get_format() const {
+    return this->buffer->get_format();
+  }
+};
+
+}  // namespace io
+}  // namespace codon
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "codon.h"
+#include "seq.h"
+
+namespace codon {
+namespace kmer {
+
+/* K-mers are packed 2 bits per base with the codon::base encoding, first
+ * base in the most significant position, so k <= 32 fits into 64 bits.
+ * With A = 00, G = 01, C = 10 and T = 11 the complement of a base is simply
+ * its bitwise inverse.
+ */
+constexpr int MAX_K = 32;
+
+inline void verify_k(int k) {
+  if (k < 1 || k > MAX_K)
+    throw std::invalid_argument("Expected k between 1 and 32 but received " +
+                                std::to_string(k) + ".");
+}
+
+inline std::uint64_t mask(int k) {
+  return (k >= MAX_K) ? ~0ULL : ((1ULL << (2 * k)) - 1);
+}
+
+inline std::uint64_t reverse_complement(std::uint64_t kmer, int k) {
+  kmer = ~kmer;
+  // reverse the order of the 2-bit groups
+  kmer = ((kmer >> 2) & 0x3333333333333333ULL) |
+         ((kmer & 0x3333333333333333ULL) << 2);
+  kmer = ((kmer >> 4) & 0x0F0F0F0F0F0F0F0FULL) |
+         ((kmer & 0x0F0F0F0F0F0F0F0FULL) << 4);
+  kmer = ((kmer >> 8) & 0x00FF00FF00FF00FFULL) |
+         ((kmer & 0x00FF00FF00FF00FFULL) << 8);
+  kmer = ((kmer >> 16) & 0x0000FFFF0000FFFFULL) |
+         ((kmer & 0x0000FFFF0000FFFFULL) << 16);
+  kmer = (kmer >> 32) | (kmer << 32);
+  return kmer >> (64 - 2 * k);
+}
+
+inline std::uint64_t canonical(std::uint64_t kmer, int k) {
+  std::uint64_t reverse = reverse_complement(kmer, k);
+  return (reverse < kmer) ? reverse : kmer;
+}
+
+// 64-bit finaliser of MurmurHash3, good avalanche for packed k-mers
+inline std::uint64_t hash(std::uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xFF51AFD7ED558CCDULL;
+  key ^= key >> 33;
+  key *= 0xC4CEB9FE1A85EC53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+inline bool char_to_base(char character, codon::base& base) {
+  switch (character) {
+    case 'A':
+      base = codon::base::A;
+      return true;
+    case 'G':
+      base = codon::base::G;
+      return true;
+    case 'C':
+      base = codon::base::C;
+      return true;
+    case 'T':
+      base = codon::base::T;
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* Calls fn(kmer) for every k-mer of bases from left to right, keeping the
+ * forward and reverse complement k-mer rolling. Characters other than
+ * A, C, G, T restart the window. If fn returns bool, returning false stops
+ * the iteration early.
+ */
+template <typename Fn>
+void for_each_kmer(const std::string& bases, int k, bool use_canonical,
+                   Fn&& fn) {
+  verify_k(k);
+  const std::uint64_t kmer_mask = mask(k);
+  const int high_shift = 2 * (k - 1);
+  std::uint64_t forward{0};
+  std::uint64_t reverse{0};
+  int filled{0};
+
+  for (char character : bases) {
+    codon::base base{codon::base::A};
+    if (!char_to_base(character, base)) {
+      filled = 0;
+      continue;
+    }
+    forward = ((forward << 2) | base) & kmer_mask;
+    reverse = (reverse >> 2) |
+              (static_cast<std::uint64_t>(base ^ codon::base::T) << high_shift);
+    if (++filled >= k) {
+      std::uint64_t kmer =
+          (use_canonical && reverse < forward) ? reverse : forward;
+      if constexpr (std::is_same_v<decltype(fn(kmer)), bool>) {
+        if (!fn(kmer)) return;
+      } else {
+        fn(kmer);
+      }
+    }
+  }
+}
+
+template <typename Fn>
+void for_each_kmer(const codon::Seq& seq, int k, bool use_canonical,
+                   Fn&& fn) {
+  verify_k(k);
+  for (std::uint64_t kmer : seq.kmers(k, use_canonical)) {
+    if constexpr (std::is_same_v<decltype(fn(kmer)), bool>) {
+      if (!fn(kmer)) return;
+    } else {
+      fn(kmer);
+    }
+  }
+}
+
+}  // namespace kmer
+}  // namespace codon
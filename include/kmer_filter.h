@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "seq.h"
+
+namespace codon {
+namespace filter {
+
+namespace detail {
+
+// one cache line of filter bits
+struct alignas(64) bloom_block {
+  std::uint64_t words[8];
+};
+
+// one cache line of 16-bit fingerprints, 0 marks an empty slot
+struct alignas(64) cuckoo_bucket {
+  std::uint16_t slots[32];
+};
+
+struct cuckoo_locks;
+
+}  // namespace detail
+
+/* Blocked Bloom filter over packed k-mers (see kmer.h).
+ *
+ * Every k-mer maps to a single 512-bit block, so an insert or a query costs
+ * one cache miss. The bits inside the block are compared as a whole mask
+ * (two AVX2 tests where available, otherwise a loop the compiler
+ * vectorises). The number of blocks and hash functions is derived from the
+ * expected number of k-mers and the target false-positive rate.
+ *
+ * insert_concurrent() may be called from several threads at once; queries
+ * must not overlap with concurrent inserts.
+ */
+class KmerBloom {
+  std::vector<codon::filter::detail::bloom_block> blocks;
+  int k{31};
+  int num_hashes{1};
+  bool use_canonical{true};
+
+ public:
+  KmerBloom(std::size_t expected_kmers, double fpr = 0.01, int k = 31,
+            bool use_canonical = true);
+
+  static KmerBloom load(const std::string& path);
+  void save(const std::string& path) const;
+
+  void insert(std::uint64_t kmer);
+  void insert_concurrent(std::uint64_t kmer);
+  bool contains(std::uint64_t kmer) const;
+
+  void insert_seq(const codon::Seq& seq);
+  void insert_seq_concurrent(const codon::Seq& seq);
+  std::size_t count_hits(const codon::Seq& read) const;
+  bool matches(const codon::Seq& read, double min_fraction = 0.5) const;
+
+  int get_k() const { return this->k; }
+  int get_num_hashes() const { return this->num_hashes; }
+  bool is_canonical() const { return this->use_canonical; }
+  std::size_t get_memory_usage() const;
+
+ private:
+  KmerBloom() = default;
+  void build_mask(std::uint64_t hash, std::size_t& block,
+                  std::uint64_t (&mask)[8]) const;
+};
+
+/* Cuckoo filter over packed k-mers with cache-line sized buckets.
+ *
+ * Each bucket holds 32 fingerprints of up to 16 bits and every k-mer has two
+ * candidate buckets (partial-key cuckoo hashing), so a query touches at most
+ * two cache lines and usually one. The fingerprint width follows from the
+ * target false-positive rate (about 64 / 2^bits), so rates below about
+ * 1e-3 throw std::invalid_argument.
+ *
+ * insert() and the insert_seq() variants have set semantics and skip
+ * k-mers that contains() already reports, so repeats cost nothing.
+ * Unlike the Bloom filter k-mers can be erased again, but erase() is only
+ * exact for k-mers added with insert_counted(): that stores a fingerprint
+ * per call, so a k-mer added twice stays a member after one erase and
+ * colliding k-mers keep their own entries. A k-mer fits at most 64 times.
+ *
+ * insert_concurrent() locks the two candidate buckets and only falls back
+ * to an exclusive lock when entries have to be relocated. Queries must not
+ * overlap with concurrent inserts.
+ */
+class KmerCuckoo {
+  std::vector<codon::filter::detail::cuckoo_bucket> buckets;
+  std::unique_ptr<codon::filter::detail::cuckoo_locks> locks;
+  std::size_t bucket_mask{0};
+  std::uint64_t kick_state{0x9E3779B97F4A7C15ULL};
+  int k{31};
+  int fingerprint_bits{16};
+  bool use_canonical{true};
+
+ public:
+  KmerCuckoo(std::size_t expected_kmers, double fpr = 0.001, int k = 31,
+             bool use_canonical = true);
+  KmerCuckoo(KmerCuckoo&&) noexcept;
+  KmerCuckoo& operator=(KmerCuckoo&&) noexcept;
+  ~KmerCuckoo();
+
+  static KmerCuckoo load(const std::string& path);
+  void save(const std::string& path) const;
+
+  bool insert(std::uint64_t kmer);
+  bool insert_concurrent(std::uint64_t kmer);
+  // multiset insert, see above
+  bool insert_counted(std::uint64_t kmer);
+  bool contains(std::uint64_t kmer) const;
+  bool erase(std::uint64_t kmer);
+
+  // return the number of k-mers that did not fit anymore
+  std::size_t insert_seq(const codon::Seq& seq);
+  std::size_t insert_seq_concurrent(const codon::Seq& seq);
+  std::size_t count_hits(const codon::Seq& read) const;
+  bool matches(const codon::Seq& read, double min_fraction = 0.5) const;
+
+  int get_k() const { return this->k; }
+  int get_fingerprint_bits() const { return this->fingerprint_bits; }
+  bool is_canonical() const { return this->use_canonical; }
+  std::size_t get_size() const;
+  double get_load_factor() const;
+  std::size_t get_memory_usage() const;
+
+ private:
+  KmerCuckoo();
+  void locate(std::uint64_t kmer, std::uint16_t& fingerprint,
+              std::size_t& first, std::size_t& second) const;
+  bool place(std::size_t bucket, std::uint16_t fingerprint);
+  // places fingerprint, relocating others if both buckets are full
+  bool store(std::uint16_t fingerprint, std::size_t first,
+             std::size_t second);
+};
+
+}  // namespace filter
+}  // namespace codon
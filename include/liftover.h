@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace codon {
+
+/* Maps 0-based base offsets between the original and the edited version of
+ * a sequence while insertions and deletions are recorded one by one.
+ *
+ * The edited sequence is kept as an ordered list of segments, each either a
+ * run of original bases or a run of inserted ones, stored in a treap keyed
+ * implicitly by the edited position. Every node knows the edited length and
+ * the furthest original offset of its subtree, so recording an operation
+ * and converting an offset in either direction take O(log k) for k
+ * segments. Offsets that were deleted (to_edited) or inserted (to_original)
+ * have no counterpart and yield std::nullopt.
+ */
+class LiftoverMap {
+  struct node {
+    std::size_t orig_start;
+    std::size_t length;
+    std::size_t subtree_len;
+    std::size_t subtree_orig_end;
+    std::uint32_t priority;
+    std::size_t left;
+    std::size_t right;
+  };
+
+  std::vector<node> nodes;
+  std::vector<std::size_t> free_nodes;
+  std::size_t root;
+  std::size_t orig_len{0};
+  std::uint64_t rng_state{0x9E3779B97F4A7C15ULL};
+
+ public:
+  static constexpr std::size_t NO_ORIGIN = static_cast<std::size_t>(-1);
+
+  LiftoverMap();
+  // identity map over len original bases
+  explicit LiftoverMap(std::size_t len);
+
+  // offsets are in edited coordinates at the time of the operation
+  void record_insert(std::size_t offset, std::size_t length);
+  void record_erase(std::size_t offset, std::size_t length);
+
+  std::optional<std::size_t> to_edited(std::size_t orig_offset) const;
+  std::optional<std::size_t> to_original(std::size_t new_offset) const;
+
+  // batch versions for ascending offsets, one in-order walk over the tree
+  std::vector<std::optional<std::size_t>> to_edited(
+      const std::vector<std::size_t>& orig_offsets) const;
+  std::vector<std::optional<std::size_t>> to_original(
+      const std::vector<std::size_t>& new_offsets) const;
+
+  std::size_t get_orig_len() const { return this->orig_len; }
+  std::size_t get_new_len() const;
+  std::size_t get_num_segments() const;
+
+ private:
+  static constexpr std::size_t NIL = static_cast<std::size_t>(-1);
+
+  std::size_t make_node(std::size_t orig_start, std::size_t length,
+                        std::uint32_t priority);
+  std::uint32_t next_priority();
+  void update(std::size_t idx);
+  std::size_t merge(std::size_t left, std::size_t right);
+  void split(std::size_t idx, std::size_t pos, std::size_t& left,
+             std::size_t& right);
+  void release(std::size_t idx);
+
+  template <typename Fn>
+  void for_each_segment(Fn&& fn) const;
+};
+
+}  // namespace codon
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace codon {
+namespace io {
+
+/* Read-only view of a whole file. On POSIX systems the file is mmap'ed so
+ * that large indices can be opened without reading them into memory, on
+ * other platforms the content is read into an owned buffer instead.
+ */
+class MappedFile {
+  const std::uint8_t* bytes{nullptr};
+  std::size_t length{0};
+  std::vector<std::uint8_t> fallback;
+
+ public:
+  explicit MappedFile(const std::string& path);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  ~MappedFile();
+
+  const std::uint8_t* data() const { return this->bytes; }
+  std::size_t size() const { return this->length; }
+
+ private:
+  void release();
+};
+
+}  // namespace io
+}  // namespace codon
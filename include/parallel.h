@@ -0,0 +1,225 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "seq.h"
+
+/* codons from which single-sequence operations (Seq::get_seq_str(),
+ * Seq::count_bases(), translate()) split their work over the shared pool
+ */
+#ifndef CODON_PARALLEL_MIN_CODONS
+#define CODON_PARALLEL_MIN_CODONS (1 << 18)
+#endif
+
+namespace codon {
+namespace parallel {
+
+/* Fork-join pool with one task deque per thread. run() deals the task
+ * indices out round-robin, every thread works off the front of its own
+ * deque and steals from the back of the others once it runs dry, so a few
+ * expensive tasks never leave the remaining threads idle.
+ *
+ * The calling thread takes part, a pool of size n starts n - 1 workers.
+ * One batch runs at a time; run() from inside a task executes the nested
+ * batch serially on that thread instead of deadlocking.
+ */
+class ThreadPool {
+  struct task_queue {
+    std::mutex mutex;
+    std::deque<std::size_t> tasks;
+  };
+
+  std::vector<std::unique_ptr<task_queue>> queues;
+  std::vector<std::thread> workers;
+
+  std::mutex run_mutex;
+  std::mutex state_mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  const std::function<void(std::size_t)>* batch_fn{nullptr};
+  std::size_t batch_id{0};
+  std::atomic<std::size_t> remaining{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  bool stopping{false};
+
+ public:
+  // 0 uses std::thread::hardware_concurrency()
+  explicit ThreadPool(unsigned threads = 0);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  // threads taking part in a batch, the caller included
+  unsigned size() const { return static_cast<unsigned>(this->queues.size()); }
+
+  /* calls fn(idx) for every idx in [0, num_tasks) and returns once all are
+   * done. The first exception thrown by a task is rethrown here, tasks not
+   * started by then are skipped.
+   */
+  void run(std::size_t num_tasks, const std::function<void(std::size_t)>& fn);
+
+  // process-wide pool with hardware_concurrency() threads, started lazily
+  static ThreadPool& shared();
+  /* whether the calling thread executes a task of any pool right now.
+   * Batches started there run inline, code that hands work to another
+   * thread which then calls run() has to check this itself.
+   */
+  static bool is_inside_task();
+
+ private:
+  void worker_loop(std::size_t self);
+  void drain(std::size_t self);
+  bool take(std::size_t self, std::size_t& task);
+};
+
+namespace detail {
+
+// consecutive range elements [first, last) with their summed cost
+struct chunk {
+  std::size_t first;
+  std::size_t last;
+  std::size_t cost;
+};
+
+/* groups consecutive elements into chunks of about total / (4 * threads)
+ * cost. An element above that gets a chunk of its own, so one huge contig
+ * sits next to many chunks of short reads instead of delaying a batch.
+ */
+std::vector<chunk> make_chunks(const std::vector<std::size_t>& costs,
+                               unsigned threads);
+
+/* runs fn(chunk_idx) for every chunk, the most expensive ones first.
+ * threads == 1 stays on the calling thread, 0 uses ThreadPool::shared()
+ * and any other count a pool of its own for this call.
+ */
+void run_chunks(const std::vector<chunk>& chunks, unsigned threads,
+                const std::function<void(std::size_t)>& fn);
+void run_chunks(const std::vector<chunk>& chunks, ThreadPool& pool,
+                const std::function<void(std::size_t)>& fn);
+
+unsigned resolve_threads(unsigned threads);
+
+// work estimate per element: codons of a Seq, characters of a string
+inline std::size_t cost_of(const codon::Seq& seq) {
+  return seq.get_seq_len() + 1;
+}
+inline std::size_t cost_of(const std::string& str) { return str.length() + 1; }
+
+template <typename Range>
+std::vector<chunk> chunks_for(const Range& range, unsigned threads) {
+  std::vector<std::size_t> costs;
+  costs.reserve(std::size(range));
+  for (const auto& curr : range) costs.push_back(cost_of(curr));
+  return make_chunks(costs, threads);
+}
+
+template <typename Range, typename Fn, typename Pool>
+void for_each_seq(Range& range, Fn& fn, Pool&& pool, unsigned threads) {
+  auto first = std::begin(range);
+  std::vector<chunk> chunks{chunks_for(range, threads)};
+  run_chunks(chunks, std::forward<Pool>(pool), [&](std::size_t idx) {
+    for (std::size_t curr{chunks[idx].first}; curr < chunks[idx].last;
+         ++curr) {
+      fn(first[curr]);
+    }
+  });
+}
+
+template <typename Range, typename T, typename Reduce, typename Transform,
+          typename Pool>
+T transform_reduce(const Range& range, T init, Reduce& reduce,
+                   Transform& transform, Pool&& pool, unsigned threads) {
+  auto first = std::begin(range);
+  std::vector<chunk> chunks{chunks_for(range, threads)};
+  std::vector<std::optional<T>> partials(chunks.size());
+  run_chunks(chunks, std::forward<Pool>(pool), [&](std::size_t idx) {
+    std::size_t curr{chunks[idx].first};
+    std::optional<T> partial{transform(first[curr])};
+    while (++curr < chunks[idx].last) {
+      partial = reduce(std::move(*partial), transform(first[curr]));
+    }
+    partials[idx] = std::move(partial);
+  });
+  // chunks are in range order, so the result does not depend on scheduling
+  for (std::optional<T>& partial : partials) {
+    init = reduce(std::move(init), std::move(*partial));
+  }
+  return init;
+}
+
+}  // namespace detail
+
+/* Calls fn(element) for every element of a random-access range of Seq (or
+ * of strings), spread over threads (0: every core, 1: serially). Elements
+ * are chunked by length, so fn may run concurrently for different elements
+ * and has to synchronise anything they share.
+ */
+template <typename Range, typename Fn>
+void for_each_seq(Range& range, Fn fn, unsigned threads = 0) {
+  detail::for_each_seq(range, fn, threads, detail::resolve_threads(threads));
+}
+
+template <typename Range, typename Fn>
+void for_each_seq(Range& range, Fn fn, ThreadPool& pool) {
+  detail::for_each_seq(range, fn, pool, pool.size());
+}
+
+/* reduce(init, transform(element)) over the range, with reduce applied in
+ * range order, so it has to be associative but not commutative
+ */
+template <typename Range, typename T, typename Reduce, typename Transform>
+T transform_reduce(const Range& range, T init, Reduce reduce,
+                   Transform transform, unsigned threads = 0) {
+  return detail::transform_reduce(range, std::move(init), reduce, transform,
+                                  threads, detail::resolve_threads(threads));
+}
+
+template <typename Range, typename T, typename Reduce, typename Transform>
+T transform_reduce(const Range& range, T init, Reduce reduce,
+                   Transform transform, ThreadPool& pool) {
+  return detail::transform_reduce(range, std::move(init), reduce, transform,
+                                  pool, pool.size());
+}
+
+// smallest block single-sequence operations hand to for_each_block()
+constexpr std::size_t MIN_BLOCK_CODONS = CODON_PARALLEL_MIN_CODONS / 2;
+
+/* Calls fn(first, last) for consecutive blocks covering [0, size), each of
+ * at least grain elements unless size itself is smaller. Meant for work
+ * inside one sequence, e.g. codon index ranges, with threads as for
+ * for_each_seq(). Inside a pool task or a serial (threads == 1) batch the
+ * blocks run on the calling thread.
+ */
+void for_each_block(std::size_t size, std::size_t grain,
+                    const std::function<void(std::size_t, std::size_t)>& fn,
+                    unsigned threads = 0);
+
+// ready-made batch operations, threads as for for_each_seq()
+std::vector<codon::Seq> parse(const std::vector<std::string>& inputs,
+                              unsigned threads = 0);
+std::vector<std::string> translate(const std::vector<codon::Seq>& seqs,
+                                   unsigned threads = 0);
+// occurrences of every packed k-mer (see kmer.h) over all sequences
+std::unordered_map<std::uint64_t, std::uint64_t> count_kmers(
+    const std::vector<codon::Seq>& seqs, int k, bool use_canonical = true,
+    unsigned threads = 0);
+// fraction of G and C among all bases, 0 for no bases at all
+double gc_content(const std::vector<codon::Seq>& seqs, unsigned threads = 0);
+
+}  // namespace parallel
+}  // namespace codon
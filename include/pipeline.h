@@ -0,0 +1,276 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fastq.h"
+#include "gzip.h"
+#include "queue.h"
+#include "seq.h"
+
+namespace codon {
+namespace pipeline {
+
+// one FASTA or FASTQ entry as read, before its bases are packed
+struct RawRecord {
+  std::string name;
+  std::string bases;
+  // empty for FASTA
+  std::string qualities;
+};
+
+struct Record {
+  // position in the input, 0-based
+  std::size_t index;
+  std::string name;
+  codon::Seq seq;
+  std::string qualities;
+};
+
+/* Splits a FASTA or FASTQ stream into records; the format is taken from
+ * the first non-empty line ('>' or '@'). FASTA sequences may span several
+ * lines, FASTQ sequences and qualities as well as long as the quality
+ * block is as long as the bases. Lines come from the same buffered
+ * io::LineReader as io::FastqReader. Malformed input throws
+ * std::invalid_argument naming the line.
+ */
+class RecordReader {
+  codon::io::LineReader lines;
+  // the current line, a view into lines (see LineReader::next())
+  std::string_view line;
+  char marker{0};
+  bool has_line{false};
+
+ public:
+  explicit RecordReader(std::istream& in);
+
+  // false at the end of the input, record is overwritten otherwise
+  bool next(codon::pipeline::RawRecord& record);
+  /* fills batch with up to max_records records and returns how many. The
+   * strings of records already in batch are reused, so handing the same
+   * batch back in keeps their capacity.
+   */
+  std::size_t read_batch(std::vector<codon::pipeline::RawRecord>& batch,
+                         std::size_t max_records);
+
+ private:
+  bool next_line();
+};
+
+/* Packs the bases into a Seq (see Seq::assign()), other symbols than A,
+ * C, G and T throw std::invalid_argument. Name and qualities are moved
+ * into the Record, the bases buffer stays with record for reuse.
+ */
+codon::pipeline::Record parse_record(codon::pipeline::RawRecord& record,
+                                     std::size_t index);
+
+// FASTQ when the record has qualities, FASTA otherwise
+void write_record(std::ostream& out, const codon::pipeline::Record& record);
+
+struct Options {
+  // parse and transform workers, 0 uses hardware_concurrency()
+  unsigned threads{0};
+  // records handed between stages at once
+  std::size_t batch_records{256};
+  // batches each queue holds before its producer has to wait
+  std::size_t queue_batches{8};
+  // BGZF inflating threads when run() opens a file, see io::InputFile
+  unsigned decompress_threads{0};
+};
+
+struct Summary {
+  std::size_t records{0};
+  std::size_t batches{0};
+};
+
+namespace detail {
+
+struct RawBatch {
+  std::size_t index{0};
+  std::size_t first_record{0};
+  std::vector<codon::pipeline::RawRecord> records;
+};
+
+template <typename Result>
+struct ResultBatch {
+  std::size_t index{0};
+  std::vector<Result> results;
+};
+
+// first exception of any stage, the others stop once it is set
+struct failure {
+  std::mutex mutex;
+  std::exception_ptr error;
+  std::atomic<bool> failed{false};
+
+  void set(std::exception_ptr curr) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->error) this->error = curr;
+    this->failed.store(true, std::memory_order_release);
+  }
+  bool is_set() const { return this->failed.load(std::memory_order_acquire); }
+};
+
+template <template <typename> class Queue, typename Result,
+          typename Transform, typename Sink>
+codon::pipeline::Summary run_stages(std::istream& in, Transform& transform,
+                                    Sink& sink, const Options& options,
+                                    unsigned workers) {
+  using result_batch = ResultBatch<Result>;
+  Queue<RawBatch> raw_queue{options.queue_batches};
+  Queue<RawBatch> spare_queue{options.queue_batches};
+  Queue<result_batch> result_queue{options.queue_batches};
+  failure failed;
+  // batches read but not yet written, bounds the reordering in the writer
+  std::size_t max_in_flight{2 * options.queue_batches + workers};
+  std::atomic<std::size_t> written{0};
+  std::atomic<unsigned> active_workers{workers};
+
+  auto stop_all = [&] {
+    raw_queue.close();
+    result_queue.close();
+  };
+
+  // stage 1: read records into batches, reusing the ones workers hand back
+  std::thread reader([&] {
+    try {
+      codon::pipeline::RecordReader record_reader(in);
+      std::size_t index{0};
+      std::size_t first_record{0};
+      while (!failed.is_set()) {
+        codon::queue::detail::backoff wait;
+        while (index - written.load(std::memory_order_acquire) >=
+                   max_in_flight &&
+               !failed.is_set()) {
+          wait.pause();
+        }
+        RawBatch batch;
+        spare_queue.try_pop(batch);
+        std::size_t count{
+            record_reader.read_batch(batch.records, options.batch_records)};
+        if (count == 0) break;
+        batch.records.resize(count);
+        batch.index = index++;
+        batch.first_record = first_record;
+        first_record += count;
+        if (!raw_queue.push(std::move(batch))) break;
+      }
+    } catch (...) {
+      failed.set(std::current_exception());
+      stop_all();
+    }
+    raw_queue.close();
+  });
+
+  // stage 2 and 3: parse into Seq and transform, batch by batch
+  std::vector<std::thread> parsers;
+  for (unsigned idx{0}; idx < workers; ++idx) {
+    parsers.emplace_back([&] {
+      try {
+        RawBatch batch;
+        while (!failed.is_set() && raw_queue.pop(batch)) {
+          result_batch out;
+          out.index = batch.index;
+          out.results.reserve(batch.records.size());
+          for (std::size_t curr{0}; curr < batch.records.size(); ++curr) {
+            out.results.push_back(transform(codon::pipeline::parse_record(
+                batch.records[curr], batch.first_record + curr)));
+          }
+          spare_queue.try_push(batch);
+          if (!result_queue.push(std::move(out))) break;
+        }
+      } catch (...) {
+        failed.set(std::current_exception());
+        stop_all();
+      }
+      if (active_workers.fetch_sub(1) == 1) result_queue.close();
+    });
+  }
+
+  // stage 4: write in input order on the calling thread
+  codon::pipeline::Summary summary;
+  std::map<std::size_t, result_batch> pending;
+  try {
+    result_batch batch;
+    while (result_queue.pop(batch)) {
+      pending.emplace(batch.index, std::move(batch));
+      while (!pending.empty() && pending.begin()->first == summary.batches) {
+        for (Result& result : pending.begin()->second.results) {
+          sink(std::move(result));
+          ++summary.records;
+        }
+        pending.erase(pending.begin());
+        written.store(++summary.batches, std::memory_order_release);
+      }
+    }
+  } catch (...) {
+    failed.set(std::current_exception());
+    stop_all();
+  }
+
+  reader.join();
+  for (std::thread& parser : parsers) parser.join();
+  if (failed.error) std::rethrow_exception(failed.error);
+  return summary;
+}
+
+}  // namespace detail
+
+/* Streams records from in through transform into sink:
+ *
+ *   reader -> parse + transform (options.threads workers) -> writer
+ *
+ * The reader runs on a thread of its own and hands out batches of
+ * options.batch_records records. Every worker packs a batch into Seq and
+ * calls transform(Record&&) on each record, sink(result) then sees the
+ * results on the calling thread in input order. Bounded queues sit between
+ * the stages, SPSC with a single worker and MPMC otherwise, so a slow
+ * stage throttles the ones in front of it and memory stays bounded.
+ *
+ * transform may run concurrently for different records, sink never does.
+ * The first exception of any stage stops the pipeline and is rethrown here.
+ * Workers are dedicated threads rather than the parallel::ThreadPool,
+ * since they live for the whole stream instead of one fork-join batch.
+ */
+template <typename Transform, typename Sink>
+codon::pipeline::Summary run(std::istream& in, Transform transform,
+                             Sink sink, const Options& options = Options()) {
+  using result =
+      std::decay_t<std::invoke_result_t<Transform&, codon::pipeline::Record>>;
+  if (options.batch_records == 0 || options.queue_batches == 0) {
+    throw std::invalid_argument(
+        "pipeline::run expects batch_records and queue_batches above 0.");
+  }
+  unsigned workers{options.threads};
+  if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+  if (workers == 1) {
+    return detail::run_stages<codon::queue::SpscQueue, result>(
+        in, transform, sink, options, workers);
+  }
+  return detail::run_stages<codon::queue::MpmcQueue, result>(
+      in, transform, sink, options, workers);
+}
+
+// the same over a file, gzip and BGZF input is decompressed on the fly
+template <typename Transform, typename Sink>
+codon::pipeline::Summary run(const std::string& path, Transform transform,
+                             Sink sink, const Options& options = Options()) {
+  codon::io::InputFile in(path, options.decompress_threads);
+  return codon::pipeline::run(in, std::move(transform), std::move(sink),
+                              options);
+}
+
+}  // namespace pipeline
+}  // namespace codon
@@ -0,0 +1,213 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace codon {
+namespace queue {
+
+/* Bounded lock-free queues for handing batches between pipeline stages.
+ *
+ * try_push()/try_pop() never block. push()/pop() wait with a back-off
+ * (spin, yield, then short sleeps) while the queue is full or empty, which
+ * is what throttles a fast producer to the pace of its consumer. After
+ * close() push() refuses new values and pop() drains what is left before
+ * returning false. Close only once every producer is done pushing, or to
+ * abandon the queue altogether.
+ *
+ * The capacity is rounded up to a power of two and T has to be default
+ * constructible and movable.
+ */
+
+constexpr std::size_t CACHE_LINE = 64;
+
+namespace detail {
+
+inline std::size_t round_capacity(std::size_t capacity) {
+  if (capacity == 0)
+    throw std::invalid_argument("Expected a queue capacity above 0.");
+  std::size_t rounded{2};
+  while (rounded < capacity) rounded <<= 1;
+  return rounded;
+}
+
+class backoff {
+  unsigned rounds{0};
+
+ public:
+  void pause() {
+    if (++this->rounds <= 16) return;
+    if (this->rounds <= 1024) {
+      std::this_thread::yield();
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+};
+
+}  // namespace detail
+
+// one producer thread, one consumer thread
+template <typename T>
+class SpscQueue {
+  std::size_t mask;
+  std::unique_ptr<T[]> slots;
+  alignas(CACHE_LINE) std::atomic<std::size_t> head{0};
+  alignas(CACHE_LINE) std::atomic<std::size_t> tail{0};
+  alignas(CACHE_LINE) std::atomic<bool> closed{false};
+
+ public:
+  explicit SpscQueue(std::size_t capacity)
+      : mask{detail::round_capacity(capacity) - 1},
+        slots{std::make_unique<T[]>(this->mask + 1)} {}
+
+  std::size_t capacity() const { return this->mask + 1; }
+
+  bool try_push(T& value) {
+    std::size_t curr_tail{this->tail.load(std::memory_order_relaxed)};
+    if (curr_tail - this->head.load(std::memory_order_acquire) > this->mask)
+      return false;
+    this->slots[curr_tail & this->mask] = std::move(value);
+    this->tail.store(curr_tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T& value) {
+    std::size_t curr_head{this->head.load(std::memory_order_relaxed)};
+    if (curr_head == this->tail.load(std::memory_order_acquire)) return false;
+    value = std::move(this->slots[curr_head & this->mask]);
+    this->head.store(curr_head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool push(T value) {
+    detail::backoff wait;
+    while (!this->closed.load(std::memory_order_acquire)) {
+      if (this->try_push(value)) return true;
+      wait.pause();
+    }
+    return false;
+  }
+
+  bool pop(T& value) {
+    detail::backoff wait;
+    while (!this->try_pop(value)) {
+      if (this->closed.load(std::memory_order_acquire))
+        return this->try_pop(value);
+      wait.pause();
+    }
+    return true;
+  }
+
+  void close() { this->closed.store(true, std::memory_order_release); }
+  bool is_closed() const {
+    return this->closed.load(std::memory_order_acquire);
+  }
+};
+
+/* any number of producers and consumers, after D. Vyukov's bounded MPMC
+ * queue: every slot carries a sequence number that tells whether it is
+ * free for the push at that position or holds the value for the pop
+ */
+template <typename T>
+class MpmcQueue {
+  struct cell {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  std::size_t mask;
+  std::unique_ptr<cell[]> cells;
+  alignas(CACHE_LINE) std::atomic<std::size_t> enqueue_pos{0};
+  alignas(CACHE_LINE) std::atomic<std::size_t> dequeue_pos{0};
+  alignas(CACHE_LINE) std::atomic<bool> closed{false};
+
+ public:
+  explicit MpmcQueue(std::size_t capacity)
+      : mask{detail::round_capacity(capacity) - 1},
+        cells{std::make_unique<cell[]>(this->mask + 1)} {
+    for (std::size_t idx{0}; idx <= this->mask; ++idx) {
+      this->cells[idx].sequence.store(idx, std::memory_order_relaxed);
+    }
+  }
+
+  std::size_t capacity() const { return this->mask + 1; }
+
+  bool try_push(T& value) {
+    std::size_t pos{this->enqueue_pos.load(std::memory_order_relaxed)};
+    cell* target;
+    while (true) {
+      target = &this->cells[pos & this->mask];
+      std::size_t sequence{target->sequence.load(std::memory_order_acquire)};
+      std::intptr_t diff{static_cast<std::intptr_t>(sequence) -
+                         static_cast<std::intptr_t>(pos)};
+      if (diff == 0) {
+        if (this->enqueue_pos.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = this->enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    target->value = std::move(value);
+    target->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T& value) {
+    std::size_t pos{this->dequeue_pos.load(std::memory_order_relaxed)};
+    cell* source;
+    while (true) {
+      source = &this->cells[pos & this->mask];
+      std::size_t sequence{source->sequence.load(std::memory_order_acquire)};
+      std::intptr_t diff{static_cast<std::intptr_t>(sequence) -
+                         static_cast<std::intptr_t>(pos + 1)};
+      if (diff == 0) {
+        if (this->dequeue_pos.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = this->dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(source->value);
+    source->sequence.store(pos + this->mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool push(T value) {
+    detail::backoff wait;
+    while (!this->closed.load(std::memory_order_acquire)) {
+      if (this->try_push(value)) return true;
+      wait.pause();
+    }
+    return false;
+  }
+
+  bool pop(T& value) {
+    detail::backoff wait;
+    while (!this->try_pop(value)) {
+      if (this->closed.load(std::memory_order_acquire))
+        return this->try_pop(value);
+      wait.pause();
+    }
+    return true;
+  }
+
+  void close() { this->closed.store(true, std::memory_order_release); }
+  bool is_closed() const {
+    return this->closed.load(std::memory_order_acquire);
+  }
+};
+
+}  // namespace queue
+}  // namespace codon
@@ -22,6 +22,9 @@ inline std::mt19937 generate() {
 
 inline std::mt19937 mt{generate()};
 
+// fixed seed for reproducible inputs, e.g. in benchmarks
+inline void seed(std::mt19937::result_type value) { mt.seed(value); }
+
 inline int get_int(int min, int max) {
   return std::uniform_int_distribution{min, max}(mt);
 };
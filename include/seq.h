@@ -1,8 +1,22 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include "codon.h"
+#include "liftover.h"
+#include "seq_iterator.h"
+#include "small_buffer.h"
+
+// codons a Seq keeps inline before its storage moves to the memory resource
+#ifndef CODON_SEQ_INLINE_CODONS
+#define CODON_SEQ_INLINE_CODONS 64
+#endif
 
 namespace codon {
 
@@ -12,62 +26,264 @@ struct locator {
 
   locator(std::size_t index, int shift = 0);
 
-  bool operator>(const codon::locator& other) {
+  bool operator>(const codon::locator& other) const {
     return (this->index > other.index ||
             ((this->index == other.index) && (this->shift > other.shift)));
   }
-  bool operator>=(const codon::locator& other) {
+  bool operator>=(const codon::locator& other) const {
     return (this->index > other.index ||
             ((this->index == other.index) && (this->shift >= other.shift)));
   }
-  bool operator<(const codon::locator& other) {
+  bool operator<(const codon::locator& other) const {
     return (this->index < other.index ||
             ((this->index == other.index) && (this->shift < other.shift)));
   }
-  bool operator<=(const codon::locator& other) {
+  bool operator<=(const codon::locator& other) const {
     return (this->index < other.index ||
             ((this->index == other.index) && (this->shift <= other.shift)));
   }
-  bool operator==(const codon::locator& other) {
+  bool operator==(const codon::locator& other) const {
     return ((this->index == other.index) && (this->shift == other.shift));
   }
-  bool operator!=(const codon::locator& other) {
+  bool operator!=(const codon::locator& other) const {
     return ((this->index != other.index) || (this->shift != other.shift));
   }
 
   void verify_shift();
 };
 
+enum class edit_type { substitution, insertion, deletion };
+
+/* Single edit for Seq::apply_edits(), always relative to the unedited
+ * sequence. Substitutions replace bases.length() bases starting at locator,
+ * insertions put bases in front of the base at locator and deletions remove
+ * length bases starting at locator. An insertion behind the last base uses
+ * the locator that base would have next, e.g. {1, 3} on "ACGTA" and {2, 1}
+ * on "ACGTAC".
+ */
+struct Edit {
+  codon::edit_type type;
+  codon::locator locator;
+  std::string bases;
+  std::size_t length;
+
+  Edit(codon::edit_type type, codon::locator locator, std::string bases,
+       std::size_t length = 0);
+
+  static Edit substitution(codon::locator locator, std::string bases);
+  static Edit insertion(codon::locator locator, std::string bases);
+  static Edit deletion(codon::locator locator, std::size_t length);
+};
+
+/* How much room Seq keeps for its codons. Construction reserves the larger
+ * of reserve_codons and what the input needs, never more, except that
+ * anything fitting inline takes the whole inline block. Whenever an
+ * operation needs more room than is left the storage grows to
+ * needed * growth_factor codons, so 1.0 trades extra reallocations for no
+ * slack at all.
+ */
+struct CapacityPolicy {
+  std::size_t reserve_codons;
+  double growth_factor;
+
+  CapacityPolicy(std::size_t reserve_codons, double growth_factor);
+
+  static CapacityPolicy exact();
+  static CapacityPolicy growth(double growth_factor = 1.2);
+  // caller knows the final size, exact growth beyond it
+  static CapacityPolicy reserve(std::size_t codons);
+};
+
+class SeqView;
+
+/* The codon storage and every internal buffer come from the
+ * std::pmr::memory_resource passed on construction (the default resource
+ * unless stated otherwise). A std::pmr::monotonic_buffer_resource lets a
+ * whole batch of short sequences share one block that is released at once;
+ * it has to outlive every Seq built from it.
+ *
+ * Up to CODON_SEQ_INLINE_CODONS codons are kept in a buffer inside the
+ * object itself, so short reads and primers never reach the resource.
+ */
 class Seq {
-  std::vector<codon::Codon> seq;
+ public:
+  using storage_type = std::pmr::vector<codon::Codon>;
+
+ private:
+  // declared first: seq hands its inline block back on destruction
+  codon::small_buffer_resource<CODON_SEQ_INLINE_CODONS> inline_storage;
+  storage_type seq;
+  codon::CapacityPolicy policy{codon::CapacityPolicy::growth()};
+  codon::LiftoverMap* liftover{nullptr};
+
+  /* lazily rebuilt after every modification: whether the layout is
+   * canonical (full codons only, the last one may be partial) and if not a
+   * Fenwick tree over the codon lengths. The const methods that need it
+   * (get_seq_trulen("bp"), bases_before(), is_canonical(), locate(),
+   * offset_of() and the kernels built on them) rebuild it under a lock, so
+   * they may run concurrently; modifications must not overlap with them.
+   */
+  mutable std::pmr::vector<std::size_t> layout_tree;
+  mutable std::size_t layout_bases{0};
+  mutable std::atomic<bool> layout_valid{false};
+  mutable bool layout_canonical{false};
 
  public:
-  Seq(const std::string& input);
-  // Seq(const codon::Seq &other);
+  Seq(const std::string& input, std::pmr::memory_resource* resource =
+                                     std::pmr::get_default_resource());
+  Seq(const std::string& input, codon::CapacityPolicy policy,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+  // copies start without an attached LiftoverMap
+  Seq(const codon::Seq& other);
+  Seq(const codon::Seq& other, std::pmr::memory_resource* resource);
+  codon::Seq& operator=(const codon::Seq& other);
+  /* moves take over heap storage and an attached LiftoverMap; inline
+   * codons are copied, which never allocates. Assigning between different
+   * memory resources has to copy and may allocate.
+   */
+  Seq(codon::Seq&& other) noexcept;
+  codon::Seq& operator=(codon::Seq&& other);
   ~Seq();
 
+  /* replaces the content with bases (A, C, G, T in either case, anything
+   * else throws std::invalid_argument and leaves the Seq empty). The codon
+   * storage is reused, so refilling one Seq with reads of similar length
+   * does not allocate. Like copy assignment it detaches a LiftoverMap.
+   */
+  void assign(std::string_view bases);
+
   void insert_base(codon::base base, codon::locator locator);
   void insert_codon(codon::Codon codon, codon::locator locator);
-  void insert_seq(codon::Seq other, codon::locator locator);
+  /* inserts in front of the base at locator, a shift behind a partial
+   * codon (e.g. {1, 3} on "ACGTA") inserts right after its last base, which
+   * behind the last codon appends. Appending an rvalue keeps its codons as
+   * they are and takes over its heap storage when that is the larger part.
+   */
+  void insert_seq(const codon::Seq& other, codon::locator locator);
+  void insert_seq(codon::Seq&& other, codon::locator locator);
+  void insert_seq(const codon::SeqView& other, codon::locator locator);
 
   codon::base pop_base(codon::locator locator);
   codon::Codon pop_codon(codon::locator locator, int size_cut = 3);
+  void erase(codon::locator first, codon::locator last);
+  // edits sorted by locator and not overlapping, see codon::Edit
+  codon::LiftoverMap apply_edits(const std::vector<codon::Edit>& edits);
+
+  /* records every following insertion and deletion into map (which has to
+   * cover the current length and outlive the attachment) until detached
+   */
+  void attach_liftover(codon::LiftoverMap& map);
+  void detach_liftover();
+
+  std::pmr::memory_resource* get_resource() const;
+  // whether the codons currently live in the inline buffer
+  bool is_inline() const;
+
+  // applies reserve_codons right away, assignments keep the policy
+  void set_capacity_policy(codon::CapacityPolicy policy);
+  codon::CapacityPolicy get_capacity_policy() const;
+  std::size_t get_capacity() const;
+  // times the codon storage was (re)allocated, the first one included
+  std::size_t get_num_allocations() const;
+
+  // re-packs into the canonical layout and releases unused capacity
+  void compact();
+  bool is_canonical() const;
 
   void left_shift(std::size_t upto_loc = 0);
   void right_shift(std::size_t upto_loc = 0);
 
+  /* get_seq_str() and count_bases() split into codon blocks on the shared
+   * thread pool from CODON_PARALLEL_MIN_CODONS codons on (see parallel.h)
+   */
   std::string get_seq_str() const;
+  // occurrences of every base, indexed by codon::base
+  std::array<std::size_t, 4> count_bases() const;
   std::vector<std::bitset<8>> get_seq_bin() const;
   codon::Codon get_codon_at(const codon::locator& locator) const;
   std::size_t get_seq_len() const;
   std::size_t get_seq_trulen(std::string how = "codons") const;
 
+  // iteration without copies: codons (VOIDs skipped), bases, k-mers
+  codon::codon_iterator begin() const;
+  codon::codon_iterator end() const;
+  codon::base_range bases() const;
+  codon::kmer_range kmers(int k, bool use_canonical = false) const;
+
   std::size_t get_first_idx() const;
   std::size_t get_last_idx() const;
   codon::locator get_first_loc() const;
   codon::locator get_last_loc() const;
 
-  bool is_locator_valid(codon::locator locator);
+  bool is_locator_valid(codon::locator locator) const;
+
+  /* conversion between 0-based base positions and locators, O(1) for a
+   * canonical layout and O(log n) otherwise
+   */
+  codon::locator locate(std::size_t base_pos) const;
+  std::size_t offset_of(const codon::locator& locator) const;
+  /* bases held by the codons in front of index, get_seq_len() gives all of
+   * them. Safe to call from several threads, which lets blocks of codons
+   * find their output offset.
+   */
+  std::size_t bases_before(std::size_t index) const;
+
+  // non-owning window over the bases between first and last (inclusive)
+  codon::SeqView slice(codon::locator first, codon::locator last) const;
+
+  friend class codon::SeqView;
+
+ private:
+  // makes room for codons in total according to the capacity policy
+  void reserve_for(std::size_t codons);
+
+  std::size_t base_offset(const codon::locator& locator) const;
+  std::size_t pop_offset(const codon::locator& locator) const;
+
+  void invalidate_layout() {
+    this->layout_valid.store(false, std::memory_order_relaxed);
+  }
+  void refresh_layout() const;
+};
+
+static_assert(std::is_nothrow_move_constructible_v<Seq>,
+              "std::vector<Seq> has to relocate sequences without copies");
+
+/* Read-only window over the bases first..last (both inclusive) of a Seq.
+ *
+ * A view is a pointer and two locators, so slicing never copies bases.
+ * Locators are those of the parent sequence; get_frame() tells where inside
+ * its codon the window starts (0, 1 or 2 bases in). The edge codons are
+ * clipped to the window by get_codon_at() and the base/k-mer iterators.
+ * Any modification of the parent invalidates its views.
+ */
+class SeqView {
+  const codon::Seq* parent;
+  codon::locator first;
+  codon::locator last;
+
+ public:
+  SeqView(const codon::Seq& parent, codon::locator first,
+          codon::locator last);
+
+  std::string get_seq_str() const;
+  std::vector<std::bitset<8>> get_seq_bin() const;
+  codon::Codon get_codon_at(const codon::locator& locator) const;
+  std::size_t get_seq_len() const;
+  std::size_t get_seq_trulen(std::string how = "codons") const;
+
+  codon::base_range bases() const;
+  codon::kmer_range kmers(int k, bool use_canonical = false) const;
+
+  std::size_t get_first_idx() const { return this->first.index; }
+  std::size_t get_last_idx() const { return this->last.index; }
+  codon::locator get_first_loc() const { return this->first; }
+  codon::locator get_last_loc() const { return this->last; }
+  int get_frame() const { return this->first.shift - 1; }
+  const codon::Seq& get_parent() const { return *this->parent; }
+
+  bool is_locator_valid(codon::locator locator) const;
+  codon::SeqView slice(codon::locator first, codon::locator last) const;
 };
 
 }  // namespace codon
@@ -0,0 +1,237 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "codon.h"
+
+namespace codon {
+
+/* Read-only iterators over the codon storage of a Seq (or SeqView).
+ * None of them allocate; they walk the codon bytes directly.
+ */
+
+/* Bidirectional iterator over the codons that hold bases. Empty codons
+ * (VOID/SWITCH) anywhere in the storage are skipped like base_iterator
+ * does, so it cannot jump by an offset; get_codon() exposes the storage
+ * position for code that indexes it directly.
+ */
+class codon_iterator {
+  const codon::Codon* curr{nullptr};
+  const codon::Codon* last{nullptr};
+
+ public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = codon::Codon;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const codon::Codon*;
+  using reference = const codon::Codon&;
+
+  codon_iterator() = default;
+  // curr has to hold bases or equal last
+  codon_iterator(const codon::Codon* curr, const codon::Codon* last)
+      : curr{curr}, last{last} {}
+
+  reference operator*() const { return *this->curr; }
+  pointer operator->() const { return this->curr; }
+
+  codon_iterator& operator++() {
+    do {
+      ++this->curr;
+    } while (this->curr != this->last && this->curr->is_empty());
+    return *this;
+  }
+  codon_iterator operator++(int) {
+    codon_iterator previous{*this};
+    ++(*this);
+    return previous;
+  }
+  codon_iterator& operator--() {
+    // stops at begin() at the latest, which holds bases
+    do {
+      --this->curr;
+    } while (this->curr->is_empty());
+    return *this;
+  }
+  codon_iterator operator--(int) {
+    codon_iterator previous{*this};
+    --(*this);
+    return previous;
+  }
+
+  bool operator==(const codon_iterator& other) const {
+    return this->curr == other.curr;
+  }
+  bool operator!=(const codon_iterator& other) const {
+    return this->curr != other.curr;
+  }
+
+  const codon::Codon* get_codon() const { return this->curr; }
+};
+
+/* Forward iterator over single bases from left to right. Empty codons
+ * (VOID/SWITCH) anywhere in the storage are skipped, partial codons yield
+ * only the bases they hold.
+ */
+class base_iterator {
+  const codon::Codon* curr{nullptr};
+  const codon::Codon* last{nullptr};
+  std::uint8_t bits{0};
+  int len{0};
+  int pos{0};  // 1-based position inside the current codon
+
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = codon::base;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const codon::base*;
+  using reference = codon::base;
+
+  base_iterator() = default;
+  base_iterator(const codon::Codon* curr, const codon::Codon* last,
+                int pos = 1)
+      : curr{curr}, last{last}, pos{pos} {
+    this->settle();
+  }
+
+  reference operator*() const {
+    return static_cast<codon::base>(
+        (this->bits >> (2 * (this->len - this->pos))) & codon::base::T);
+  }
+
+  base_iterator& operator++() {
+    if (++this->pos > this->len) {
+      ++this->curr;
+      this->pos = 1;
+      this->settle();
+    }
+    return *this;
+  }
+  base_iterator operator++(int) {
+    base_iterator previous{*this};
+    ++(*this);
+    return previous;
+  }
+
+  bool operator==(const base_iterator& other) const {
+    return this->curr == other.curr && this->pos == other.pos;
+  }
+  bool operator!=(const base_iterator& other) const {
+    return !(*this == other);
+  }
+
+  // codon the iterator currently points into
+  const codon::Codon* get_codon() const { return this->curr; }
+  int get_shift() const { return this->pos; }
+
+ private:
+  void settle() {
+    // moves onto the next codon that holds at least one base
+    while (this->curr != this->last) {
+      this->len = this->curr->get_bases_len();
+      if (this->pos <= this->len) {
+        this->bits = static_cast<std::uint8_t>(this->curr->get_bases_int());
+        return;
+      }
+      ++this->curr;
+      this->pos = 1;
+    }
+    this->pos = 1;
+    this->len = 0;
+  }
+};
+
+class base_range {
+  codon::base_iterator first;
+  codon::base_iterator past_last;
+
+ public:
+  base_range(codon::base_iterator first, codon::base_iterator past_last)
+      : first{first}, past_last{past_last} {}
+
+  codon::base_iterator begin() const { return this->first; }
+  codon::base_iterator end() const { return this->past_last; }
+};
+
+/* Forward iterator over the packed k-mers (see kmer.h) of a base range.
+ * Dereferencing yields the k-mer ending at the current base; the
+ * reverse complement is rolled along so canonical k-mers cost nothing extra.
+ */
+class kmer_iterator {
+  codon::base_iterator curr;
+  codon::base_iterator past_last;
+  std::uint64_t forward{0};
+  std::uint64_t reverse{0};
+  std::uint64_t kmer_mask{0};
+  int high_shift{0};
+  bool use_canonical{false};
+
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::uint64_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const std::uint64_t*;
+  using reference = std::uint64_t;
+
+  kmer_iterator() = default;
+  kmer_iterator(codon::base_iterator curr, codon::base_iterator past_last,
+                int k, bool use_canonical)
+      : curr{curr},
+        past_last{past_last},
+        kmer_mask{(k >= 32) ? ~0ULL : ((1ULL << (2 * k)) - 1)},
+        high_shift{2 * (k - 1)},
+        use_canonical{use_canonical} {
+    // prime the window with the first k - 1 bases
+    for (int filled{1}; filled < k && this->curr != this->past_last;
+         ++filled) {
+      this->roll(*this->curr);
+      ++this->curr;
+    }
+    if (this->curr != this->past_last) this->roll(*this->curr);
+  }
+
+  reference operator*() const {
+    return (this->use_canonical && this->reverse < this->forward)
+               ? this->reverse
+               : this->forward;
+  }
+
+  kmer_iterator& operator++() {
+    if (++this->curr != this->past_last) this->roll(*this->curr);
+    return *this;
+  }
+  kmer_iterator operator++(int) {
+    kmer_iterator previous{*this};
+    ++(*this);
+    return previous;
+  }
+
+  bool operator==(const kmer_iterator& other) const {
+    return this->curr == other.curr;
+  }
+  bool operator!=(const kmer_iterator& other) const {
+    return this->curr != other.curr;
+  }
+
+ private:
+  void roll(codon::base base) {
+    this->forward = ((this->forward << 2) | base) & this->kmer_mask;
+    this->reverse = (this->reverse >> 2) |
+                    (static_cast<std::uint64_t>(base ^ codon::base::T)
+                     << this->high_shift);
+  }
+};
+
+class kmer_range {
+  codon::kmer_iterator first;
+  codon::kmer_iterator past_last;
+
+ public:
+  kmer_range(codon::kmer_iterator first, codon::kmer_iterator past_last)
+      : first{first}, past_last{past_last} {}
+
+  codon::kmer_iterator begin() const { return this->first; }
+  codon::kmer_iterator end() const { return this->past_last; }
+};
+
+}  // namespace codon
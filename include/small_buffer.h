@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+namespace codon {
+
+/* Memory resource with room for a single block of up to N bytes inside the
+ * object itself. The first request that fits is served from the inline
+ * buffer, everything else (larger requests or while the buffer is taken)
+ * is forwarded to the upstream resource. Meant to sit in front of exactly
+ * one container, which then only touches the heap once it outgrows N.
+ *
+ * Two of these compare equal when their upstreams do, so a container can
+ * take over a block that came from the upstream. Blocks inside the inline
+ * buffer must never change hands that way: owners check owns() first and
+ * copy the elements instead.
+ */
+template <std::size_t N>
+class small_buffer_resource : public std::pmr::memory_resource {
+  alignas(std::max_align_t) std::byte buffer[N ? N : 1];
+  bool in_use{false};
+  std::size_t allocations{0};
+  std::pmr::memory_resource* upstream;
+
+ public:
+  explicit small_buffer_resource(std::pmr::memory_resource* upstream =
+                                     std::pmr::get_default_resource())
+      : upstream{upstream} {}
+  small_buffer_resource(const small_buffer_resource&) = delete;
+  small_buffer_resource& operator=(const small_buffer_resource&) = delete;
+
+  static constexpr std::size_t capacity() { return N; }
+  std::pmr::memory_resource* upstream_resource() const {
+    return this->upstream;
+  }
+  bool owns(const void* ptr) const {
+    return ptr == static_cast<const void*>(this->buffer);
+  }
+  // every request so far, whether served inline or by the upstream
+  std::size_t get_num_allocations() const { return this->allocations; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++this->allocations;
+    if (!this->in_use && N && bytes <= N &&
+        alignment <= alignof(std::max_align_t)) {
+      this->in_use = true;
+      return this->buffer;
+    }
+    return this->upstream->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* ptr, std::size_t bytes,
+                     std::size_t alignment) override {
+    if (this->owns(ptr)) {
+      this->in_use = false;
+      return;
+    }
+    this->upstream->deallocate(ptr, bytes, alignment);
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    if (this == &other) return true;
+    const auto* sibling = dynamic_cast<const small_buffer_resource*>(&other);
+    return sibling && this->upstream->is_equal(*sibling->upstream);
+  }
+};
+
+}  // namespace codon
@@ -0,0 +1,133 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// opt-in instrumentation of Seq, set by the CMake option CODON_STATS
+#ifndef CODON_STATS
+#define CODON_STATS 0
+#endif
+
+namespace codon::stats {
+
+/* Process-wide counters of the work done inside Seq. With CODON_STATS off
+ * every hook below expands to nothing and snapshot() stays all zero, so
+ * the library pays nothing for them. With it on, every hook is a relaxed
+ * atomic add and counters are safe to bump from several threads.
+ */
+enum class counter : std::size_t {
+  shifted_codons,     // codons touched by left_shift() and right_shift()
+  reallocations,      // codon storage grown beyond its capacity
+  mid_inserts,        // vector inserts in front of the last codon
+  mid_insert_codons,  // codons moved back by those inserts
+  void_codons,        // codons emptied to VOID, even if refilled later
+  first_idx_scans,    // codons looked at by get_first_idx()
+  last_idx_scans,     // codons looked at by get_last_idx()
+  num_counters
+};
+
+/* public Seq methods with a wall-clock timer. Times are inclusive, so an
+ * insert_codon() that shifts also shows up under left_shift.
+ */
+enum class method : std::size_t {
+  insert_base,
+  insert_codon,
+  insert_seq,
+  pop_base,
+  pop_codon,
+  erase,
+  apply_edits,
+  left_shift,
+  right_shift,
+  compact,
+  locate,
+  offset_of,
+  get_seq_str,
+  count_bases,
+  num_methods
+};
+
+constexpr bool enabled = CODON_STATS;
+constexpr std::size_t NUM_COUNTERS =
+    static_cast<std::size_t>(counter::num_counters);
+constexpr std::size_t NUM_METHODS =
+    static_cast<std::size_t>(method::num_methods);
+
+struct MethodTiming {
+  std::uint64_t calls;
+  std::uint64_t nanoseconds;
+};
+
+// copy of all counters at one point in time, subtract two for a delta
+struct Snapshot {
+  std::array<std::uint64_t, NUM_COUNTERS> counters{};
+  std::array<MethodTiming, NUM_METHODS> methods{};
+
+  std::uint64_t get(counter which) const {
+    return this->counters[static_cast<std::size_t>(which)];
+  }
+  const MethodTiming& get(method which) const {
+    return this->methods[static_cast<std::size_t>(which)];
+  }
+
+  Snapshot operator-(const Snapshot& earlier) const;
+};
+
+codon::stats::Snapshot snapshot();
+void reset();
+const char* name(codon::stats::counter which);
+const char* name(codon::stats::method which);
+// one line per non-zero counter and per called method
+std::ostream& operator<<(std::ostream& out, const codon::stats::Snapshot& snap);
+
+namespace detail {
+
+extern std::array<std::atomic<std::uint64_t>, NUM_COUNTERS> counters;
+extern std::array<std::atomic<std::uint64_t>, NUM_METHODS> calls;
+extern std::array<std::atomic<std::uint64_t>, NUM_METHODS> nanoseconds;
+
+inline void add(codon::stats::counter which, std::uint64_t amount) {
+  counters[static_cast<std::size_t>(which)].fetch_add(
+      amount, std::memory_order_relaxed);
+}
+
+// adds the time until the end of the scope to one method
+class scoped_timer {
+  using clock = std::chrono::steady_clock;
+
+  std::size_t slot;
+  clock::time_point started;
+
+ public:
+  explicit scoped_timer(codon::stats::method which)
+      : slot{static_cast<std::size_t>(which)}, started{clock::now()} {}
+  scoped_timer(const scoped_timer&) = delete;
+  scoped_timer& operator=(const scoped_timer&) = delete;
+  ~scoped_timer() {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock::now() - this->started);
+    calls[this->slot].fetch_add(1, std::memory_order_relaxed);
+    nanoseconds[this->slot].fetch_add(elapsed.count(),
+                                      std::memory_order_relaxed);
+  }
+};
+
+}  // namespace detail
+
+}  // namespace codon::stats
+
+// hooks for the library itself, amount is not evaluated when disabled
+#if CODON_STATS
+#define CODON_STATS_ADD(name, amount) \
+  codon::stats::detail::add(codon::stats::counter::name, (amount))
+#define CODON_STATS_TIME(name)                            \
+  codon::stats::detail::scoped_timer codon_stats_timer_ { \
+    codon::stats::method::name                            \
+  }
+#else
+#define CODON_STATS_ADD(name, amount) static_cast<void>(0)
+#define CODON_STATS_TIME(name) static_cast<void>(0)
+#endif
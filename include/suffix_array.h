@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fm_index.h"
+#include "mapped_file.h"
+#include "seq.h"
+
+namespace codon {
+namespace index {
+
+struct sa_options {
+  unsigned threads{0};  // 0 uses std::thread::hardware_concurrency()
+  bool with_lcp{true};
+};
+
+struct sa_stats {
+  unsigned threads{1};
+  std::size_t rounds{0};       // prefix doubling rounds
+  std::size_t peak_bytes{0};   // largest amount of working memory in use
+  std::size_t image_bytes{0};  // size of the final SA + LCP image
+  double build_seconds{0.0};
+};
+
+/* Generalised suffix array (and LCP array) over a collection of Seq objects.
+ *
+ * Every sequence is terminated by its own unique separator that sorts before
+ * all bases (and by sequence id among separators), so no suffix and no LCP
+ * value ever crosses from one sequence into the next. Bases are ordered
+ * lexicographically (A < C < G < T).
+ *
+ * Construction uses prefix doubling where every round is a parallel LSD
+ * radix sort of (rank[i], rank[i + h]) pairs, the LCP array is computed with
+ * the PLCP/phi method in parallel chunks. Entries are 32-bit, which limits
+ * the collection to 2^32 - 1 bases and separators in total.
+ *
+ * Like the FMIndex, the result is one contiguous image that save() writes
+ * verbatim and load() maps back into memory.
+ */
+class SuffixArray {
+  std::vector<std::uint64_t> owned_image;
+  std::unique_ptr<codon::io::MappedFile> mapped_image;
+  const std::uint8_t* image{nullptr};
+  std::size_t image_len{0};
+
+  std::size_t text_len{0};
+  std::size_t num_seqs{0};
+  const std::uint64_t* seq_starts{nullptr};
+  const std::uint32_t* sa{nullptr};
+  const std::uint32_t* lcp{nullptr};
+  codon::index::sa_stats stats;
+
+ public:
+  SuffixArray(const std::vector<codon::Seq>& seqs,
+              codon::index::sa_options options = codon::index::sa_options{});
+  SuffixArray(SuffixArray&&) noexcept = default;
+  SuffixArray& operator=(SuffixArray&&) noexcept = default;
+  SuffixArray(const SuffixArray&) = delete;
+  SuffixArray& operator=(const SuffixArray&) = delete;
+  ~SuffixArray();
+
+  static SuffixArray load(const std::string& path);
+  void save(const std::string& path) const;
+
+  std::size_t size() const { return this->text_len; }
+  std::size_t get_num_seqs() const { return this->num_seqs; }
+  bool has_lcp() const { return this->lcp != nullptr; }
+
+  // text position of the suffix with the given rank
+  std::size_t get_sa(std::size_t rank) const { return this->sa[rank]; }
+  // longest common prefix of the suffixes with rank and rank - 1 (0 for 0)
+  std::size_t get_lcp(std::size_t rank) const { return this->lcp[rank]; }
+  const std::uint32_t* sa_data() const { return this->sa; }
+  const std::uint32_t* lcp_data() const { return this->lcp; }
+
+  // sequence id and base offset for a text position (separators map to the
+  // offset one past the end of their sequence)
+  codon::index::hit get_hit(std::size_t text_pos) const;
+
+  const codon::index::sa_stats& get_stats() const { return this->stats; }
+
+ private:
+  SuffixArray() = default;
+  void attach(const std::uint8_t* image, std::size_t image_len);
+};
+
+}  // namespace index
+}  // namespace codon
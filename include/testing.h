@@ -1,9 +1,16 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "codon.h"
+#include "fm_index.h"
+#include "gzip.h"
+#include "kmer_filter.h"
 #include "seq.h"
+#include "suffix_array.h"
 
 namespace test {
 
@@ -36,4 +43,139 @@ void check_insertions_codons(std::vector<codon::Seq> &vec_seq,
 void check_insertion_codon(codon::Seq &seq, codon::Codon insert,
                            codon::locator locator);
 
+void check_insertions_seqs(const std::vector<codon::Seq> &vec_seq);
+void check_insertion_seq(codon::Seq seq, const codon::Seq &insert,
+                         codon::locator locator);
+
+void check_erasures(const std::vector<codon::Seq> &vec_seq);
+void check_erasure(codon::Seq seq, codon::locator first, codon::locator last);
+
+void check_apply_edits(const std::string &bases_str);
+void check_locate(const std::vector<codon::Seq> &vec_seq);
+void check_locate_seq(const codon::Seq &seq);
+void check_locate_concurrent(const codon::Seq &seq);
+void check_compact(codon::Seq seq);
+void check_arena(const std::vector<std::string> &vec_str);
+void check_small_buffer();
+void check_capacity_policy();
+void check_move();
+
+std::string random_bases(std::size_t len);
+
+int fm_index_test();
+void check_corrupt_fm_index(const codon::index::FMIndex &fm_index);
+void check_fm_index_queries(const codon::index::FMIndex &fm_index,
+                            const std::vector<std::string> &arr_seq);
+
+int suffix_array_test();
+void check_corrupt_suffix_array(const codon::index::SuffixArray &suffix_array);
+void check_suffix_array(const std::vector<std::string> &arr_seq,
+                        unsigned threads);
+
+int kmer_filter_test();
+void check_kmer_packing();
+void check_cuckoo_collision();
+void check_corrupt_filters(const codon::filter::KmerBloom &bloom,
+                           const codon::filter::KmerCuckoo &cuckoo);
+
+template <typename Filter>
+void check_kmer_filter(const Filter &filter,
+                       const std::vector<codon::Seq> &host_reads,
+                       const std::vector<codon::Seq> &foreign_reads) {
+  // no false negatives, and false positives stay rare
+  std::size_t foreign_matches{0};
+  for (const codon::Seq &read : host_reads) {
+    REQUIRE(filter.matches(read, 1.0));
+  }
+  for (const codon::Seq &read : foreign_reads) {
+    if (filter.matches(read, 0.1)) ++foreign_matches;
+  }
+  REQUIRE(foreign_matches == 0);
+}
+
+int seq_iterator_test();
+void check_seq_iteration(const codon::Seq &seq, const std::string &expected);
+
+int liftover_test();
+void check_liftover_ops(std::size_t len, int num_ops);
+void check_seq_liftover(const std::string &bases_str);
+
+int seq_view_test();
+void check_seq_view(const codon::Seq &seq, const std::string &bases_str,
+                    std::size_t first_base, std::size_t last_base);
+
+int stats_test();
+void check_stats_counters();
+void check_stats_threads(unsigned threads, int shifts);
+
+int translate_test();
+void check_translation(const std::string &bases_str);
+
+int wild_seq_test();
+void check_wild_codon();
+void check_wild_seq(const std::string &input);
+
+int parallel_test();
+void check_chunking();
+void check_parallel_ops(const std::vector<std::string> &inputs,
+                        unsigned threads);
+void check_large_seq(const std::string &bases_str);
+
+int fastq_test();
+void check_fastq_parsing();
+void check_fastq_stream(const std::string &fastq,
+                        const std::vector<std::string> &names,
+                        const std::vector<std::string> &bases,
+                        const std::vector<std::string> &qualities,
+                        std::size_t buffer_bytes);
+
+int gzip_test();
+void check_decompression(const std::string &compressed,
+                         const std::string &expected,
+                         codon::io::compression format, unsigned threads);
+void check_gzip(const std::string &data);
+void check_corrupt_bgzf(const std::string &bgzf);
+
+int pipeline_test();
+void check_record_reader();
+void check_pipeline(const std::string &input, unsigned threads);
+
+// producers push 0..count-1 each, consumers have to see every value once
+template <typename Queue>
+void check_queue(unsigned producers, unsigned consumers) {
+  constexpr std::size_t count{20000};
+  Queue queue(8);
+  REQUIRE(queue.capacity() == 8);
+  std::atomic<std::size_t> sum{0};
+  std::atomic<std::size_t> popped{0};
+  std::atomic<unsigned> active{producers};
+  // Catch assertions are not thread-safe, workers only record failures
+  std::atomic<bool> pushed_all{true};
+  std::vector<std::thread> threads;
+  for (unsigned idx{0}; idx < producers; ++idx) {
+    threads.emplace_back([&] {
+      for (std::size_t value{0}; value < count; ++value) {
+        if (!queue.push(value)) pushed_all = false;
+      }
+      if (active.fetch_sub(1) == 1) queue.close();
+    });
+  }
+  for (unsigned idx{0}; idx < consumers; ++idx) {
+    threads.emplace_back([&] {
+      std::size_t value{0};
+      while (queue.pop(value)) {
+        sum += value;
+        ++popped;
+      }
+    });
+  }
+  for (std::thread &thread : threads) thread.join();
+  REQUIRE(pushed_all);
+  REQUIRE(popped == producers * count);
+  REQUIRE(sum == producers * count * (count - 1) / 2);
+  std::size_t value{0};
+  REQUIRE(!queue.try_pop(value));
+  REQUIRE(!queue.push(value));
+}
+
 }  // namespace test
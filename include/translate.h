@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+
+#include "codon.h"
+#include "seq.h"
+#include "wild_seq.h"
+
+namespace codon {
+
+/* Translation with the standard genetic code (NCBI table 1), amino acids as
+ * one-letter codes and stop codons as '*'.
+ *
+ * A full Codon's payload indexes a 64-entry table directly, so a canonical
+ * sequence translates codon by codon. Other layouts are re-framed from the
+ * first base on the fly. A trailing partial codon is dropped. From
+ * CODON_PARALLEL_MIN_CODONS codons on, blocks of codons are translated on
+ * the shared thread pool (see parallel.h).
+ */
+char translate_codon(const codon::Codon& codon);
+std::string translate(const codon::Seq& seq);
+
+/* An ambiguous codon translates to the amino acid all of its expansions
+ * share ("CTN" is L), to 'X' if they differ or hold a gap, and "---" to
+ * '-'. The WildSeq overload translates its Seq as above and only redoes
+ * the codons that touch an ambiguous run.
+ */
+char translate_codon(const codon::WildCodon& codon);
+std::string translate(const codon::WildSeq& seq);
+
+}  // namespace codon
@@ -0,0 +1,125 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "codon.h"
+#include "seq.h"
+
+namespace codon {
+
+/* IUPAC nucleotide codes as the set of bases they stand for, one bit per
+ * codon::base (1 << base): N is all four, R is A or G, and so on. The gap
+ * '-' is the empty set. Lower case is accepted, symbols come back upper
+ * case.
+ */
+constexpr std::uint8_t INVALID_MASK = 0xFF;
+std::uint8_t iupac_mask(char symbol);
+char iupac_symbol(std::uint8_t mask);
+
+/* Up to three IUPAC symbols, the ambiguity-aware counterpart of Codon.
+ *
+ * Unlike Codon this is a value for inspecting single triplets (4 bytes,
+ * one mask per symbol), WildSeq does not store its sequence as WildCodons.
+ */
+class WildCodon {
+  std::array<std::uint8_t, 3> masks{};
+  std::uint8_t len{0};
+
+ public:
+  // up to 3 IUPAC symbols, anything else throws std::invalid_argument
+  explicit WildCodon(const std::string& symbols);
+  explicit WildCodon(const codon::Codon& codon);
+
+  static WildCodon from_masks(const std::array<std::uint8_t, 3>& masks,
+                              int len);
+
+  bool is_full() const { return this->len == 3; }
+  // whether any symbol is something else than a single base
+  bool is_wild() const;
+
+  int get_bases_len() const { return this->len; }
+  std::string get_bases_str() const;
+  // shift 1 to get_bases_len(), as for Codon::get_base_at()
+  std::uint8_t get_mask_at(int shift) const;
+  char get_symbol_at(int shift) const;
+
+  // concrete codons this stands for, 0 as soon as it holds a gap
+  int count_expansions() const;
+  // whether codon is one of them
+  bool matches(const codon::Codon& codon) const;
+  // the single Codon it stands for, throws std::invalid_argument if wild
+  codon::Codon to_codon() const;
+};
+
+// bases first to first + length - 1 all hold symbol
+struct wild_run {
+  std::size_t first;
+  std::size_t length;
+  char symbol;
+};
+
+/* Sequence of IUPAC symbols stored as a plain Seq plus a sparse table of
+ * the runs that are not A, C, G or T.
+ *
+ * Ambiguous positions hold an A in the Seq, so the 2-bit kernels run on
+ * the whole sequence unchanged and only the runs are patched afterwards:
+ * get_seq_str() overwrites them, count_bases() subtracts them and
+ * translate() re-translates just the codons they touch. A run of N costs
+ * one entry however long it is. Code that must not see the placeholders,
+ * k-mers for instance, works on pure_slices() instead.
+ *
+ * The layout is canonical (base pos sits in codon pos / 3). A WildSeq is
+ * read-only apart from assign(), editing would shift the runs.
+ */
+class WildSeq {
+  codon::Seq seq;
+  std::vector<codon::wild_run> runs;
+  std::size_t length{0};
+  std::size_t num_wild{0};
+
+ public:
+  explicit WildSeq(
+      std::string_view input,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /* replaces the content, reusing the storage like Seq::assign(). Symbols
+   * other than IUPAC codes throw std::invalid_argument and leave it empty.
+   */
+  void assign(std::string_view input);
+
+  // the sequence with placeholders, see above
+  const codon::Seq& get_seq() const { return this->seq; }
+  // sorted and disjoint, neighbouring runs hold different symbols
+  const std::vector<codon::wild_run>& get_runs() const { return this->runs; }
+
+  std::size_t get_seq_len() const { return this->length; }
+  // positions that are not A, C, G or T
+  std::size_t get_num_wild() const { return this->num_wild; }
+  bool is_wild() const { return !this->runs.empty(); }
+
+  std::string get_seq_str() const;
+  // occurrences of A, C, G and T, indexed by codon::base
+  std::array<std::size_t, 4> count_bases() const;
+  char get_symbol_at(std::size_t pos) const;
+  // codon index, the last codon may be partial
+  codon::WildCodon get_codon_at(std::size_t index) const;
+
+  // whether bases [first, last) are all A, C, G or T
+  bool is_pure(std::size_t first, std::size_t last) const;
+  /* views over the stretches between the runs that hold at least min_bases
+   * bases, in sequence order. Every Seq kernel applies to them as is.
+   */
+  std::vector<codon::SeqView> pure_slices(std::size_t min_bases = 1) const;
+
+ private:
+  // first run that ends behind pos
+  std::vector<codon::wild_run>::const_iterator run_after(
+      std::size_t pos) const;
+};
+
+}  // namespace codon
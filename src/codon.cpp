@@ -72,6 +72,11 @@ codon::Codon::Codon(const std::string& bases_str) {
         case 'T':
           generator = generator << 2 | T;
           break;
+        default:
+          // ambiguity codes and gaps belong into a WildCodon (wild_seq.h)
+          throw std::invalid_argument(
+              std::string("Codon expects A, C, G or T but received '") +
+              bases_str[i] + "'.");
       }
     }
     this->bases = static_cast<uint8_t>(generator);
@@ -80,7 +85,11 @@ codon::Codon::Codon(const std::string& bases_str) {
 
 codon::Codon::Codon(base base) { this->bases = LOC_2_m5 | base; }
 
-codon::Codon::~Codon() {}
+codon::Codon codon::Codon::from_bits(std::uint8_t bits) {
+  codon::Codon from_raw{codon::base::A};
+  from_raw.bases = bits;
+  return from_raw;
+}
 
 bool codon::Codon::is_full() const { return (this->get_bases_len() == 3); }
 bool codon::Codon::is_empty() const { return (this->get_bases_len() == 0); }
@@ -0,0 +1,170 @@
+#include "fastq.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gzip.h"
+#include "seq.h"
+
+std::string codon::io::SeqRecord::get_quality_str() const {
+  std::string quality_str(this->qualities.size(), '!');
+  for (std::size_t idx{0}; idx < this->qualities.size(); ++idx) {
+    quality_str[idx] =
+        static_cast<char>(this->qualities[idx] + codon::io::PHRED_OFFSET);
+  }
+  return quality_str;
+}
+
+double codon::io::SeqRecord::mean_quality() const {
+  if (this->qualities.empty()) return 0.0;
+  std::size_t sum{0};
+  for (std::uint8_t curr : this->qualities) sum += curr;
+  return static_cast<double>(sum) / this->qualities.size();
+}
+
+codon::io::LineReader::LineReader(std::istream& in, std::size_t buffer_bytes)
+    : in{&in}, buffer(std::max<std::size_t>(buffer_bytes, 64)) {}
+
+void codon::io::LineReader::refill() {
+  // the unfinished line moves to the front, the rest of the block is read
+  std::size_t pending{this->end - this->begin};
+  if (this->begin) {
+    std::memmove(this->buffer.data(), this->buffer.data() + this->begin,
+                 pending);
+    this->begin = 0;
+    this->end = pending;
+  }
+  // a single line longer than the whole buffer
+  if (this->end == this->buffer.size()) this->buffer.resize(2 * this->end);
+
+  this->in->read(this->buffer.data() + this->end,
+                 static_cast<std::streamsize>(this->buffer.size() - this->end));
+  std::size_t count{static_cast<std::size_t>(this->in->gcount())};
+  this->end += count;
+  if (count == 0) this->at_eof = true;
+}
+
+bool codon::io::LineReader::next(std::string_view& line) {
+  while (true) {
+    const char* first{this->buffer.data() + this->begin};
+    std::size_t available{this->end - this->begin};
+    const char* newline{
+        static_cast<const char*>(std::memchr(first, '\n', available))};
+    std::size_t length;
+    if (newline) {
+      length = static_cast<std::size_t>(newline - first);
+      this->begin += length + 1;
+    } else if (this->at_eof) {
+      // last line without a line break
+      if (available == 0) return false;
+      length = available;
+      this->begin = this->end;
+    } else {
+      this->refill();
+      continue;
+    }
+    // files written on Windows end their lines in "\r\n"
+    if (length && first[length - 1] == '\r') --length;
+    line = std::string_view(first, length);
+    ++this->line_number;
+    return true;
+  }
+}
+
+codon::io::FastqReader::FastqReader(std::istream& in,
+                                    std::size_t buffer_bytes)
+    : lines{in, buffer_bytes} {}
+
+codon::io::FastqReader::FastqReader(const std::string& path,
+                                    std::size_t buffer_bytes, unsigned threads)
+    : owned{std::make_unique<codon::io::InputFile>(path, threads)},
+      lines{*owned, buffer_bytes} {}
+
+void codon::io::FastqReader::fail(const std::string& message) const {
+  throw std::invalid_argument("FASTQ line " +
+                              std::to_string(this->lines.get_line_number()) +
+                              ": " + message);
+}
+
+bool codon::io::FastqReader::next(codon::io::SeqRecord& record) {
+  // INFO: a line view only lives until the following lines.next()
+  std::string_view line;
+  do {
+    if (!this->lines.next(line)) return false;
+  } while (line.empty());
+  if (line.front() != '@') {
+    this->fail("expected a header starting with '@' but found '" +
+               std::string(1, line.front()) + "'.");
+  }
+  record.name.assign(line.data() + 1, line.length() - 1);
+
+  this->bases.clear();
+  bool has_separator{false};
+  while (this->lines.next(line)) {
+    if (!line.empty() && line.front() == '+') {
+      has_separator = true;
+      break;
+    }
+    this->bases.append(line.data(), line.length());
+  }
+  if (!has_separator) this->fail("record '" + record.name + "' has no '+'.");
+
+  record.qualities.clear();
+  while (record.qualities.size() < this->bases.length() &&
+         this->lines.next(line)) {
+    std::size_t offset{record.qualities.size()};
+    record.qualities.resize(offset + line.length());
+    std::uint8_t* scores{record.qualities.data() + offset};
+    // '!' to '~' only, anything else wraps around or ends up above 93
+    std::uint8_t highest{0};
+    for (std::size_t idx{0}; idx < line.length(); ++idx) {
+      scores[idx] = static_cast<std::uint8_t>(
+          static_cast<unsigned char>(line[idx]) - codon::io::PHRED_OFFSET);
+      highest = std::max(highest, scores[idx]);
+    }
+    if (highest > codon::io::MAX_PHRED) {
+      for (char curr : line) {
+        if (curr < '!' || curr > '~') {
+          this->fail("'" + std::string(1, curr) +
+                     "' is no Phred+33 quality score.");
+        }
+      }
+    }
+  }
+  if (record.qualities.size() != this->bases.length()) {
+    this->fail("record '" + record.name + "' has " +
+               std::to_string(this->bases.length()) + " bases but " +
+               std::to_string(record.qualities.size()) + " quality scores.");
+  }
+
+  try {
+    record.seq.assign(this->bases);
+  } catch (const std::invalid_argument& error) {
+    this->fail("record '" + record.name + "': " + error.what());
+  }
+  ++this->num_records;
+  return true;
+}
+
+std::size_t codon::io::FastqReader::next_batch(
+    std::vector<codon::io::SeqRecord>& batch, std::size_t max_records) {
+  std::size_t count{0};
+  while (count < max_records) {
+    bool added{count == batch.size()};
+    if (added) batch.emplace_back();
+    if (!this->next(batch[count])) {
+      if (added) batch.pop_back();
+      break;
+    }
+    ++count;
+  }
+  return count;
+}
@@ -0,0 +1,634 @@
+#include "fm_index.h"
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "codon.h"
+#include "kmer.h"
+#include "mapped_file.h"
+#include "seq.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* Text alphabet used inside the index. Bases are stored with their
+ * codon::base value offset by two so that the sentinel and the separator
+ * sort before every base.
+ */
+constexpr std::uint8_t SYM_SENTINEL = 0;
+constexpr std::uint8_t SYM_SEPARATOR = 1;
+constexpr std::uint8_t SYM_BASE_OFFSET = 2;
+constexpr std::uint8_t SYM_COUNT = 6;
+
+constexpr char FM_MAGIC[8] = {'C', 'O', 'D', 'O', 'N', 'F', 'M', 'I'};
+constexpr std::uint64_t FM_VERSION = 1;
+
+constexpr std::uint64_t PATTERN_A = 0x0000000000000000ULL;
+constexpr std::uint64_t PATTERN_G = 0x5555555555555555ULL;
+constexpr std::uint64_t PATTERN_C = 0xAAAAAAAAAAAAAAAAULL;
+constexpr std::uint64_t PATTERN_T = 0xFFFFFFFFFFFFFFFFULL;
+constexpr std::uint64_t EVEN_BITS = 0x5555555555555555ULL;
+
+namespace codon {
+namespace index {
+namespace detail {
+
+struct fm_header {
+  char magic[8];
+  std::uint64_t version;
+  std::uint64_t text_len;  // including separators and the sentinel
+  std::uint64_t num_seqs;
+  std::uint64_t sa_rate;
+  std::uint64_t sentinel_row;
+  std::uint64_t cumulative[8];  // C[] per text symbol, C[SYM_COUNT] = n
+  std::uint64_t num_blocks;
+  std::uint64_t num_samples;
+  std::uint64_t off_starts;  // byte offsets of the sections in the image
+  std::uint64_t off_occ;
+  std::uint64_t off_marks;
+  std::uint64_t off_samples;
+};
+
+/* One cache line per 64 BWT symbols: counts of every base before the block,
+ * count of separators/sentinel before the block, a bitmap of those special
+ * symbols and the symbols themselves packed 2 bits each (specials as A).
+ */
+struct alignas(64) occ_block {
+  std::uint64_t counts[4];
+  std::uint64_t special_before;
+  std::uint64_t special;
+  std::uint64_t bases[2];
+};
+
+struct rank_block {
+  std::uint64_t before;
+  std::uint64_t bits;
+};
+
+}  // namespace detail
+}  // namespace index
+}  // namespace codon
+
+static_assert(sizeof(codon::index::detail::occ_block) == 64,
+              "occ_block is expected to fill exactly one cache line");
+
+namespace {
+
+inline int popcount64(std::uint64_t word) {
+#if defined(_MSC_VER)
+  return static_cast<int>(__popcnt64(word));
+#else
+  return __builtin_popcountll(word);
+#endif
+}
+
+inline std::uint64_t low_mask(std::size_t bits) {
+  return (bits >= 64) ? ~0ULL : ((1ULL << bits) - 1);
+}
+
+inline std::uint64_t base_pattern(codon::base base) {
+  switch (base) {
+    case codon::base::A:
+      return PATTERN_A;
+    case codon::base::G:
+      return PATTERN_G;
+    case codon::base::C:
+      return PATTERN_C;
+    case codon::base::T:
+      return PATTERN_T;
+  }
+  return PATTERN_A;
+}
+
+// counts the occurrences of base in the first `symbols` 2-bit slots of word
+inline std::size_t count_matches(std::uint64_t word, codon::base base,
+                                 std::size_t symbols) {
+  std::uint64_t diff = word ^ base_pattern(base);
+  std::uint64_t matches = ~(diff | (diff >> 1)) & EVEN_BITS;
+  return popcount64(matches & low_mask(symbols * 2));
+}
+
+inline std::size_t align_up(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/* whether count elements of T starting at byte offset lie inside the image
+ * and are aligned for T. Divides instead of multiplying, header fields of a
+ * corrupt file can be anything.
+ */
+template <typename T>
+bool section_fits(std::uint64_t offset, std::uint64_t count,
+                  std::size_t image_len) {
+  return offset % alignof(T) == 0 && offset <= image_len &&
+         count <= (image_len - offset) / sizeof(T);
+}
+
+/* SA-IS (Nong, Zhang & Chan 2009). The text has to end with a unique
+ * smallest symbol (0). Char is the symbol type of the current level and Idx
+ * the index type, which is reused as the symbol type for the reduced
+ * problem that is recursed into.
+ */
+template <typename Idx>
+constexpr Idx SAIS_EMPTY = std::numeric_limits<Idx>::max();
+
+template <typename Char, typename Idx>
+void sais_buckets(const Char* text, Idx n, Idx alphabet,
+                  std::vector<Idx>& buckets, bool at_end) {
+  std::fill(buckets.begin(), buckets.end(), 0);
+  for (Idx i{0}; i < n; ++i) ++buckets[text[i]];
+  Idx sum{0};
+  for (Idx c{0}; c < alphabet; ++c) {
+    sum += buckets[c];
+    buckets[c] = (at_end) ? sum : sum - buckets[c];
+  }
+}
+
+template <typename Char, typename Idx>
+void sais_induce(const Char* text, Idx* sa, Idx n, Idx alphabet,
+                 const std::vector<bool>& is_s, std::vector<Idx>& buckets) {
+  // L-type suffixes from left to right
+  sais_buckets(text, n, alphabet, buckets, false);
+  for (Idx i{0}; i < n; ++i) {
+    if (sa[i] != SAIS_EMPTY<Idx> && sa[i] > 0) {
+      Idx j = sa[i] - 1;
+      if (!is_s[j]) sa[buckets[text[j]]++] = j;
+    }
+  }
+  // S-type suffixes from right to left
+  sais_buckets(text, n, alphabet, buckets, true);
+  for (Idx i{n}; i-- > 0;) {
+    if (sa[i] != SAIS_EMPTY<Idx> && sa[i] > 0) {
+      Idx j = sa[i] - 1;
+      if (is_s[j]) sa[--buckets[text[j]]] = j;
+    }
+  }
+}
+
+template <typename Char, typename Idx>
+void sais(const Char* text, Idx* sa, Idx n, Idx alphabet) {
+  if (n == 1) {
+    sa[0] = 0;
+    return;
+  }
+
+  std::vector<bool> is_s(n, false);
+  is_s[n - 1] = true;
+  for (Idx i{n - 1}; i-- > 0;) {
+    is_s[i] = text[i] < text[i + 1] ||
+              (text[i] == text[i + 1] && is_s[i + 1]);
+  }
+  auto is_lms = [&](Idx i) { return i > 0 && is_s[i] && !is_s[i - 1]; };
+
+  // STEP 1 SORT LMS SUBSTRINGS
+  std::vector<Idx> buckets(alphabet);
+  sais_buckets(text, n, alphabet, buckets, true);
+  std::fill(sa, sa + n, SAIS_EMPTY<Idx>);
+  for (Idx i{1}; i < n; ++i) {
+    if (is_lms(i)) sa[--buckets[text[i]]] = i;
+  }
+  sais_induce(text, sa, n, alphabet, is_s, buckets);
+
+  // STEP 2 NAME THE SORTED LMS SUBSTRINGS
+  Idx n_lms{0};
+  for (Idx i{0}; i < n; ++i) {
+    if (is_lms(sa[i])) sa[n_lms++] = sa[i];
+  }
+  std::fill(sa + n_lms, sa + n, SAIS_EMPTY<Idx>);
+
+  Idx name{0};
+  Idx previous{SAIS_EMPTY<Idx>};
+  for (Idx i{0}; i < n_lms; ++i) {
+    Idx pos = sa[i];
+    bool differs = false;
+    for (Idx d{0}; d < n; ++d) {
+      if (previous == SAIS_EMPTY<Idx> ||
+          text[pos + d] != text[previous + d] ||
+          is_s[pos + d] != is_s[previous + d]) {
+        differs = true;
+        break;
+      } else if (d > 0 && (is_lms(pos + d) || is_lms(previous + d))) {
+        break;
+      }
+    }
+    if (differs) {
+      ++name;
+      previous = pos;
+    }
+    sa[n_lms + pos / 2] = name - 1;
+  }
+  for (Idx i{n}, j{n}; i-- > n_lms;) {
+    if (sa[i] != SAIS_EMPTY<Idx>) sa[--j] = sa[i];
+  }
+
+  // STEP 3 SORT THE REDUCED PROBLEM (recursively if names are not unique)
+  Idx* reduced = sa + n - n_lms;
+  if (name < n_lms) {
+    sais<Idx, Idx>(reduced, sa, n_lms, name);
+  } else {
+    for (Idx i{0}; i < n_lms; ++i) sa[reduced[i]] = i;
+  }
+
+  // STEP 4 INDUCE THE FULL SUFFIX ARRAY FROM THE SORTED LMS SUFFIXES
+  for (Idx i{1}, j{0}; i < n; ++i) {
+    if (is_lms(i)) reduced[j++] = i;
+  }
+  for (Idx i{0}; i < n_lms; ++i) sa[i] = reduced[sa[i]];
+  std::fill(sa + n_lms, sa + n, SAIS_EMPTY<Idx>);
+
+  sais_buckets(text, n, alphabet, buckets, true);
+  for (Idx i{n_lms}; i-- > 0;) {
+    Idx j = sa[i];
+    sa[i] = SAIS_EMPTY<Idx>;
+    sa[--buckets[text[j]]] = j;
+  }
+  sais_induce(text, sa, n, alphabet, is_s, buckets);
+}
+
+template <typename Idx>
+std::vector<std::uint64_t> build_image(const std::vector<std::uint8_t>& text,
+                                       const std::vector<std::uint64_t>& starts,
+                                       std::size_t sa_rate) {
+  using codon::index::detail::fm_header;
+  using codon::index::detail::occ_block;
+  using codon::index::detail::rank_block;
+
+  const std::size_t n = text.size();
+  std::vector<Idx> sa(n);
+  sais<std::uint8_t, Idx>(text.data(), sa.data(), static_cast<Idx>(n),
+                          static_cast<Idx>(SYM_COUNT));
+  PLOGD << "Suffix array for " << n << " symbols constructed";
+
+  std::size_t num_blocks = n / 64 + 1;
+  std::size_t num_mark_blocks = n / 64 + 1;
+  std::size_t num_samples{0};
+  for (std::size_t row{0}; row < n; ++row) {
+    if (sa[row] % sa_rate == 0) ++num_samples;
+  }
+
+  std::size_t off_starts = align_up(sizeof(fm_header), 64);
+  std::size_t off_occ =
+      align_up(off_starts + starts.size() * sizeof(std::uint64_t), 64);
+  std::size_t off_marks = off_occ + num_blocks * sizeof(occ_block);
+  std::size_t off_samples =
+      align_up(off_marks + num_mark_blocks * sizeof(rank_block), 64);
+  std::size_t total = off_samples + num_samples * sizeof(std::uint64_t);
+
+  std::vector<std::uint64_t> image(align_up(total, 8) / 8, 0);
+  std::uint8_t* bytes = reinterpret_cast<std::uint8_t*>(image.data());
+
+  fm_header* header = reinterpret_cast<fm_header*>(bytes);
+  std::memcpy(header->magic, FM_MAGIC, sizeof(FM_MAGIC));
+  header->version = FM_VERSION;
+  header->text_len = n;
+  header->num_seqs = starts.size() - 1;
+  header->sa_rate = sa_rate;
+  header->num_blocks = num_blocks;
+  header->num_samples = num_samples;
+  header->off_starts = off_starts;
+  header->off_occ = off_occ;
+  header->off_marks = off_marks;
+  header->off_samples = off_samples;
+
+  std::uint64_t symbol_counts[SYM_COUNT]{};
+  for (std::uint8_t symbol : text) ++symbol_counts[symbol];
+  header->cumulative[0] = 0;
+  for (std::size_t s{0}; s < SYM_COUNT; ++s)
+    header->cumulative[s + 1] = header->cumulative[s] + symbol_counts[s];
+
+  std::memcpy(bytes + off_starts, starts.data(),
+              starts.size() * sizeof(std::uint64_t));
+
+  occ_block* blocks = reinterpret_cast<occ_block*>(bytes + off_occ);
+  rank_block* marks = reinterpret_cast<rank_block*>(bytes + off_marks);
+  std::uint64_t* samples =
+      reinterpret_cast<std::uint64_t*>(bytes + off_samples);
+
+  std::uint64_t running[4]{};
+  std::uint64_t running_special{0};
+  std::uint64_t running_marks{0};
+  std::size_t sample_idx{0};
+  for (std::size_t row{0}; row < n; ++row) {
+    std::size_t block = row / 64;
+    std::size_t slot = row % 64;
+    if (slot == 0) {
+      std::copy(running, running + 4, blocks[block].counts);
+      blocks[block].special_before = running_special;
+      marks[block].before = running_marks;
+    }
+
+    std::uint8_t symbol = (sa[row] == 0)
+                              ? SYM_SENTINEL
+                              : text[static_cast<std::size_t>(sa[row]) - 1];
+    if (symbol < SYM_BASE_OFFSET) {
+      if (symbol == SYM_SENTINEL) header->sentinel_row = row;
+      blocks[block].special |= (1ULL << slot);
+      ++running_special;
+    } else {
+      std::uint64_t code = symbol - SYM_BASE_OFFSET;
+      blocks[block].bases[slot / 32] |= code << ((slot % 32) * 2);
+      ++running[code];
+    }
+
+    if (sa[row] % sa_rate == 0) {
+      marks[block].bits |= (1ULL << slot);
+      samples[sample_idx++] = static_cast<std::uint64_t>(sa[row]);
+      ++running_marks;
+    }
+  }
+  // the block holding row n only needs the totals for rank(n)
+  if (n % 64 == 0) {
+    std::copy(running, running + 4, blocks[n / 64].counts);
+    blocks[n / 64].special_before = running_special;
+    marks[n / 64].before = running_marks;
+  }
+
+  return image;
+}
+
+/* Image over the concatenated seqs, for any range whose elements bind to
+ * const codon::Seq& so that a single Seq is indexed without a copy.
+ */
+template <typename Seqs>
+std::vector<std::uint64_t> build_seqs_image(const Seqs& seqs,
+                                            std::size_t num_seqs,
+                                            std::size_t sa_rate) {
+  if (sa_rate == 0)
+    throw std::invalid_argument("FMIndex requires an sa_rate of at least 1.");
+
+  std::vector<std::uint64_t> starts;
+  starts.reserve(num_seqs + 1);
+  std::size_t text_len{0};
+  for (const codon::Seq& curr_seq : seqs) {
+    starts.push_back(text_len);
+    text_len += curr_seq.get_seq_trulen("bp") + 1;  // separator or sentinel
+  }
+  if (num_seqs == 0) text_len = 1;
+  starts.push_back(text_len);
+
+  std::vector<std::uint8_t> text;
+  text.reserve(text_len);
+  for (const codon::Seq& curr_seq : seqs) {
+    for (codon::base base : curr_seq.bases())
+      text.push_back(static_cast<std::uint8_t>(base + SYM_BASE_OFFSET));
+    text.push_back(SYM_SEPARATOR);
+  }
+  if (text.empty())
+    text.push_back(SYM_SENTINEL);
+  else
+    text.back() = SYM_SENTINEL;
+
+  PLOGD << "Building FMIndex over " << num_seqs << " sequences ("
+        << text.size() << " symbols, sa_rate = " << sa_rate << ")";
+
+  if (text.size() < std::numeric_limits<std::uint32_t>::max())
+    return build_image<std::uint32_t>(text, starts, sa_rate);
+  return build_image<std::uint64_t>(text, starts, sa_rate);
+}
+
+}  // namespace
+
+codon::index::FMIndex::FMIndex(const std::vector<codon::Seq>& seqs,
+                               std::size_t sa_rate)
+    : owned_image{build_seqs_image(seqs, seqs.size(), sa_rate)} {
+  this->attach(reinterpret_cast<const std::uint8_t*>(this->owned_image.data()),
+               this->owned_image.size() * sizeof(std::uint64_t));
+}
+
+codon::index::FMIndex::FMIndex(const codon::Seq& seq, std::size_t sa_rate)
+    : owned_image{build_seqs_image(
+          std::array<std::reference_wrapper<const codon::Seq>, 1>{seq}, 1,
+          sa_rate)} {
+  this->attach(reinterpret_cast<const std::uint8_t*>(this->owned_image.data()),
+               this->owned_image.size() * sizeof(std::uint64_t));
+}
+
+codon::index::FMIndex::~FMIndex() = default;
+
+void codon::index::FMIndex::attach(const std::uint8_t* image,
+                                   std::size_t image_len) {
+  if (image_len < sizeof(detail::fm_header))
+    throw std::runtime_error("FMIndex image is too small to hold a header.");
+
+  const detail::fm_header* header =
+      reinterpret_cast<const detail::fm_header*>(image);
+  if (std::memcmp(header->magic, FM_MAGIC, sizeof(FM_MAGIC)) != 0 ||
+      header->version != FM_VERSION) {
+    throw std::runtime_error("FMIndex image has an unknown format.");
+  }
+  // occ and marks both have a block per 64 rows, rank(n) included
+  if (header->text_len == 0 || header->sa_rate == 0 ||
+      header->sentinel_row >= header->text_len ||
+      header->num_seqs >= std::numeric_limits<std::uint64_t>::max() ||
+      header->num_blocks != header->text_len / 64 + 1 ||
+      header->num_samples > header->text_len ||
+      !section_fits<std::uint64_t>(header->off_starts, header->num_seqs + 1,
+                                   image_len) ||
+      !section_fits<detail::occ_block>(header->off_occ, header->num_blocks,
+                                       image_len) ||
+      !section_fits<detail::rank_block>(header->off_marks,
+                                        header->num_blocks, image_len) ||
+      !section_fits<std::uint64_t>(header->off_samples, header->num_samples,
+                                   image_len)) {
+    throw std::runtime_error("FMIndex image is truncated or corrupted.");
+  }
+
+  this->image = image;
+  this->image_len = image_len;
+  this->header = header;
+  this->seq_starts =
+      reinterpret_cast<const std::uint64_t*>(image + header->off_starts);
+  this->occ_blocks =
+      reinterpret_cast<const detail::occ_block*>(image + header->off_occ);
+  this->sample_marks =
+      reinterpret_cast<const detail::rank_block*>(image + header->off_marks);
+  this->samples =
+      reinterpret_cast<const std::uint64_t*>(image + header->off_samples);
+}
+
+codon::index::FMIndex codon::index::FMIndex::load(const std::string& path) {
+  FMIndex index;
+  index.mapped_image = std::make_unique<codon::io::MappedFile>(path);
+  index.attach(index.mapped_image->data(), index.mapped_image->size());
+  PLOGD << "Loaded FMIndex from '" << path << "' with "
+        << index.get_num_seqs() << " sequences";
+  return index;
+}
+
+void codon::index::FMIndex::save(const std::string& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) throw std::runtime_error("Could not open '" + path + "'.");
+  file.write(reinterpret_cast<const char*>(this->image),
+             static_cast<std::streamsize>(this->image_len));
+  if (!file) throw std::runtime_error("Could not write '" + path + "'.");
+}
+
+std::size_t codon::index::FMIndex::occ(codon::base base,
+                                       std::size_t row) const {
+  /* Number of occurrences of base in BWT[0, row). Specials are stored as A
+   * in the packed words and have to be subtracted again for A.
+   */
+  const detail::occ_block& block = this->occ_blocks[row / 64];
+  std::size_t slot = row % 64;
+  std::size_t occurrences = block.counts[base];
+
+  if (slot > 0) {
+    occurrences += count_matches(block.bases[0], base,
+                                 std::min<std::size_t>(slot, 32));
+  }
+  if (slot > 32) occurrences += count_matches(block.bases[1], base, slot - 32);
+  if (base == codon::base::A)
+    occurrences -= popcount64(block.special & low_mask(slot));
+
+  return occurrences;
+}
+
+std::size_t codon::index::FMIndex::lf(std::size_t row) const {
+  const detail::occ_block& block = this->occ_blocks[row / 64];
+  std::size_t slot = row % 64;
+
+  if (block.special >> slot & 1ULL) {
+    if (row == this->header->sentinel_row) return 0;
+    std::size_t separators = block.special_before +
+                             popcount64(block.special & low_mask(slot)) -
+                             ((this->header->sentinel_row < row) ? 1 : 0);
+    return this->header->cumulative[SYM_SEPARATOR] + separators;
+  }
+
+  codon::base base = static_cast<codon::base>(
+      block.bases[slot / 32] >> ((slot % 32) * 2) & codon::base::T);
+  return this->header->cumulative[base + SYM_BASE_OFFSET] +
+         this->occ(base, row);
+}
+
+bool codon::index::FMIndex::is_sampled(std::size_t row,
+                                       std::size_t& sample_idx) const {
+  const detail::rank_block& block = this->sample_marks[row / 64];
+  std::size_t slot = row % 64;
+  if (!(block.bits >> slot & 1ULL)) return false;
+  sample_idx = block.before + popcount64(block.bits & low_mask(slot));
+  return true;
+}
+
+codon::index::sa_interval codon::index::FMIndex::full_interval() const {
+  return codon::index::sa_interval{0, this->header->text_len};
+}
+
+codon::index::sa_interval codon::index::FMIndex::extend(
+    codon::index::sa_interval interval, codon::base base) const {
+  /* Backward extension: from the rows prefixed by P to the rows prefixed by
+   * base + P. Calling this from the last to the first base of a pattern is
+   * the classic backward search.
+   */
+  if (interval.empty()) return interval;
+  std::size_t offset = this->header->cumulative[base + SYM_BASE_OFFSET];
+  return codon::index::sa_interval{offset + this->occ(base, interval.first),
+                                   offset + this->occ(base, interval.last)};
+}
+
+codon::index::sa_interval codon::index::FMIndex::search(
+    const std::string& pattern) const {
+  codon::index::sa_interval interval{this->full_interval()};
+  for (std::size_t i{pattern.size()}; i-- > 0 && !interval.empty();) {
+    codon::base base{codon::base::A};
+    if (!codon::kmer::char_to_base(pattern[i], base))
+      return codon::index::sa_interval{0, 0};
+    interval = this->extend(interval, base);
+  }
+  return interval;
+}
+
+std::size_t codon::index::FMIndex::count(const std::string& pattern) const {
+  return this->search(pattern).size();
+}
+
+codon::index::sa_interval codon::index::FMIndex::search(
+    const codon::Seq& pattern) const {
+  // walks the codons back to front, so no decoding of the pattern is needed
+  codon::index::sa_interval interval{this->full_interval()};
+  for (codon::codon_iterator it{pattern.end()};
+       it != pattern.begin() && !interval.empty();) {
+    const codon::Codon& curr_codon = *--it;
+    for (int shift{curr_codon.get_bases_len()}; shift > 0; --shift)
+      interval = this->extend(interval, curr_codon.get_base_at(shift));
+  }
+  return interval;
+}
+
+std::size_t codon::index::FMIndex::count(const codon::Seq& pattern) const {
+  return this->search(pattern).size();
+}
+
+codon::index::hit codon::index::FMIndex::locate_row(std::size_t row) const {
+  std::size_t steps{0};
+  std::size_t sample_idx{0};
+  while (!this->is_sampled(row, sample_idx)) {
+    row = this->lf(row);
+    ++steps;
+  }
+  std::uint64_t text_pos = this->samples[sample_idx] + steps;
+
+  const std::uint64_t* starts_end = this->seq_starts + this->header->num_seqs;
+  std::size_t seq_id = static_cast<std::size_t>(
+      std::upper_bound(this->seq_starts, starts_end, text_pos) -
+      this->seq_starts - 1);
+  return codon::index::hit{seq_id, static_cast<std::size_t>(
+                                       text_pos - this->seq_starts[seq_id])};
+}
+
+std::vector<codon::index::hit> codon::index::FMIndex::locate(
+    const std::string& pattern) const {
+  return this->collect_hits(this->search(pattern));
+}
+
+std::vector<codon::index::hit> codon::index::FMIndex::locate(
+    const codon::Seq& pattern) const {
+  return this->collect_hits(this->search(pattern));
+}
+
+std::vector<codon::index::hit> codon::index::FMIndex::collect_hits(
+    codon::index::sa_interval interval) const {
+  std::vector<codon::index::hit> hits;
+  hits.reserve(interval.size());
+  for (std::size_t row{interval.first}; row < interval.last; ++row) {
+    hits.push_back(this->locate_row(row));
+  }
+  std::sort(hits.begin(), hits.end(),
+            [](const codon::index::hit& left, const codon::index::hit& right) {
+              return (left.seq_id < right.seq_id ||
+                      (left.seq_id == right.seq_id &&
+                       left.offset < right.offset));
+            });
+  return hits;
+}
+
+std::size_t codon::index::FMIndex::get_text_len() const {
+  return this->header->text_len;
+}
+
+std::size_t codon::index::FMIndex::get_num_seqs() const {
+  return this->header->num_seqs;
+}
+
+std::size_t codon::index::FMIndex::get_seq_len(std::size_t seq_id) const {
+  if (seq_id >= this->header->num_seqs)
+    throw std::out_of_range("FMIndex::get_seq_len() received invalid seq_id.");
+  // minus one for the separator/sentinel that follows every sequence
+  return this->seq_starts[seq_id + 1] - this->seq_starts[seq_id] - 1;
+}
+
+std::size_t codon::index::FMIndex::get_memory_usage() const {
+  return this->image_len;
+}
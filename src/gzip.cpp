@@ -0,0 +1,465 @@
+#include "gzip.h"
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+#if CODON_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+constexpr unsigned char GZIP_ID1 = 0x1f;
+constexpr unsigned char GZIP_ID2 = 0x8b;
+constexpr unsigned char CM_DEFLATE = 8;
+constexpr unsigned char FLG_EXTRA = 4;
+// gzip member header up to XLEN, BGZF header with its extra field
+constexpr std::size_t GZIP_HEADER = 12;
+constexpr std::size_t BGZF_HEADER = 18;
+// CRC32 and ISIZE behind the deflate data
+constexpr std::size_t GZIP_TRAILER = 8;
+constexpr std::size_t MAX_BLOCK = std::size_t{1} << 16;
+
+const char* name_of(codon::io::compression format) {
+  switch (format) {
+    case codon::io::compression::gzip:
+      return "gzip";
+    case codon::io::compression::bgzf:
+      return "BGZF";
+    default:
+      return "uncompressed";
+  }
+}
+
+// gzip stores its integers little-endian
+std::size_t read_u16(const unsigned char* bytes) {
+  return static_cast<std::size_t>(bytes[0]) |
+         static_cast<std::size_t>(bytes[1]) << 8;
+}
+
+// total size of a BGZF block from its extra field, 0 without a 'BC' entry
+std::size_t bgzf_size(const unsigned char* extra, std::size_t length) {
+  std::size_t pos{0};
+  while (pos + 4 <= length) {
+    std::size_t field_len{read_u16(extra + pos + 2)};
+    if (extra[pos] == 'B' && extra[pos + 1] == 'C' && field_len == 2 &&
+        pos + 6 <= length) {
+      return read_u16(extra + pos + 4) + 1;
+    }
+    pos += 4 + field_len;
+  }
+  return 0;
+}
+
+[[noreturn]] void corrupt(std::size_t offset, const std::string& message) {
+  throw std::runtime_error("Corrupt BGZF block at byte " +
+                           std::to_string(offset) + ": " + message);
+}
+
+#if CODON_ZLIB
+
+std::uint32_t read_u32(const unsigned char* bytes) {
+  return static_cast<std::uint32_t>(read_u16(bytes)) |
+         static_cast<std::uint32_t>(read_u16(bytes + 2)) << 16;
+}
+
+// raw deflate state without gzip framing, BGZF headers are parsed by hand
+struct raw_inflater {
+  z_stream stream{};
+
+  raw_inflater() {
+    if (inflateInit2(&this->stream, -MAX_WBITS) != Z_OK)
+      throw std::bad_alloc();
+  }
+  ~raw_inflater() { inflateEnd(&this->stream); }
+};
+
+struct raw_deflater {
+  z_stream stream{};
+
+  explicit raw_deflater(int level) {
+    if (deflateInit2(&this->stream, level, Z_DEFLATED, -MAX_WBITS, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw std::invalid_argument("Expected a compression level from 0 to 9 "
+                                  "but received " +
+                                  std::to_string(level) + ".");
+    }
+  }
+  ~raw_deflater() { deflateEnd(&this->stream); }
+};
+
+// blocks are inflated on pool threads, each keeps one state for all of them
+void inflate_block(codon::io::detail::bgzf_block& block) {
+  thread_local raw_inflater inflater;
+  const unsigned char* bytes{block.compressed.data()};
+  std::size_t size{block.compressed.size()};
+  std::size_t header{GZIP_HEADER + read_u16(bytes + 10)};
+  std::uint32_t crc{read_u32(bytes + size - GZIP_TRAILER)};
+  std::size_t length{read_u32(bytes + size - GZIP_TRAILER + 4)};
+  if (length > MAX_BLOCK) corrupt(block.offset, "ISIZE above 64 KiB.");
+  block.data.resize(length);
+  // the end-of-file marker and other empty blocks
+  if (length == 0) return;
+
+  z_stream& stream{inflater.stream};
+  inflateReset(&stream);
+  stream.next_in = const_cast<Bytef*>(bytes + header);
+  stream.avail_in = static_cast<uInt>(size - header - GZIP_TRAILER);
+  stream.next_out = reinterpret_cast<Bytef*>(block.data.data());
+  stream.avail_out = static_cast<uInt>(length);
+  if (inflate(&stream, Z_FINISH) != Z_STREAM_END || stream.avail_out != 0) {
+    corrupt(block.offset, "deflate data does not match ISIZE.");
+  }
+  if (crc32(0, reinterpret_cast<const Bytef*>(block.data.data()),
+            static_cast<uInt>(length)) != crc) {
+    corrupt(block.offset, "CRC32 mismatch.");
+  }
+}
+
+void append_u16(std::string& out, std::size_t value) {
+  out += static_cast<char>(value & 0xff);
+  out += static_cast<char>((value >> 8) & 0xff);
+}
+
+void append_u32(std::string& out, std::uint32_t value) {
+  append_u16(out, value & 0xffff);
+  append_u16(out, value >> 16);
+}
+
+#endif
+
+}  // namespace
+
+#if CODON_ZLIB
+
+struct codon::io::detail::inflater {
+  z_stream stream{};
+  std::vector<unsigned char> input;
+  // a member ended, concatenated gzip files start the next one
+  bool member_done{false};
+
+  explicit inflater(std::size_t input_bytes) : input(input_bytes) {
+    // 16 + MAX_WBITS expects the gzip header and trailer
+    if (inflateInit2(&this->stream, 16 + MAX_WBITS) != Z_OK)
+      throw std::bad_alloc();
+  }
+  ~inflater() { inflateEnd(&this->stream); }
+};
+
+#else
+
+struct codon::io::detail::inflater {};
+
+#endif
+
+codon::io::compression codon::io::detect_compression(
+    const unsigned char* head, std::size_t length) {
+  if (length < 2 || head[0] != GZIP_ID1 || head[1] != GZIP_ID2)
+    return codon::io::compression::none;
+  if (length < GZIP_HEADER || head[2] != CM_DEFLATE || !(head[3] & FLG_EXTRA))
+    return codon::io::compression::gzip;
+  std::size_t extra{std::min(read_u16(head + 10), length - GZIP_HEADER)};
+  return bgzf_size(head + GZIP_HEADER, extra)
+             ? codon::io::compression::bgzf
+             : codon::io::compression::gzip;
+}
+
+std::string codon::io::bgzf_compress(std::string_view data, int level) {
+#if CODON_ZLIB
+  raw_deflater deflater(level);
+  z_stream& stream{deflater.stream};
+  std::vector<unsigned char> deflated(MAX_BLOCK - BGZF_HEADER - GZIP_TRAILER);
+  std::string out;
+  out.reserve(data.length() / 3 + 64);
+
+  // the last, empty, block marks the end of the file
+  std::size_t pos{0};
+  bool is_last{false};
+  while (!is_last) {
+    std::string_view chunk{data.substr(pos, BGZF_BLOCK_DATA)};
+    pos += chunk.length();
+    is_last = chunk.empty();
+
+    deflateReset(&stream);
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(chunk.data()));
+    stream.avail_in = static_cast<uInt>(chunk.length());
+    stream.next_out = deflated.data();
+    stream.avail_out = static_cast<uInt>(deflated.size());
+    // stored blocks fit even for incompressible data
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+      throw std::runtime_error("Could not deflate a BGZF block.");
+    }
+    std::size_t deflated_len{deflated.size() - stream.avail_out};
+
+    const char header[] = {'\x1f', '\x8b', '\x08', '\x04', 0, 0, 0, 0, 0,
+                           '\xff', 6,      0,      'B',    'C', 2, 0};
+    out.append(header, sizeof(header));
+    append_u16(out, BGZF_HEADER + deflated_len + GZIP_TRAILER - 1);
+    out.append(reinterpret_cast<const char*>(deflated.data()), deflated_len);
+    append_u32(out, static_cast<std::uint32_t>(crc32(
+                        0, reinterpret_cast<const Bytef*>(chunk.data()),
+                        static_cast<uInt>(chunk.length()))));
+    append_u32(out, static_cast<std::uint32_t>(chunk.length()));
+  }
+  return out;
+#else
+  (void)data;
+  (void)level;
+  throw std::runtime_error("bgzf_compress needs codon built with zlib.");
+#endif
+}
+
+codon::io::DecompressStreambuf::DecompressStreambuf(std::istream& compressed,
+                                                   unsigned threads)
+    : in{compressed} {
+  // the fixed header and, for gzip with an extra field, the field itself
+  this->head.resize(GZIP_HEADER);
+  this->in.read(reinterpret_cast<char*>(this->head.data()), GZIP_HEADER);
+  this->head.resize(static_cast<std::size_t>(this->in.gcount()));
+  if (this->head.size() == GZIP_HEADER && this->head[0] == GZIP_ID1 &&
+      this->head[1] == GZIP_ID2 && (this->head[3] & FLG_EXTRA)) {
+    std::size_t extra{read_u16(this->head.data() + 10)};
+    this->head.resize(GZIP_HEADER + extra);
+    this->in.read(reinterpret_cast<char*>(this->head.data()) + GZIP_HEADER,
+                  static_cast<std::streamsize>(extra));
+    this->head.resize(GZIP_HEADER +
+                      static_cast<std::size_t>(this->in.gcount()));
+  }
+  this->format = codon::io::detect_compression(this->head.data(),
+                                               this->head.size());
+
+  if (this->format != codon::io::compression::none && !has_zlib) {
+    throw std::runtime_error(std::string("Input is ") +
+                             name_of(this->format) +
+                             " compressed but codon was built without zlib.");
+  }
+  if (this->format != codon::io::compression::bgzf) {
+    this->out.resize(OUT_BYTES);
+#if CODON_ZLIB
+    if (this->format == codon::io::compression::gzip) {
+      this->gzip = std::make_unique<codon::io::detail::inflater>(IN_BYTES);
+    }
+#endif
+    return;
+  }
+
+  /* threads == 1 inflates block by block in underflow(). So does a buffer
+   * on the shared pool opened inside one of its tasks: the background
+   * thread's run() would wait for the batch that task belongs to, while
+   * the task waits for the background thread.
+   */
+  this->current.blocks.resize(1);
+  if (threads == 1 ||
+      (threads == 0 && codon::parallel::ThreadPool::is_inside_task())) {
+    return;
+  }
+  if (threads == 0) {
+    this->pool = &codon::parallel::ThreadPool::shared();
+  } else {
+    this->owned_pool = std::make_unique<codon::parallel::ThreadPool>(threads);
+    this->pool = this->owned_pool.get();
+  }
+  this->batch_blocks = this->pool->size() * BLOCKS_PER_THREAD;
+  this->inflating = std::thread([this] { this->inflate_blocks(); });
+  PLOGD << "Inflating BGZF on " << this->pool->size() << " threads";
+}
+
+codon::io::DecompressStreambuf::~DecompressStreambuf() {
+  if (!this->inflating.joinable()) return;
+  // the background thread stops at its next push
+  this->ready.close();
+  this->inflating.join();
+}
+
+std::size_t codon::io::DecompressStreambuf::read_input(unsigned char* buffer,
+                                                       std::size_t count) {
+  std::size_t taken{std::min(count, this->head.size() - this->head_pos)};
+  std::memcpy(buffer, this->head.data() + this->head_pos, taken);
+  this->head_pos += taken;
+  if (taken < count) {
+    this->in.read(reinterpret_cast<char*>(buffer) + taken,
+                  static_cast<std::streamsize>(count - taken));
+    taken += static_cast<std::size_t>(this->in.gcount());
+  }
+  this->offset += taken;
+  return taken;
+}
+
+bool codon::io::DecompressStreambuf::read_block(
+    codon::io::detail::bgzf_block& block) {
+  block.offset = this->offset;
+  block.compressed.resize(GZIP_HEADER);
+  std::size_t count{this->read_input(block.compressed.data(), GZIP_HEADER)};
+  if (count == 0) return false;
+  if (count < GZIP_HEADER) corrupt(block.offset, "truncated header.");
+
+  const unsigned char* header{block.compressed.data()};
+  if (header[0] != GZIP_ID1 || header[1] != GZIP_ID2 ||
+      header[2] != CM_DEFLATE || !(header[3] & FLG_EXTRA)) {
+    corrupt(block.offset, "no BGZF header.");
+  }
+  std::size_t extra{read_u16(header + 10)};
+  block.compressed.resize(GZIP_HEADER + extra);
+  if (this->read_input(block.compressed.data() + GZIP_HEADER, extra) < extra)
+    corrupt(block.offset, "truncated header.");
+
+  std::size_t size{bgzf_size(block.compressed.data() + GZIP_HEADER, extra)};
+  if (size < GZIP_HEADER + extra + GZIP_TRAILER)
+    corrupt(block.offset, "no valid 'BC' block size.");
+  block.compressed.resize(size);
+  std::size_t rest{size - GZIP_HEADER - extra};
+  if (this->read_input(block.compressed.data() + GZIP_HEADER + extra, rest) <
+      rest) {
+    corrupt(block.offset, "truncated deflate data.");
+  }
+  return true;
+}
+
+void codon::io::DecompressStreambuf::inflate_blocks() {
+#if CODON_ZLIB
+  try {
+    while (!this->ready.is_closed()) {
+      codon::io::detail::block_batch batch;
+      if (!this->spare.try_pop(batch)) batch.blocks.resize(this->batch_blocks);
+      batch.count = 0;
+      while (batch.count < this->batch_blocks &&
+             this->read_block(batch.blocks[batch.count])) {
+        ++batch.count;
+      }
+      if (batch.count == 0) break;
+      this->pool->run(batch.count, [&batch](std::size_t idx) {
+        inflate_block(batch.blocks[idx]);
+      });
+      if (!this->ready.push(std::move(batch))) break;
+    }
+  } catch (...) {
+    // handed to the reader once it has consumed the batches before
+    this->error = std::current_exception();
+  }
+#endif
+  this->ready.close();
+}
+
+codon::io::DecompressStreambuf::int_type
+codon::io::DecompressStreambuf::underflow() {
+  if (this->gptr() < this->egptr())
+    return traits_type::to_int_type(*this->gptr());
+  switch (this->format) {
+    case codon::io::compression::gzip:
+      return this->next_gzip();
+    case codon::io::compression::bgzf:
+      return this->next_bgzf();
+    default:
+      return this->next_plain();
+  }
+}
+
+codon::io::DecompressStreambuf::int_type
+codon::io::DecompressStreambuf::next_plain() {
+  std::size_t count{this->read_input(
+      reinterpret_cast<unsigned char*>(this->out.data()), this->out.size())};
+  if (count == 0) return traits_type::eof();
+  this->setg(this->out.data(), this->out.data(), this->out.data() + count);
+  return traits_type::to_int_type(this->out[0]);
+}
+
+codon::io::DecompressStreambuf::int_type
+codon::io::DecompressStreambuf::next_gzip() {
+#if CODON_ZLIB
+  codon::io::detail::inflater& gzip{*this->gzip};
+  z_stream& stream{gzip.stream};
+  stream.next_out = reinterpret_cast<Bytef*>(this->out.data());
+  stream.avail_out = static_cast<uInt>(this->out.size());
+  while (stream.avail_out == this->out.size()) {
+    if (stream.avail_in == 0) {
+      std::size_t count{
+          this->read_input(gzip.input.data(), gzip.input.size())};
+      if (count == 0) {
+        if (!gzip.member_done) {
+          throw std::runtime_error("gzip input ends inside a member.");
+        }
+        return traits_type::eof();
+      }
+      stream.next_in = gzip.input.data();
+      stream.avail_in = static_cast<uInt>(count);
+    }
+    if (gzip.member_done) {
+      inflateReset(&stream);
+      gzip.member_done = false;
+    }
+    int status{inflate(&stream, Z_NO_FLUSH)};
+    if (status == Z_STREAM_END) {
+      gzip.member_done = true;
+    } else if (status != Z_OK && status != Z_BUF_ERROR) {
+      throw std::runtime_error(std::string("Corrupt gzip data: ") +
+                               (stream.msg ? stream.msg : "unknown error") +
+                               ".");
+    }
+  }
+  std::size_t count{this->out.size() - stream.avail_out};
+  this->setg(this->out.data(), this->out.data(), this->out.data() + count);
+  return traits_type::to_int_type(this->out[0]);
+#else
+  return traits_type::eof();
+#endif
+}
+
+codon::io::DecompressStreambuf::int_type
+codon::io::DecompressStreambuf::next_bgzf() {
+  while (true) {
+    if (this->next_block < this->current.count) {
+      std::vector<char>& data{this->current.blocks[this->next_block++].data};
+      if (data.empty()) continue;
+      this->setg(data.data(), data.data(), data.data() + data.size());
+      return traits_type::to_int_type(data[0]);
+    }
+    this->next_block = 0;
+#if CODON_ZLIB
+    if (!this->pool) {
+      this->current.count = 0;
+      if (!this->read_block(this->current.blocks[0])) {
+        return traits_type::eof();
+      }
+      inflate_block(this->current.blocks[0]);
+      this->current.count = 1;
+      continue;
+    }
+#endif
+    // the spent batch goes back for refilling, or is dropped if enough wait
+    if (this->current.count) this->spare.try_push(this->current);
+    this->current.count = 0;
+    if (!this->ready.pop(this->current)) {
+      if (this->error) std::rethrow_exception(this->error);
+      return traits_type::eof();
+    }
+  }
+}
+
+codon::io::InputFile::InputFile(const std::string& path, unsigned threads)
+    : std::istream(nullptr), file(path, std::ios::binary) {
+  if (!this->file) throw std::runtime_error("Could not open '" + path + "'.");
+  this->buffer =
+      std::make_unique<codon::io::DecompressStreambuf>(this->file, threads);
+  this->rdbuf(this->buffer.get());
+  // errors of the buffer would only set badbit otherwise
+  this->exceptions(std::ios::badbit);
+  PLOGD << "Reading " << name_of(this->get_format()) << " input from '"
+        << path << "'";
+}
@@ -0,0 +1,581 @@
+#include "kmer_filter.h"
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "kmer.h"
+#include "seq.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+constexpr char BLOOM_MAGIC[8] = {'C', 'O', 'D', 'O', 'N', 'B', 'L', 'M'};
+constexpr char CUCKOO_MAGIC[8] = {'C', 'O', 'D', 'O', 'N', 'C', 'K', 'O'};
+constexpr std::uint64_t FILTER_VERSION = 1;
+
+constexpr int BLOOM_BLOCK_BITS = 512;
+constexpr int BLOOM_BITS_PER_HASH = 9;  // log2(BLOOM_BLOCK_BITS)
+constexpr int BLOOM_MAX_HASHES = 16;
+// blocking concentrates bits, a little extra space keeps the target rate
+constexpr double BLOOM_BLOCKING_SLACK = 1.1;
+
+constexpr int CUCKOO_SLOTS = 32;
+constexpr int CUCKOO_MIN_FINGERPRINT_BITS = 4;
+constexpr int CUCKOO_MAX_FINGERPRINT_BITS = 16;  // cuckoo_bucket slot width
+constexpr double CUCKOO_TARGET_LOAD = 0.9;
+constexpr int CUCKOO_MAX_KICKS = 500;
+constexpr std::size_t CUCKOO_STRIPES = 256;
+
+namespace codon {
+namespace filter {
+namespace detail {
+
+struct cuckoo_locks {
+  std::shared_mutex relocation;
+  std::mutex stripes[CUCKOO_STRIPES];
+  std::atomic<std::size_t> num_items{0};
+};
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace codon
+
+namespace {
+
+struct filter_header {
+  char magic[8];
+  std::uint64_t version;
+  std::uint64_t k;
+  std::uint64_t canonical;
+  std::uint64_t parameter;  // hashes for Bloom, fingerprint bits for cuckoo
+  std::uint64_t num_units;  // blocks or buckets
+  std::uint64_t num_items;
+};
+
+inline void atomic_or(std::uint64_t* word, std::uint64_t bits) {
+#if defined(_MSC_VER)
+  _InterlockedOr64(reinterpret_cast<volatile long long*>(word),
+                   static_cast<long long>(bits));
+#else
+  __atomic_fetch_or(word, bits, __ATOMIC_RELAXED);
+#endif
+}
+
+// maps a 32-bit hash uniformly onto [0, range) without a division
+inline std::size_t fast_range(std::uint64_t hash32, std::size_t range) {
+  return static_cast<std::size_t>((hash32 * range) >> 32);
+}
+
+inline std::size_t next_pow2(std::size_t value) {
+  std::size_t result{1};
+  while (result < value) result <<= 1;
+  return result;
+}
+
+void write_filter(const std::string& path, const filter_header& header,
+                  const void* data, std::size_t bytes) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) throw std::runtime_error("Could not open '" + path + "'.");
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(data),
+             static_cast<std::streamsize>(bytes));
+  if (!file) throw std::runtime_error("Could not write '" + path + "'.");
+}
+
+filter_header read_filter_header(std::ifstream& file, const std::string& path,
+                                 const char (&magic)[8]) {
+  if (!file) throw std::runtime_error("Could not open '" + path + "'.");
+  filter_header header{};
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+      header.version != FILTER_VERSION) {
+    throw std::runtime_error("'" + path + "' is not a matching filter file.");
+  }
+  codon::kmer::verify_k(static_cast<int>(header.k));
+  return header;
+}
+
+// the rest of the file has to hold at least num_units units of unit_bytes
+void verify_payload(std::ifstream& file, const std::string& path,
+                    std::uint64_t num_units, std::size_t unit_bytes) {
+  std::streamoff start = file.tellg();
+  file.seekg(0, std::ios::end);
+  std::streamoff remaining = file.tellg() - start;
+  file.seekg(start);
+  if (!file || num_units == 0 ||
+      num_units > static_cast<std::uint64_t>(remaining) / unit_bytes) {
+    throw std::runtime_error("'" + path + "' is truncated.");
+  }
+}
+
+/* Shared read classification: stops as soon as the outcome is certain,
+ * either because enough k-mers hit or because too few are left to do so.
+ */
+template <typename Filter>
+bool read_matches(const Filter& filter, const codon::Seq& read,
+                  double min_fraction) {
+  std::size_t len{read.get_seq_trulen("bp")};
+  int k = filter.get_k();
+  if (len < static_cast<std::size_t>(k)) return false;
+
+  std::size_t total = len - k + 1;
+  std::size_t needed = static_cast<std::size_t>(
+      std::ceil(std::max(0.0, min_fraction) * static_cast<double>(total)));
+  if (needed == 0) return true;
+
+  std::size_t hits{0};
+  std::size_t seen{0};
+  bool decided{false};
+  codon::kmer::for_each_kmer(
+      read, k, filter.is_canonical(), [&](std::uint64_t kmer) {
+        ++seen;
+        if (filter.contains(kmer)) ++hits;
+        if (hits >= needed) {
+          decided = true;
+          return false;
+        }
+        return hits + (total - seen) >= needed;
+      });
+  return decided;
+}
+
+template <typename Filter>
+std::size_t read_hits(const Filter& filter, const codon::Seq& read) {
+  std::size_t hits{0};
+  codon::kmer::for_each_kmer(read, filter.get_k(), filter.is_canonical(),
+                             [&](std::uint64_t kmer) {
+                               if (filter.contains(kmer)) ++hits;
+                             });
+  return hits;
+}
+
+}  // namespace
+
+// -- KmerBloom --
+
+codon::filter::KmerBloom::KmerBloom(std::size_t expected_kmers, double fpr,
+                                    int k, bool use_canonical)
+    : k{k}, use_canonical{use_canonical} {
+  codon::kmer::verify_k(k);
+  if (fpr <= 0.0 || fpr >= 1.0)
+    throw std::invalid_argument("KmerBloom requires 0 < fpr < 1.");
+
+  const double ln2 = std::log(2.0);
+  double bits_per_kmer = -std::log(fpr) / (ln2 * ln2) * BLOOM_BLOCKING_SLACK;
+  double total_bits =
+      std::max(1.0, static_cast<double>(expected_kmers) * bits_per_kmer);
+  std::size_t num_blocks =
+      static_cast<std::size_t>(std::ceil(total_bits / BLOOM_BLOCK_BITS));
+
+  this->num_hashes = std::clamp(
+      static_cast<int>(std::lround(bits_per_kmer / BLOOM_BLOCKING_SLACK * ln2)),
+      1, BLOOM_MAX_HASHES);
+  this->blocks.assign(std::max<std::size_t>(num_blocks, 1),
+                      codon::filter::detail::bloom_block{});
+
+  PLOGD << "KmerBloom with " << this->blocks.size() << " blocks and "
+        << this->num_hashes << " hashes for " << expected_kmers
+        << " k-mers (fpr = " << fpr << ")";
+}
+
+void codon::filter::KmerBloom::build_mask(std::uint64_t hash,
+                                          std::size_t& block,
+                                          std::uint64_t (&mask)[8]) const {
+  block = fast_range(hash >> 32, this->blocks.size());
+  std::fill(mask, mask + 8, 0);
+
+  std::uint64_t bits = codon::kmer::hash(hash);
+  int used{0};
+  for (int i{0}; i < this->num_hashes; ++i) {
+    if (used + BLOOM_BITS_PER_HASH > 64) {
+      bits = codon::kmer::hash(bits);
+      used = 0;
+    }
+    unsigned bit = static_cast<unsigned>(bits >> used) & (BLOOM_BLOCK_BITS - 1);
+    used += BLOOM_BITS_PER_HASH;
+    mask[bit / 64] |= 1ULL << (bit % 64);
+  }
+}
+
+void codon::filter::KmerBloom::insert(std::uint64_t kmer) {
+  std::size_t block;
+  std::uint64_t mask[8];
+  this->build_mask(codon::kmer::hash(kmer), block, mask);
+  for (int word{0}; word < 8; ++word)
+    this->blocks[block].words[word] |= mask[word];
+}
+
+void codon::filter::KmerBloom::insert_concurrent(std::uint64_t kmer) {
+  std::size_t block;
+  std::uint64_t mask[8];
+  this->build_mask(codon::kmer::hash(kmer), block, mask);
+  for (int word{0}; word < 8; ++word) {
+    if (mask[word]) atomic_or(&this->blocks[block].words[word], mask[word]);
+  }
+}
+
+bool codon::filter::KmerBloom::contains(std::uint64_t kmer) const {
+  std::size_t block;
+  alignas(64) std::uint64_t mask[8];
+  this->build_mask(codon::kmer::hash(kmer), block, mask);
+  const std::uint64_t* words = this->blocks[block].words;
+
+#if defined(__AVX2__)
+  __m256i block_low =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(words));
+  __m256i block_high =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(words + 4));
+  __m256i mask_low = _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+  __m256i mask_high =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(mask + 4));
+  // testc: (~block & mask) == 0 -> every bit of the mask is set
+  return _mm256_testc_si256(block_low, mask_low) &&
+         _mm256_testc_si256(block_high, mask_high);
+#else
+  std::uint64_t missing{0};
+  for (int word{0}; word < 8; ++word) missing |= mask[word] & ~words[word];
+  return missing == 0;
+#endif
+}
+
+void codon::filter::KmerBloom::insert_seq(const codon::Seq& seq) {
+  codon::kmer::for_each_kmer(
+      seq, this->k, this->use_canonical,
+      [this](std::uint64_t kmer) { this->insert(kmer); });
+}
+
+void codon::filter::KmerBloom::insert_seq_concurrent(const codon::Seq& seq) {
+  codon::kmer::for_each_kmer(
+      seq, this->k, this->use_canonical,
+      [this](std::uint64_t kmer) { this->insert_concurrent(kmer); });
+}
+
+std::size_t codon::filter::KmerBloom::count_hits(const codon::Seq& read) const {
+  return read_hits(*this, read);
+}
+
+bool codon::filter::KmerBloom::matches(const codon::Seq& read,
+                                       double min_fraction) const {
+  return read_matches(*this, read, min_fraction);
+}
+
+std::size_t codon::filter::KmerBloom::get_memory_usage() const {
+  return this->blocks.size() * sizeof(codon::filter::detail::bloom_block);
+}
+
+void codon::filter::KmerBloom::save(const std::string& path) const {
+  filter_header header{};
+  std::memcpy(header.magic, BLOOM_MAGIC, sizeof(BLOOM_MAGIC));
+  header.version = FILTER_VERSION;
+  header.k = this->k;
+  header.canonical = this->use_canonical;
+  header.parameter = this->num_hashes;
+  header.num_units = this->blocks.size();
+  write_filter(path, header, this->blocks.data(), this->get_memory_usage());
+}
+
+codon::filter::KmerBloom codon::filter::KmerBloom::load(
+    const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  filter_header header{read_filter_header(file, path, BLOOM_MAGIC)};
+
+  if (header.parameter < 1 || header.parameter > BLOOM_MAX_HASHES)
+    throw std::runtime_error("'" + path + "' has an invalid hash count.");
+  verify_payload(file, path, header.num_units,
+                 sizeof(codon::filter::detail::bloom_block));
+
+  KmerBloom bloom;
+  bloom.k = static_cast<int>(header.k);
+  bloom.use_canonical = header.canonical != 0;
+  bloom.num_hashes = static_cast<int>(header.parameter);
+  bloom.blocks.resize(header.num_units);
+  file.read(reinterpret_cast<char*>(bloom.blocks.data()),
+            static_cast<std::streamsize>(bloom.get_memory_usage()));
+  if (!file || bloom.blocks.empty())
+    throw std::runtime_error("'" + path + "' is truncated.");
+  return bloom;
+}
+
+// -- KmerCuckoo --
+
+codon::filter::KmerCuckoo::KmerCuckoo()
+    : locks{std::make_unique<codon::filter::detail::cuckoo_locks>()} {}
+
+codon::filter::KmerCuckoo::KmerCuckoo(std::size_t expected_kmers, double fpr,
+                                      int k, bool use_canonical)
+    : KmerCuckoo() {
+  codon::kmer::verify_k(k);
+  if (fpr <= 0.0 || fpr >= 1.0)
+    throw std::invalid_argument("KmerCuckoo requires 0 < fpr < 1.");
+  this->k = k;
+  this->use_canonical = use_canonical;
+
+  // a query compares against 2 * CUCKOO_SLOTS fingerprints
+  int needed_bits =
+      static_cast<int>(std::ceil(std::log2(2.0 * CUCKOO_SLOTS / fpr)));
+  if (needed_bits > CUCKOO_MAX_FINGERPRINT_BITS) {
+    throw std::invalid_argument(
+        "KmerCuckoo cannot reach fpr = " + std::to_string(fpr) +
+        " with 16-bit fingerprints, the lowest rate is about " +
+        std::to_string(2.0 * CUCKOO_SLOTS /
+                       std::ldexp(1.0, CUCKOO_MAX_FINGERPRINT_BITS)) +
+        ".");
+  }
+  this->fingerprint_bits =
+      std::max(needed_bits, CUCKOO_MIN_FINGERPRINT_BITS);
+
+  std::size_t num_buckets = next_pow2(static_cast<std::size_t>(
+      std::ceil(static_cast<double>(std::max<std::size_t>(expected_kmers, 1)) /
+                (CUCKOO_SLOTS * CUCKOO_TARGET_LOAD))));
+  this->buckets.assign(num_buckets, codon::filter::detail::cuckoo_bucket{});
+  this->bucket_mask = num_buckets - 1;
+
+  PLOGD << "KmerCuckoo with " << num_buckets << " buckets and "
+        << this->fingerprint_bits << "-bit fingerprints for " << expected_kmers
+        << " k-mers (fpr = " << fpr << ")";
+}
+
+codon::filter::KmerCuckoo::KmerCuckoo(KmerCuckoo&&) noexcept = default;
+codon::filter::KmerCuckoo& codon::filter::KmerCuckoo::operator=(
+    KmerCuckoo&&) noexcept = default;
+codon::filter::KmerCuckoo::~KmerCuckoo() = default;
+
+void codon::filter::KmerCuckoo::locate(std::uint64_t kmer,
+                                       std::uint16_t& fingerprint,
+                                       std::size_t& first,
+                                       std::size_t& second) const {
+  std::uint64_t hash = codon::kmer::hash(kmer);
+  fingerprint = static_cast<std::uint16_t>(
+      (hash >> 32) & ((1ULL << this->fingerprint_bits) - 1));
+  if (fingerprint == 0) fingerprint = 1;  // 0 marks empty slots
+  first = static_cast<std::size_t>(hash) & this->bucket_mask;
+  second = (first ^ codon::kmer::hash(fingerprint)) & this->bucket_mask;
+}
+
+bool codon::filter::KmerCuckoo::place(std::size_t bucket,
+                                      std::uint16_t fingerprint) {
+  std::uint16_t* slots = this->buckets[bucket].slots;
+
+  for (int slot{0}; slot < CUCKOO_SLOTS; ++slot) {
+    if (slots[slot] == 0) {
+      slots[slot] = fingerprint;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool codon::filter::KmerCuckoo::insert(std::uint64_t kmer) {
+  std::uint16_t fingerprint;
+  std::size_t first, second;
+  this->locate(kmer, fingerprint, first, second);
+  if (this->contains(kmer)) return true;  // already a member
+  return this->store(fingerprint, first, second);
+}
+
+bool codon::filter::KmerCuckoo::insert_counted(std::uint64_t kmer) {
+  std::uint16_t fingerprint;
+  std::size_t first, second;
+  this->locate(kmer, fingerprint, first, second);
+  return this->store(fingerprint, first, second);
+}
+
+bool codon::filter::KmerCuckoo::store(std::uint16_t fingerprint,
+                                      std::size_t first, std::size_t second) {
+  if (this->place(first, fingerprint) || this->place(second, fingerprint)) {
+    this->locks->num_items.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /* Both buckets are full: evict a random fingerprint and move it to its
+   * alternative bucket until a free slot turns up. On failure the chain is
+   * walked back so that the filter is unchanged.
+   */
+  std::size_t bucket = (this->kick_state & 1) ? first : second;
+  std::array<std::pair<std::size_t, int>, CUCKOO_MAX_KICKS> chain;
+  int kicks{0};
+  for (; kicks < CUCKOO_MAX_KICKS; ++kicks) {
+    this->kick_state ^= this->kick_state << 13;
+    this->kick_state ^= this->kick_state >> 7;
+    this->kick_state ^= this->kick_state << 17;
+    int slot = static_cast<int>(this->kick_state % CUCKOO_SLOTS);
+
+    std::swap(fingerprint, this->buckets[bucket].slots[slot]);
+    chain[kicks] = {bucket, slot};
+    bucket = (bucket ^ codon::kmer::hash(fingerprint)) & this->bucket_mask;
+    if (this->place(bucket, fingerprint)) {
+      this->locks->num_items.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  while (kicks-- > 0) {
+    std::swap(fingerprint,
+              this->buckets[chain[kicks].first].slots[chain[kicks].second]);
+  }
+
+  PLOGD << "KmerCuckoo is full, could not insert k-mer";
+  return false;
+}
+
+bool codon::filter::KmerCuckoo::insert_concurrent(std::uint64_t kmer) {
+  std::uint16_t fingerprint;
+  std::size_t first, second;
+  this->locate(kmer, fingerprint, first, second);
+  {
+    std::shared_lock<std::shared_mutex> shared(this->locks->relocation);
+    std::size_t stripe_low = std::min(first, second) % CUCKOO_STRIPES;
+    std::size_t stripe_high = std::max(first, second) % CUCKOO_STRIPES;
+    if (stripe_low > stripe_high) std::swap(stripe_low, stripe_high);
+    std::unique_lock<std::mutex> lock_low(this->locks->stripes[stripe_low]);
+    std::unique_lock<std::mutex> lock_high;
+    if (stripe_high != stripe_low)
+      lock_high = std::unique_lock<std::mutex>(
+          this->locks->stripes[stripe_high]);
+
+    // both candidate buckets are locked, so no other thread adds it now
+    if (this->contains(kmer)) return true;
+    if (this->place(first, fingerprint) || this->place(second, fingerprint)) {
+      this->locks->num_items.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  std::unique_lock<std::shared_mutex> exclusive(this->locks->relocation);
+  return this->insert(kmer);
+}
+
+bool codon::filter::KmerCuckoo::contains(std::uint64_t kmer) const {
+  std::uint16_t fingerprint;
+  std::size_t first, second;
+  this->locate(kmer, fingerprint, first, second);
+
+  const std::uint16_t* slots_first = this->buckets[first].slots;
+  const std::uint16_t* slots_second = this->buckets[second].slots;
+  // branch-free so the compiler can compare all 32 slots in vector registers
+  bool found{false};
+  for (int slot{0}; slot < CUCKOO_SLOTS; ++slot)
+    found |= (slots_first[slot] == fingerprint);
+  if (found) return true;
+  for (int slot{0}; slot < CUCKOO_SLOTS; ++slot)
+    found |= (slots_second[slot] == fingerprint);
+  return found;
+}
+
+bool codon::filter::KmerCuckoo::erase(std::uint64_t kmer) {
+  std::uint16_t fingerprint;
+  std::size_t first, second;
+  this->locate(kmer, fingerprint, first, second);
+  for (std::size_t bucket : {first, second}) {
+    std::uint16_t* slots = this->buckets[bucket].slots;
+    for (int slot{0}; slot < CUCKOO_SLOTS; ++slot) {
+      if (slots[slot] == fingerprint) {
+        slots[slot] = 0;
+        this->locks->num_items.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+std::size_t codon::filter::KmerCuckoo::insert_seq(const codon::Seq& seq) {
+  std::size_t failed{0};
+  codon::kmer::for_each_kmer(seq, this->k, this->use_canonical,
+                             [&](std::uint64_t kmer) {
+                               if (!this->insert(kmer)) ++failed;
+                             });
+  return failed;
+}
+
+std::size_t codon::filter::KmerCuckoo::insert_seq_concurrent(
+    const codon::Seq& seq) {
+  std::size_t failed{0};
+  codon::kmer::for_each_kmer(seq, this->k, this->use_canonical,
+                             [&](std::uint64_t kmer) {
+                               if (!this->insert_concurrent(kmer)) ++failed;
+                             });
+  return failed;
+}
+
+std::size_t codon::filter::KmerCuckoo::count_hits(
+    const codon::Seq& read) const {
+  return read_hits(*this, read);
+}
+
+bool codon::filter::KmerCuckoo::matches(const codon::Seq& read,
+                                        double min_fraction) const {
+  return read_matches(*this, read, min_fraction);
+}
+
+std::size_t codon::filter::KmerCuckoo::get_size() const {
+  return this->locks->num_items.load(std::memory_order_relaxed);
+}
+
+double codon::filter::KmerCuckoo::get_load_factor() const {
+  return static_cast<double>(this->get_size()) /
+         static_cast<double>(this->buckets.size() * CUCKOO_SLOTS);
+}
+
+std::size_t codon::filter::KmerCuckoo::get_memory_usage() const {
+  return this->buckets.size() * sizeof(codon::filter::detail::cuckoo_bucket);
+}
+
+void codon::filter::KmerCuckoo::save(const std::string& path) const {
+  filter_header header{};
+  std::memcpy(header.magic, CUCKOO_MAGIC, sizeof(CUCKOO_MAGIC));
+  header.version = FILTER_VERSION;
+  header.k = this->k;
+  header.canonical = this->use_canonical;
+  header.parameter = this->fingerprint_bits;
+  header.num_units = this->buckets.size();
+  header.num_items = this->get_size();
+  write_filter(path, header, this->buckets.data(), this->get_memory_usage());
+}
+
+codon::filter::KmerCuckoo codon::filter::KmerCuckoo::load(
+    const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  filter_header header{read_filter_header(file, path, CUCKOO_MAGIC)};
+  if (header.num_units == 0 || (header.num_units & (header.num_units - 1)))
+    throw std::runtime_error("'" + path + "' has an invalid bucket count.");
+  if (header.parameter < CUCKOO_MIN_FINGERPRINT_BITS ||
+      header.parameter > CUCKOO_MAX_FINGERPRINT_BITS) {
+    throw std::runtime_error("'" + path +
+                             "' has an invalid fingerprint width.");
+  }
+  verify_payload(file, path, header.num_units,
+                 sizeof(codon::filter::detail::cuckoo_bucket));
+  if (header.num_items > header.num_units * CUCKOO_SLOTS)
+    throw std::runtime_error("'" + path + "' has an invalid item count.");
+
+  KmerCuckoo cuckoo;
+  cuckoo.k = static_cast<int>(header.k);
+  cuckoo.use_canonical = header.canonical != 0;
+  cuckoo.fingerprint_bits = static_cast<int>(header.parameter);
+  cuckoo.buckets.resize(header.num_units);
+  cuckoo.bucket_mask = header.num_units - 1;
+  cuckoo.locks->num_items.store(header.num_items);
+  file.read(reinterpret_cast<char*>(cuckoo.buckets.data()),
+            static_cast<std::streamsize>(cuckoo.get_memory_usage()));
+  if (!file) throw std::runtime_error("'" + path + "' is truncated.");
+  return cuckoo;
+}
@@ -0,0 +1,266 @@
+#include "liftover.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+template <typename Fn>
+void codon::LiftoverMap::for_each_segment(Fn&& fn) const {
+  // in-order walk with an explicit stack, fn(segment, edited start)
+  std::vector<std::size_t> stack;
+  std::size_t idx{this->root};
+  std::size_t new_start{0};
+  while (idx != NIL || !stack.empty()) {
+    while (idx != NIL) {
+      stack.push_back(idx);
+      idx = this->nodes[idx].left;
+    }
+    idx = stack.back();
+    stack.pop_back();
+    fn(this->nodes[idx], new_start);
+    new_start += this->nodes[idx].length;
+    idx = this->nodes[idx].right;
+  }
+}
+
+codon::LiftoverMap::LiftoverMap() : root{NIL} {}
+
+codon::LiftoverMap::LiftoverMap(std::size_t len) : root{NIL}, orig_len{len} {
+  if (len) this->root = this->make_node(0, len, this->next_priority());
+}
+
+void codon::LiftoverMap::record_insert(std::size_t offset,
+                                       std::size_t length) {
+  if (offset > this->get_new_len()) {
+    throw std::invalid_argument(
+        "LiftoverMap::record_insert received offset " +
+        std::to_string(offset) + " behind the end of the sequence.");
+  }
+  if (!length) return;
+  std::size_t left{NIL};
+  std::size_t right{NIL};
+  this->split(this->root, offset, left, right);
+  std::size_t inserted =
+      this->make_node(NO_ORIGIN, length, this->next_priority());
+  this->root = this->merge(this->merge(left, inserted), right);
+}
+
+void codon::LiftoverMap::record_erase(std::size_t offset,
+                                      std::size_t length) {
+  if (offset + length > this->get_new_len()) {
+    throw std::invalid_argument(
+        "LiftoverMap::record_erase received a range behind the end of the "
+        "sequence.");
+  }
+  if (!length) return;
+  std::size_t left{NIL};
+  std::size_t rest{NIL};
+  std::size_t erased{NIL};
+  std::size_t right{NIL};
+  this->split(this->root, offset, left, rest);
+  this->split(rest, length, erased, right);
+  this->release(erased);
+  this->root = this->merge(left, right);
+}
+
+std::optional<std::size_t> codon::LiftoverMap::to_edited(
+    std::size_t orig_offset) const {
+  /* original runs appear in ascending order, so whenever the left subtree
+   * reaches past orig_offset the run holding it can only be there
+   */
+  std::size_t idx{this->root};
+  std::size_t before{0};
+  while (idx != NIL) {
+    const node& curr = this->nodes[idx];
+    if (curr.left != NIL &&
+        this->nodes[curr.left].subtree_orig_end > orig_offset) {
+      idx = curr.left;
+      continue;
+    }
+    if (curr.left != NIL) before += this->nodes[curr.left].subtree_len;
+    if (curr.orig_start != NO_ORIGIN) {
+      if (orig_offset < curr.orig_start) return std::nullopt;
+      if (orig_offset < curr.orig_start + curr.length)
+        return before + (orig_offset - curr.orig_start);
+    }
+    before += curr.length;
+    idx = curr.right;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::size_t> codon::LiftoverMap::to_original(
+    std::size_t new_offset) const {
+  std::size_t idx{this->root};
+  while (idx != NIL) {
+    const node& curr = this->nodes[idx];
+    std::size_t left_len =
+        (curr.left != NIL) ? this->nodes[curr.left].subtree_len : 0;
+    if (new_offset < left_len) {
+      idx = curr.left;
+    } else if (new_offset < left_len + curr.length) {
+      if (curr.orig_start == NO_ORIGIN) return std::nullopt;
+      return curr.orig_start + (new_offset - left_len);
+    } else {
+      new_offset -= left_len + curr.length;
+      idx = curr.right;
+    }
+  }
+  return std::nullopt;
+}
+
+std::vector<std::optional<std::size_t>> codon::LiftoverMap::to_edited(
+    const std::vector<std::size_t>& orig_offsets) const {
+  if (!std::is_sorted(orig_offsets.begin(), orig_offsets.end())) {
+    throw std::invalid_argument(
+        "Batch liftover expects offsets in ascending order.");
+  }
+  std::vector<std::optional<std::size_t>> lifted(orig_offsets.size());
+  std::size_t pos{0};
+  this->for_each_segment([&](const node& segment, std::size_t new_start) {
+    if (segment.orig_start == NO_ORIGIN) return;
+    std::size_t orig_end = segment.orig_start + segment.length;
+    for (; pos < orig_offsets.size() && orig_offsets[pos] < orig_end; ++pos) {
+      if (orig_offsets[pos] >= segment.orig_start)
+        lifted[pos] = new_start + (orig_offsets[pos] - segment.orig_start);
+    }
+  });
+  return lifted;
+}
+
+std::vector<std::optional<std::size_t>> codon::LiftoverMap::to_original(
+    const std::vector<std::size_t>& new_offsets) const {
+  if (!std::is_sorted(new_offsets.begin(), new_offsets.end())) {
+    throw std::invalid_argument(
+        "Batch liftover expects offsets in ascending order.");
+  }
+  std::vector<std::optional<std::size_t>> lifted(new_offsets.size());
+  std::size_t pos{0};
+  this->for_each_segment([&](const node& segment, std::size_t new_start) {
+    std::size_t new_end = new_start + segment.length;
+    for (; pos < new_offsets.size() && new_offsets[pos] < new_end; ++pos) {
+      if (segment.orig_start != NO_ORIGIN)
+        lifted[pos] = segment.orig_start + (new_offsets[pos] - new_start);
+    }
+  });
+  return lifted;
+}
+
+std::size_t codon::LiftoverMap::get_new_len() const {
+  return (this->root != NIL) ? this->nodes[this->root].subtree_len : 0;
+}
+
+std::size_t codon::LiftoverMap::get_num_segments() const {
+  return this->nodes.size() - this->free_nodes.size();
+}
+
+std::size_t codon::LiftoverMap::make_node(std::size_t orig_start,
+                                          std::size_t length,
+                                          std::uint32_t priority) {
+  node fresh{orig_start, length, 0, 0, priority, NIL, NIL};
+  std::size_t idx;
+  if (!this->free_nodes.empty()) {
+    idx = this->free_nodes.back();
+    this->free_nodes.pop_back();
+    this->nodes[idx] = fresh;
+  } else {
+    idx = this->nodes.size();
+    this->nodes.push_back(fresh);
+  }
+  this->update(idx);
+  return idx;
+}
+
+std::uint32_t codon::LiftoverMap::next_priority() {
+  // xorshift64, only used to keep the treap balanced
+  this->rng_state ^= this->rng_state << 13;
+  this->rng_state ^= this->rng_state >> 7;
+  this->rng_state ^= this->rng_state << 17;
+  return static_cast<std::uint32_t>(this->rng_state >> 32);
+}
+
+void codon::LiftoverMap::update(std::size_t idx) {
+  node& curr = this->nodes[idx];
+  curr.subtree_len = curr.length;
+  curr.subtree_orig_end =
+      (curr.orig_start != NO_ORIGIN) ? curr.orig_start + curr.length : 0;
+  for (std::size_t child : {curr.left, curr.right}) {
+    if (child == NIL) continue;
+    curr.subtree_len += this->nodes[child].subtree_len;
+    curr.subtree_orig_end =
+        std::max(curr.subtree_orig_end, this->nodes[child].subtree_orig_end);
+  }
+}
+
+std::size_t codon::LiftoverMap::merge(std::size_t left, std::size_t right) {
+  if (left == NIL) return right;
+  if (right == NIL) return left;
+  if (this->nodes[left].priority > this->nodes[right].priority) {
+    std::size_t merged = this->merge(this->nodes[left].right, right);
+    this->nodes[left].right = merged;
+    this->update(left);
+    return left;
+  }
+  std::size_t merged = this->merge(left, this->nodes[right].left);
+  this->nodes[right].left = merged;
+  this->update(right);
+  return right;
+}
+
+void codon::LiftoverMap::split(std::size_t idx, std::size_t pos,
+                               std::size_t& left, std::size_t& right) {
+  /* left receives the first pos bases in edited order, right the rest.
+   * A segment that straddles pos is cut in two; the second half takes over
+   * the priority so the heap order stays intact.
+   */
+  if (idx == NIL) {
+    left = right = NIL;
+    return;
+  }
+  std::size_t left_len = (this->nodes[idx].left != NIL)
+                             ? this->nodes[this->nodes[idx].left].subtree_len
+                             : 0;
+  std::size_t length = this->nodes[idx].length;
+  if (pos <= left_len) {
+    std::size_t rest{NIL};
+    this->split(this->nodes[idx].left, pos, left, rest);
+    this->nodes[idx].left = rest;
+    this->update(idx);
+    right = idx;
+  } else if (pos >= left_len + length) {
+    std::size_t rest{NIL};
+    this->split(this->nodes[idx].right, pos - left_len - length, rest, right);
+    this->nodes[idx].right = rest;
+    this->update(idx);
+    left = idx;
+  } else {
+    std::size_t cut = pos - left_len;
+    std::size_t orig_start = this->nodes[idx].orig_start;
+    std::size_t second = this->make_node(
+        (orig_start != NO_ORIGIN) ? orig_start + cut : NO_ORIGIN,
+        length - cut, this->nodes[idx].priority);
+    this->nodes[second].right = this->nodes[idx].right;
+    this->update(second);
+    this->nodes[idx].length = cut;
+    this->nodes[idx].right = NIL;
+    this->update(idx);
+    left = idx;
+    right = second;
+  }
+}
+
+void codon::LiftoverMap::release(std::size_t idx) {
+  std::vector<std::size_t> pending;
+  if (idx != NIL) pending.push_back(idx);
+  while (!pending.empty()) {
+    const node& curr = this->nodes[pending.back()];
+    this->free_nodes.push_back(pending.back());
+    pending.pop_back();
+    if (curr.left != NIL) pending.push_back(curr.left);
+    if (curr.right != NIL) pending.push_back(curr.right);
+  }
+}
@@ -0,0 +1,89 @@
+#include "mapped_file.h"
+
+#include <plog/Log.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CODON_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+codon::io::MappedFile::MappedFile(const std::string& path) {
+#ifdef CODON_HAS_MMAP
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("Could not open '" + path + "'.");
+
+  struct stat file_stat {};
+  if (::fstat(fd, &file_stat) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Could not stat '" + path + "'.");
+  }
+  this->length = static_cast<std::size_t>(file_stat.st_size);
+
+  if (this->length > 0) {
+    void* mapped =
+        ::mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("Could not mmap '" + path + "'.");
+    }
+    this->bytes = static_cast<const std::uint8_t*>(mapped);
+  }
+  // INFO: the mapping stays valid after closing the descriptor
+  ::close(fd);
+  PLOGD << "Mapped '" << path << "' (" << this->length << " bytes)";
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) throw std::runtime_error("Could not open '" + path + "'.");
+
+  this->fallback.resize(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(this->fallback.data()),
+            static_cast<std::streamsize>(this->fallback.size()));
+  this->bytes = this->fallback.data();
+  this->length = this->fallback.size();
+  PLOGD << "Read '" << path << "' into memory (" << this->length << " bytes)";
+#endif
+}
+
+codon::io::MappedFile::MappedFile(MappedFile&& other) noexcept
+    : bytes{other.bytes},
+      length{other.length},
+      fallback{std::move(other.fallback)} {
+  other.bytes = nullptr;
+  other.length = 0;
+}
+
+codon::io::MappedFile& codon::io::MappedFile::operator=(
+    MappedFile&& other) noexcept {
+  if (this != &other) {
+    this->release();
+    this->bytes = other.bytes;
+    this->length = other.length;
+    this->fallback = std::move(other.fallback);
+    other.bytes = nullptr;
+    other.length = 0;
+  }
+  return *this;
+}
+
+codon::io::MappedFile::~MappedFile() { this->release(); }
+
+void codon::io::MappedFile::release() {
+#ifdef CODON_HAS_MMAP
+  if (this->bytes != nullptr && this->fallback.empty())
+    ::munmap(const_cast<std::uint8_t*>(this->bytes), this->length);
+#endif
+  this->bytes = nullptr;
+  this->length = 0;
+  this->fallback.clear();
+}
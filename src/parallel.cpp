@@ -0,0 +1,310 @@
+#include "parallel.h"
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "seq.h"
+#include "translate.h"
+
+// chunks per thread, leaves room for stealing without tiny chunks
+constexpr std::size_t CHUNKS_PER_THREAD = 4;
+
+namespace {
+
+// set while a thread executes a task, nested batches then run inline
+thread_local bool inside_task{false};
+
+// G and C among the bases of a codon, 2 bits per base from the lowest up
+std::uint8_t gc_of(const codon::Codon& codon) {
+  int len = codon.get_bases_len();
+  int bits = codon.get_bases_int();
+  std::uint8_t count{0};
+  for (int idx{0}; idx < len; ++idx, bits >>= 2) {
+    int curr = bits & 3;
+    if (curr == codon::base::G || curr == codon::base::C) ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+codon::parallel::ThreadPool::ThreadPool(unsigned threads) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned idx{0}; idx < threads; ++idx) {
+    this->queues.push_back(std::make_unique<task_queue>());
+  }
+  this->workers.reserve(threads - 1);
+  for (unsigned idx{1}; idx < threads; ++idx) {
+    this->workers.emplace_back([this, idx] { this->worker_loop(idx); });
+  }
+  PLOGD << "Started thread pool with " << threads << " threads";
+}
+
+codon::parallel::ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->stopping = true;
+  }
+  this->wake.notify_all();
+  for (std::thread& worker : this->workers) worker.join();
+}
+
+codon::parallel::ThreadPool& codon::parallel::ThreadPool::shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+bool codon::parallel::ThreadPool::is_inside_task() { return inside_task; }
+
+void codon::parallel::ThreadPool::run(
+    std::size_t num_tasks, const std::function<void(std::size_t)>& fn) {
+  if (num_tasks == 0) return;
+  if (inside_task || this->size() == 1 || num_tasks == 1) {
+    for (std::size_t idx{0}; idx < num_tasks; ++idx) fn(idx);
+    return;
+  }
+  std::lock_guard<std::mutex> batch_lock(this->run_mutex);
+  {
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->batch_fn = &fn;
+    this->error = nullptr;
+    this->failed = false;
+    this->remaining = num_tasks;
+    for (std::size_t idx{0}; idx < num_tasks; ++idx) {
+      task_queue& queue{*this->queues[idx % this->queues.size()]};
+      std::lock_guard<std::mutex> queue_lock(queue.mutex);
+      queue.tasks.push_back(idx);
+    }
+    ++this->batch_id;
+  }
+  this->wake.notify_all();
+
+  this->drain(0);
+  std::unique_lock<std::mutex> lock(this->state_mutex);
+  this->done.wait(lock, [this] { return this->remaining == 0; });
+  this->batch_fn = nullptr;
+  if (this->error) std::rethrow_exception(this->error);
+}
+
+void codon::parallel::ThreadPool::worker_loop(std::size_t self) {
+  std::size_t seen{0};
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(this->state_mutex);
+      this->wake.wait(lock, [&] {
+        return this->stopping || this->batch_id != seen;
+      });
+      if (this->stopping) return;
+      seen = this->batch_id;
+    }
+    this->drain(self);
+  }
+}
+
+void codon::parallel::ThreadPool::drain(std::size_t self) {
+  std::size_t task{0};
+  inside_task = true;
+  while (this->take(self, task)) {
+    if (!this->failed) {
+      try {
+        (*this->batch_fn)(task);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(this->state_mutex);
+        if (!this->error) this->error = std::current_exception();
+        this->failed = true;
+      }
+    }
+    if (this->remaining.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lock(this->state_mutex);
+      this->done.notify_all();
+    }
+  }
+  inside_task = false;
+}
+
+bool codon::parallel::ThreadPool::take(std::size_t self, std::size_t& task) {
+  // own deque from the front, the others from the back
+  std::size_t count{this->queues.size()};
+  for (std::size_t step{0}; step < count; ++step) {
+    task_queue& queue{*this->queues[(self + step) % count]};
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) continue;
+    if (step == 0) {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+    } else {
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+    }
+    return true;
+  }
+  return false;
+}
+
+unsigned codon::parallel::detail::resolve_threads(unsigned threads) {
+  return (threads == 0) ? ThreadPool::shared().size() : threads;
+}
+
+std::vector<codon::parallel::detail::chunk>
+codon::parallel::detail::make_chunks(const std::vector<std::size_t>& costs,
+                                     unsigned threads) {
+  std::vector<chunk> chunks;
+  if (costs.empty()) return chunks;
+  std::size_t total{std::accumulate(costs.begin(), costs.end(),
+                                    std::size_t{0})};
+  std::size_t target{std::max<std::size_t>(
+      1, total / (std::max(1u, threads) * CHUNKS_PER_THREAD))};
+  chunk curr{0, 0, 0};
+  for (std::size_t idx{0}; idx < costs.size(); ++idx) {
+    if (curr.cost && curr.cost + costs[idx] > target) {
+      chunks.push_back(curr);
+      curr = chunk{idx, idx, 0};
+    }
+    curr.last = idx + 1;
+    curr.cost += costs[idx];
+  }
+  chunks.push_back(curr);
+  return chunks;
+}
+
+void codon::parallel::detail::run_chunks(
+    const std::vector<chunk>& chunks, unsigned threads,
+    const std::function<void(std::size_t)>& fn) {
+  if (threads == 1 || chunks.size() <= 1) {
+    // nested single-sequence work has to stay on this thread as well
+    bool outer{inside_task};
+    inside_task = true;
+    try {
+      for (std::size_t idx{0}; idx < chunks.size(); ++idx) fn(idx);
+    } catch (...) {
+      inside_task = outer;
+      throw;
+    }
+    inside_task = outer;
+    return;
+  }
+  if (threads == 0) {
+    run_chunks(chunks, ThreadPool::shared(), fn);
+    return;
+  }
+  ThreadPool pool(threads);
+  run_chunks(chunks, pool, fn);
+}
+
+void codon::parallel::detail::run_chunks(
+    const std::vector<chunk>& chunks, ThreadPool& pool,
+    const std::function<void(std::size_t)>& fn) {
+  // longest processing time first, dealt round-robin over the deques
+  std::vector<std::size_t> order(chunks.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t lhs, std::size_t rhs) {
+                     return chunks[lhs].cost > chunks[rhs].cost;
+                   });
+  pool.run(order.size(), [&](std::size_t idx) { fn(order[idx]); });
+}
+
+void codon::parallel::for_each_block(
+    std::size_t size, std::size_t grain,
+    const std::function<void(std::size_t, std::size_t)>& fn,
+    unsigned threads) {
+  std::size_t blocks{size / std::max<std::size_t>(1, grain)};
+  if (blocks <= 1 || inside_task) {
+    if (size) fn(0, size);
+    return;
+  }
+  blocks = std::min<std::size_t>(
+      blocks, detail::resolve_threads(threads) * CHUNKS_PER_THREAD);
+  std::vector<detail::chunk> chunks;
+  chunks.reserve(blocks);
+  for (std::size_t idx{0}; idx < blocks; ++idx) {
+    std::size_t first{size / blocks * idx + std::min(idx, size % blocks)};
+    std::size_t last{first + size / blocks + (idx < size % blocks)};
+    chunks.push_back({first, last, last - first});
+  }
+  detail::run_chunks(chunks, threads, [&](std::size_t idx) {
+    fn(chunks[idx].first, chunks[idx].last);
+  });
+}
+
+std::vector<codon::Seq> codon::parallel::parse(
+    const std::vector<std::string>& inputs, unsigned threads) {
+  std::vector<std::optional<codon::Seq>> parsed(inputs.size());
+  codon::parallel::for_each_seq(
+      inputs, [&](const std::string& input) {
+        parsed[&input - inputs.data()].emplace(input);
+      },
+      threads);
+  std::vector<codon::Seq> seqs;
+  seqs.reserve(inputs.size());
+  for (std::optional<codon::Seq>& curr : parsed) {
+    seqs.push_back(std::move(*curr));
+  }
+  return seqs;
+}
+
+std::vector<std::string> codon::parallel::translate(
+    const std::vector<codon::Seq>& seqs, unsigned threads) {
+  std::vector<std::string> proteins(seqs.size());
+  codon::parallel::for_each_seq(
+      seqs, [&](const codon::Seq& seq) {
+        proteins[&seq - seqs.data()] = codon::translate(seq);
+      },
+      threads);
+  return proteins;
+}
+
+std::unordered_map<std::uint64_t, std::uint64_t>
+codon::parallel::count_kmers(const std::vector<codon::Seq>& seqs, int k,
+                             bool use_canonical, unsigned threads) {
+  using counts = std::unordered_map<std::uint64_t, std::uint64_t>;
+  return codon::parallel::transform_reduce(
+      seqs, counts{},
+      [](counts lhs, counts rhs) {
+        if (lhs.size() < rhs.size()) std::swap(lhs, rhs);
+        for (const auto& [kmer, count] : rhs) lhs[kmer] += count;
+        return lhs;
+      },
+      [k, use_canonical](const codon::Seq& seq) {
+        counts local;
+        for (std::uint64_t kmer : seq.kmers(k, use_canonical)) ++local[kmer];
+        return local;
+      },
+      threads);
+}
+
+double codon::parallel::gc_content(const std::vector<codon::Seq>& seqs,
+                                   unsigned threads) {
+  using tally = std::pair<std::size_t, std::size_t>;
+  tally total{codon::parallel::transform_reduce(
+      seqs, tally{0, 0},
+      [](tally lhs, tally rhs) {
+        return tally{lhs.first + rhs.first, lhs.second + rhs.second};
+      },
+      [](const codon::Seq& seq) {
+        tally counts{0, 0};
+        for (const codon::Codon& curr : seq) {
+          counts.first += gc_of(curr);
+          counts.second += curr.get_bases_len();
+        }
+        return counts;
+      },
+      threads)};
+  return (total.second) ? static_cast<double>(total.first) / total.second
+                        : 0.0;
+}
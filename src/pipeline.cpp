@@ -0,0 +1,108 @@
+#include "pipeline.h"
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "seq.h"
+
+codon::pipeline::RecordReader::RecordReader(std::istream& in) : lines{in} {}
+
+bool codon::pipeline::RecordReader::next_line() {
+  this->has_line = this->lines.next(this->line);
+  return this->has_line;
+}
+
+bool codon::pipeline::RecordReader::next(codon::pipeline::RawRecord& record) {
+  if (!this->has_line && !this->next_line()) return false;
+  while (this->line.empty()) {
+    if (!this->next_line()) return false;
+  }
+  if (this->marker == 0) {
+    if (this->line[0] != '>' && this->line[0] != '@') {
+      throw std::invalid_argument(
+          "Expected a FASTA ('>') or FASTQ ('@') header but line " +
+          std::to_string(this->lines.get_line_number()) + " starts with '" +
+          this->line[0] + "'.");
+    }
+    this->marker = this->line[0];
+  }
+  if (this->line[0] != this->marker) {
+    throw std::invalid_argument(
+        "Expected a header starting with '" + std::string(1, this->marker) +
+        "' in line " + std::to_string(this->lines.get_line_number()) + ".");
+  }
+  record.name.assign(this->line.substr(1));
+  record.bases.clear();
+  record.qualities.clear();
+
+  // sequence lines run up to the next header, or the '+' line of FASTQ
+  char stop = (this->marker == '>') ? '>' : '+';
+  bool stopped{false};
+  while (this->next_line()) {
+    if (!this->line.empty() && this->line[0] == stop) {
+      stopped = true;
+      break;
+    }
+    record.bases.append(this->line);
+  }
+  if (this->marker == '>') return true;
+
+  if (!stopped) {
+    throw std::invalid_argument("FASTQ record '" + record.name +
+                                "' has no '+' line.");
+  }
+  while (record.qualities.length() < record.bases.length() &&
+         this->next_line()) {
+    record.qualities.append(this->line);
+  }
+  if (record.qualities.length() != record.bases.length()) {
+    throw std::invalid_argument(
+        "FASTQ record '" + record.name + "' has " +
+        std::to_string(record.bases.length()) + " bases but " +
+        std::to_string(record.qualities.length()) + " quality scores.");
+  }
+  this->has_line = false;
+  return true;
+}
+
+std::size_t codon::pipeline::RecordReader::read_batch(
+    std::vector<codon::pipeline::RawRecord>& batch, std::size_t max_records) {
+  std::size_t count{0};
+  while (count < max_records) {
+    if (count == batch.size()) batch.emplace_back();
+    if (!this->next(batch[count])) break;
+    ++count;
+  }
+  return count;
+}
+
+codon::pipeline::Record codon::pipeline::parse_record(
+    codon::pipeline::RawRecord& record, std::size_t index) {
+  codon::Seq seq{std::string()};
+  try {
+    seq.assign(record.bases);
+  } catch (const std::invalid_argument& error) {
+    throw std::invalid_argument("Record '" + record.name + "': " +
+                                error.what());
+  }
+  return codon::pipeline::Record{index, std::move(record.name),
+                                 std::move(seq),
+                                 std::move(record.qualities)};
+}
+
+void codon::pipeline::write_record(std::ostream& out,
+                                   const codon::pipeline::Record& record) {
+  if (record.qualities.empty()) {
+    out << '>' << record.name << '\n' << record.seq.get_seq_str() << '\n';
+    return;
+  }
+  out << '@' << record.name << '\n'
+      << record.seq.get_seq_str() << "\n+\n"
+      << record.qualities << '\n';
+}
@@ -3,24 +3,179 @@
 #include <plog/Log.h>
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <memory_resource>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "codon.h"
+#include "kmer.h"
+#include "parallel.h"
+#include "stats.h"
 
-codon::Seq::Seq(const std::string &input) {
+namespace {
+
+// codon::base of a character in either case, 0xFF for anything else
+constexpr std::array<std::uint8_t, 256> make_base_table() {
+  std::array<std::uint8_t, 256> table{};
+  for (std::uint8_t& entry : table) entry = 0xFF;
+  table['A'] = table['a'] = codon::base::A;
+  table['G'] = table['g'] = codon::base::G;
+  table['C'] = table['c'] = codon::base::C;
+  table['T'] = table['t'] = codon::base::T;
+  return table;
+}
+
+constexpr std::array<std::uint8_t, 256> BASE_OF_CHAR{make_base_table()};
+
+/* Layout rebuilds are rare and short, so sequences share a few striped
+ * locks. A mutex member would make Seq immovable.
+ */
+constexpr std::size_t LAYOUT_STRIPES = 64;
+
+std::mutex& layout_lock(const codon::Seq* seq) {
+  static std::mutex stripes[LAYOUT_STRIPES];
+  return stripes[(reinterpret_cast<std::uintptr_t>(seq) / alignof(codon::Seq)) %
+                 LAYOUT_STRIPES];
+}
+
+// the bases of one raw codon byte, VOID and SWITCH hold none
+struct decoded_codon {
+  char chars[3];
+  codon::base bases[3];
+  std::uint8_t len;
+};
+
+const std::array<decoded_codon, 256>& decode_table() {
+  static const std::array<decoded_codon, 256> table{[] {
+    std::array<decoded_codon, 256> built{};
+    for (int bits{0}; bits < 256; ++bits) {
+      codon::Codon curr{
+          codon::Codon::from_bits(static_cast<std::uint8_t>(bits))};
+      decoded_codon& entry{built[bits]};
+      entry.len = static_cast<std::uint8_t>(curr.get_bases_len());
+      for (int idx{0}; idx < entry.len; ++idx) {
+        entry.bases[idx] = static_cast<codon::base>(
+            (bits >> (2 * (entry.len - 1 - idx))) & 3);
+        entry.chars[idx] = codon::base_to_str(entry.bases[idx]);
+      }
+    }
+    return built;
+  }()};
+  return table;
+}
+
+/* packs a stream of bases into full codons, left to right. The length
+ * marker starts as the lowest bit and moves up with every pushed base.
+ */
+class codon_packer {
+  codon::Seq::storage_type& out;
+  std::uint8_t bits{1};
+
+ public:
+  explicit codon_packer(codon::Seq::storage_type& out) : out{out} {}
+
+  void push(codon::base base) {
+    this->bits = static_cast<std::uint8_t>((this->bits << 2) | base);
+    if (this->bits & 0b01000000) {
+      this->out.push_back(codon::Codon::from_bits(this->bits));
+      this->bits = 1;
+    }
+  }
+
+  // emits the partial codon that is left over, if any
+  void flush() {
+    if (this->bits != 1)
+      this->out.push_back(codon::Codon::from_bits(this->bits));
+    this->bits = 1;
+  }
+};
+
+/* re-frames codons in place: whole codon payloads are appended to a small
+ * bit buffer and written back as full codons from dest onwards. As long as
+ * dest stays left of the codon that is read next, no extra buffer is needed.
+ */
+class codon_reframer {
+  codon::Seq::storage_type& seq;
+  std::size_t dest;
+  std::uint32_t pending{0};
+  int pending_len{0};
+
+ public:
+  codon_reframer(codon::Seq::storage_type& seq, std::size_t dest)
+      : seq{seq}, dest{dest} {}
+
+  void push(const codon::Codon& codon_in) {
+    int len = codon_in.get_bases_len();
+    std::uint32_t payload = codon_in.get_bases_int() & ((1u << (2 * len)) - 1);
+    this->push(payload, len);
+  }
+
+  void push(std::uint32_t payload, int len) {
+    this->pending = (this->pending << (2 * len)) | payload;
+    this->pending_len += len;
+    if (this->pending_len >= 3) {
+      this->pending_len -= 3;
+      std::uint32_t full = (this->pending >> (2 * this->pending_len)) & 0x3F;
+      this->seq[this->dest++] =
+          codon::Codon::from_bits(static_cast<std::uint8_t>(0b01000000 | full));
+      this->pending &= (1u << (2 * this->pending_len)) - 1;
+    }
+  }
+
+  int get_pending_len() const { return this->pending_len; }
+  std::size_t get_dest() const { return this->dest; }
+
+  // writes the partial codon that is left over and drops everything behind
+  void finish() {
+    if (this->pending_len) {
+      std::uint32_t marker = 1u << (2 * this->pending_len);
+      this->seq[this->dest++] = codon::Codon::from_bits(
+          static_cast<std::uint8_t>(marker | this->pending));
+    }
+    this->seq.erase(this->seq.begin() + this->dest, this->seq.end());
+  }
+};
+
+/* room to reserve for needed codons in an empty Seq. The inline block can
+ * only be taken whole while nothing else sits in it, a smaller reservation
+ * would move to the resource on the first growth.
+ */
+std::size_t initial_capacity(std::size_t needed) {
+  return (needed && needed <= CODON_SEQ_INLINE_CODONS)
+             ? CODON_SEQ_INLINE_CODONS
+             : needed;
+}
+
+}  // namespace
+
+codon::Seq::Seq(const std::string &input,
+                std::pmr::memory_resource *resource)
+    : codon::Seq(input, codon::CapacityPolicy::growth(), resource) {}
+
+codon::Seq::Seq(const std::string &input, codon::CapacityPolicy policy,
+                std::pmr::memory_resource *resource)
+    : inline_storage{resource},
+      seq{&this->inline_storage},
+      policy{policy},
+      layout_tree{resource} {
   int remainder_size = input.length() % 3;
   bool all_codons_full = (remainder_size == 0);
 
-  // ignore potential warning regarding integer division in combination with
-  // float -> int division part calculates the amount of necessary codons and
-  // floating point multiplication is just for 20% safety buffer loss of
-  // precision is negligable.
-  this->seq.reserve(static_cast<std::size_t>(
-      (all_codons_full) ? (input.length() / 3) * 1.2
-                        : (input.length() / 3 + 1) * 1.2));
+  /* the length is known up front, so no slack unless the policy asks for it
+   * or the input fits inline, where the whole block costs nothing
+   */
+  this->seq.reserve(initial_capacity(
+      std::max(this->policy.reserve_codons, (input.length() + 2) / 3)));
 
   PLOGD << "Generating Seq '" << input;
   PLOGD << "Remainder_size = " << remainder_size
@@ -40,21 +195,205 @@ codon::Seq::Seq(const std::string &input) {
   }
 }
 
+codon::Seq::Seq(const codon::Seq &other)
+    : codon::Seq(other, std::pmr::get_default_resource()) {}
+
+codon::Seq::Seq(const codon::Seq &other, std::pmr::memory_resource *resource)
+    : inline_storage{resource},
+      seq{&this->inline_storage},
+      policy{other.policy},
+      layout_tree{resource} {
+  this->seq.reserve(initial_capacity(other.seq.size()));
+  this->seq.assign(other.seq.begin(), other.seq.end());
+}
+
+codon::Seq &codon::Seq::operator=(const codon::Seq &other) {
+  // INFO: the old content is gone, so a recorder would be meaningless
+  this->reserve_for(other.seq.size());
+  this->seq = other.seq;
+  this->liftover = nullptr;
+  this->invalidate_layout();
+  return *this;
+}
+
+void codon::Seq::assign(std::string_view bases) {
+  // INFO: the old content is gone, so a recorder would be meaningless
+  this->liftover = nullptr;
+  this->invalidate_layout();
+  this->seq.clear();
+  this->reserve_for((bases.length() + 2) / 3);
+
+  /* whole triplets at once, a symbol that is no base sets the high bits.
+   * Codon is a trivially copyable byte, so the storage is sized once and
+   * the packed bytes are copied straight into it.
+   */
+  const char* curr{bases.data()};
+  std::size_t full{bases.length() / 3};
+  std::uint8_t invalid{0};
+  this->seq.resize(full, codon::Codon::from_bits(0));
+  for (std::size_t idx{0}; idx < full; ++idx, curr += 3) {
+    std::uint8_t first{BASE_OF_CHAR[static_cast<unsigned char>(curr[0])]};
+    std::uint8_t second{BASE_OF_CHAR[static_cast<unsigned char>(curr[1])]};
+    std::uint8_t third{BASE_OF_CHAR[static_cast<unsigned char>(curr[2])]};
+    invalid |= first | second | third;
+    std::uint8_t bits = static_cast<std::uint8_t>(
+        0b01000000 | (first << 4) | (second << 2) | third);
+    std::memcpy(&this->seq[idx], &bits, 1);
+  }
+  codon_packer packer(this->seq);
+  for (; curr != bases.data() + bases.length(); ++curr) {
+    std::uint8_t base{BASE_OF_CHAR[static_cast<unsigned char>(*curr)]};
+    invalid |= base;
+    if (base <= codon::base::T) packer.push(static_cast<codon::base>(base));
+  }
+  packer.flush();
+
+  if (invalid > codon::base::T) {
+    this->seq.clear();
+    for (char symbol : bases) {
+      if (BASE_OF_CHAR[static_cast<unsigned char>(symbol)] == 0xFF) {
+        throw std::invalid_argument(
+            std::string("Seq expects A, C, G or T but received '") + symbol +
+            "'.");
+      }
+    }
+  }
+}
+
+std::pmr::memory_resource *codon::Seq::get_resource() const {
+  return this->inline_storage.upstream_resource();
+}
+
+bool codon::Seq::is_inline() const {
+  return this->inline_storage.owns(this->seq.data());
+}
+
+void codon::Seq::set_capacity_policy(codon::CapacityPolicy policy) {
+  this->policy = policy;
+  this->seq.reserve(this->policy.reserve_codons);
+}
+
+codon::CapacityPolicy codon::Seq::get_capacity_policy() const {
+  return this->policy;
+}
+
+std::size_t codon::Seq::get_capacity() const { return this->seq.capacity(); }
+
+std::size_t codon::Seq::get_num_allocations() const {
+  return this->inline_storage.get_num_allocations();
+}
+
+void codon::Seq::reserve_for(std::size_t codons) {
+  if (codons <= this->seq.capacity()) return;
+  CODON_STATS_ADD(reallocations, 1);
+  std::size_t grown = static_cast<std::size_t>(
+      std::ceil(static_cast<double>(codons) * this->policy.growth_factor));
+  // INFO: outside the inline block it is free, so a target that fits moves in
+  if (!this->is_inline() && codons <= CODON_SEQ_INLINE_CODONS) {
+    grown = initial_capacity(codons);
+  }
+  this->seq.reserve(std::max(codons, grown));
+  PLOGD << "Reserved " << this->seq.capacity() << " codons for sequence";
+}
+
+codon::Seq::Seq(codon::Seq &&other) noexcept
+    : inline_storage{other.get_resource()},
+      seq{&this->inline_storage},
+      policy{other.policy},
+      liftover{other.liftover},
+      layout_tree{other.get_resource()} {
+  if (other.is_inline()) {
+    // fits into the own buffer by construction, so nothing can throw
+    this->seq.reserve(initial_capacity(other.seq.size()));
+    this->seq.assign(other.seq.begin(), other.seq.end());
+  } else {
+    // same upstream on both sides, the vector takes over the block
+    this->seq = std::move(other.seq);
+  }
+  other.seq.clear();
+  other.liftover = nullptr;
+  other.invalidate_layout();
+}
+
+codon::Seq &codon::Seq::operator=(codon::Seq &&other) {
+  if (this == &other) return *this;
+  if (!other.is_inline() && this->get_resource()->is_equal(
+                                *other.get_resource())) {
+    this->seq = std::move(other.seq);
+  } else {
+    this->reserve_for(other.seq.size());
+    this->seq.assign(other.seq.begin(), other.seq.end());
+  }
+  this->liftover = other.liftover;
+  this->invalidate_layout();
+  other.seq.clear();
+  other.liftover = nullptr;
+  other.invalidate_layout();
+  return *this;
+}
+
 codon::Seq::~Seq() {
   PLOGD << "Sequence at memory location '" << &this->seq
         << "' going out of scope";
 }
 
 std::string codon::Seq::get_seq_str() const {
-  std::string annealed_str;
-  annealed_str.reserve(this->seq.size() * 4);
-
-  for (codon::Codon curr_codon : this->seq) {
-    annealed_str.append(curr_codon.get_bases_str());
+  CODON_STATS_TIME(get_seq_str);
+  const std::array<decoded_codon, 256>& table{decode_table()};
+  std::size_t size{this->seq.size()};
+  // VOIDs left behind by shifts and pops decode to no bases at all
+  if (size < CODON_PARALLEL_MIN_CODONS) {
+    std::string annealed_str;
+    annealed_str.reserve(size * 3);
+    for (codon::Codon curr_codon : this->seq) {
+      const decoded_codon& curr{table[curr_codon.get_bases_int()]};
+      annealed_str.append(curr.chars, curr.len);
+    }
+    return annealed_str;
   }
-  annealed_str.shrink_to_fit();
+
+  /* sized once, every block writes from the bases in front of its codons.
+   * The layout is built here, before the fan-out, so blocks only read it.
+   */
+  this->refresh_layout();
+  std::string annealed_str(this->bases_before(size), 'A');
+  codon::parallel::for_each_block(
+      size, codon::parallel::MIN_BLOCK_CODONS,
+      [&](std::size_t first, std::size_t last) {
+        char* out{annealed_str.data() + this->bases_before(first)};
+        for (std::size_t idx{first}; idx < last; ++idx) {
+          const decoded_codon& curr{table[this->seq[idx].get_bases_int()]};
+          out = std::copy_n(curr.chars, curr.len, out);
+        }
+      });
   return annealed_str;
-};
+}
+
+std::array<std::size_t, 4> codon::Seq::count_bases() const {
+  CODON_STATS_TIME(count_bases);
+  const std::array<decoded_codon, 256>& table{decode_table()};
+  std::size_t size{this->seq.size()};
+  /* blocks hold at least MIN_BLOCK_CODONS codons, so first / grain gives
+   * every block its own partial count, summed after the join
+   */
+  std::vector<std::array<std::size_t, 4>> partial(
+      size / codon::parallel::MIN_BLOCK_CODONS + 1);
+  codon::parallel::for_each_block(
+      size, codon::parallel::MIN_BLOCK_CODONS,
+      [&](std::size_t first, std::size_t last) {
+        std::array<std::size_t, 4> local{};
+        for (std::size_t idx{first}; idx < last; ++idx) {
+          const decoded_codon& curr{table[this->seq[idx].get_bases_int()]};
+          for (int pos{0}; pos < curr.len; ++pos) ++local[curr.bases[pos]];
+        }
+        partial[first / codon::parallel::MIN_BLOCK_CODONS] = local;
+      });
+  std::array<std::size_t, 4> counts{};
+  for (const std::array<std::size_t, 4>& block : partial) {
+    for (std::size_t base{0}; base < 4; ++base) counts[base] += block[base];
+  }
+  return counts;
+}
 
 void codon::Seq::left_shift(std::size_t upto_loc) {
   /* removes left most base in final codon and the starts squeeze chain to the
@@ -64,18 +403,22 @@ void codon::Seq::left_shift(std::size_t upto_loc) {
    * discard one of the bases beforehand or right_shift twice to get the same
    * alignment
    */
+  CODON_STATS_TIME(left_shift);
+  this->invalidate_layout();
   std::size_t idx{this->get_last_idx()};
   std::size_t final_stop{(upto_loc) ? upto_loc : this->get_first_idx()};
   int size_at_upto_loc = this->seq.at(final_stop).get_bases_len() < 3;
 
   // INFO: Early return for edge case during pop_base() at the final codon,
-  // might otherwise result in weird stuff.
-  if (final_stop == idx) return;
+  // might otherwise result in weird stuff. Emptying the final codon leaves
+  // final_stop behind the last one.
+  if (final_stop >= idx) return;
 
   // INFO: Final stop correction in case the first idx is displaced by a VOID
   while (this->seq.at(final_stop).is_full() && final_stop > 0) --final_stop;
 
   if (this->seq.at(final_stop).get_bases_len() < 3) {
+    CODON_STATS_ADD(shifted_codons, idx - final_stop + 1);
     codon::base hopping_base{this->seq[idx].pop(1)};
     // TODO: If buffer is implemented this needs to be changed
     // Currently removes codon if we took the last basepair
@@ -83,8 +426,13 @@ void codon::Seq::left_shift(std::size_t upto_loc) {
       this->seq.pop_back();
     }
 
-    // moving idx backwards and sqeeuze hopping back
+    // moving idx backwards and sqeeuze hopping back, a codon with room on
+    // the way takes it and ends the chain
     while (--idx > final_stop) {
+      if (!this->seq[idx].is_full()) {
+        this->seq[idx].insert_right(hopping_base);
+        return;
+      }
       hopping_base = this->seq[idx].squeeze_right(hopping_base);
     }
     this->seq[idx].insert_right(hopping_base);
@@ -100,14 +448,24 @@ void codon::Seq::right_shift(std::size_t upto_loc) {
    * back propogating bases until the final one --> if last codon is already
    * full a new one will be generated, increasing codon::Seq::seq.size() by one
    */
+  CODON_STATS_TIME(right_shift);
+  this->invalidate_layout();
   std::size_t idx{this->get_first_idx()};
   std::size_t final_stop{(upto_loc) ? upto_loc : get_last_idx()};
+  // INFO: a single codon has no neighbour to take the base, same as above
+  if (final_stop <= idx) return;
+  CODON_STATS_ADD(shifted_codons, final_stop - idx + 1);
 
   codon::base hopping_base = this->seq[idx].pop(this->seq[idx].get_bases_len());
+  CODON_STATS_ADD(void_codons, this->seq[idx].is_empty());
   // Should this operation result in the first codon being empty it will turn
   // VOID but stay in the seq because deletion of first item is expensive.
 
   while (++idx < final_stop) {
+    if (!this->seq[idx].is_full()) {
+      this->seq[idx].insert_left(hopping_base);
+      return;
+    }
     hopping_base = this->seq[idx].squeeze_left(hopping_base);
   }
 
@@ -116,13 +474,19 @@ void codon::Seq::right_shift(std::size_t upto_loc) {
 
   } else {
     hopping_base = this->seq[idx++].squeeze_left(hopping_base);
+    this->reserve_for(this->seq.size() + 1);
+    CODON_STATS_ADD(mid_inserts, 1);
+    CODON_STATS_ADD(mid_insert_codons, this->seq.size() - idx);
     this->seq.emplace((this->seq.begin() + idx), codon::Codon(hopping_base));
-    // this should be fine assuming you have enough buffer left.
-    // if not the vector resizes automatically but it should only happen once.
   }
 }
 
 void codon::Seq::insert_base(codon::base base, codon::locator locator) {
+  CODON_STATS_TIME(insert_base);
+  // INFO: recorded up front, nothing below can fail once the index is valid
+  if (this->liftover)
+    this->liftover->record_insert(this->base_offset(locator), 1);
+  this->invalidate_layout();
   if (this->seq.at(locator.index).get_bases_len() < 3) {
     // incase locator.index is already an incomplete codon
     switch (locator.shift) {
@@ -183,6 +547,7 @@ void codon::Seq::insert_base(codon::base base, codon::locator locator) {
    * make a new codon can lead to resizing but effect is minimal because of
    * existing buffer
    */
+  this->reserve_for(this->seq.size() + 1);
   // TODO: Change this to be more specific in case I want to implement a buffer
   this->seq.emplace_back(codon::Codon(hopping_base));
 }
@@ -192,6 +557,7 @@ void codon::Seq::insert_codon(codon::Codon codon_insert,
   /* insert a codon into sequence, squeezing it into already existing
    * codon(s) when locator.shift > 0, will split codon if VOID is provided
    */
+  CODON_STATS_TIME(insert_codon);
   locator.verify_shift();
   if (!this->is_locator_valid(locator)) {
     throw std::invalid_argument(
@@ -205,6 +571,9 @@ void codon::Seq::insert_codon(codon::Codon codon_insert,
 
   // early exit for edge-case: insert can fit in location
   if (size_original + size_insert <= 3) {
+    // INFO: behind a partial codon means right after its last base, the
+    // bases below are inserted back to front at that same spot
+    locator.shift = std::min(locator.shift, size_original + 1);
     while (size_insert--) {
       /* INFO: This will momentarily use an invalidated locator when pop removes
        * only available base at end, creating an intermediate VOID for
@@ -215,16 +584,15 @@ void codon::Seq::insert_codon(codon::Codon codon_insert,
     }
     return;
   }
-
-  // make space and new buffer if not large enough
-  if ((this->seq.size() + 2) < this->seq.capacity()) {
-    this->seq.reserve(static_cast<std::size_t>((this->seq.size() + 2) * 1.2));
-    PLOGD << "RESERVING MORE MEMORY FOR SEQUENCE";
+  if (this->liftover) {
+    this->liftover->record_insert(this->base_offset(locator), size_insert);
   }
+  this->invalidate_layout();
 
   // STEP 1 REARRANGE AND COMBINE
-  int amount_expelled =
-      this->seq[locator.index].get_bases_len() - locator.shift + 1;
+  // INFO: a shift behind a partial codon appends to it, nothing to expel
+  int amount_expelled = std::max(
+      this->seq[locator.index].get_bases_len() - locator.shift + 1, 0);
   codon::Codon expelled = Codon("VOID");
   while (amount_expelled--) {
     expelled.insert_left(this->seq[locator.index].pop());
@@ -254,11 +622,14 @@ void codon::Seq::insert_codon(codon::Codon codon_insert,
     codon_insert.insert_right(expelled.pop(1));
 
   // STEP 2 PUSH THAT INSERT IN
+  this->reserve_for(this->seq.size() + 1);
   if (locator.index == this->get_last_idx()) {
     this->seq.emplace_back(std::move(codon_insert));
   } else {
-    std::vector<codon::Codon>::iterator it_seq{this->seq.begin() +
-                                               locator.index + 1};
+    codon::Seq::storage_type::iterator it_seq{this->seq.begin() +
+                                              locator.index + 1};
+    CODON_STATS_ADD(mid_inserts, 1);
+    CODON_STATS_ADD(mid_insert_codons, this->seq.end() - it_seq);
     this->seq.insert(it_seq, std::move(codon_insert));
 
     while (this->seq[locator.index + 1].get_bases_len() < 3 &&
@@ -272,15 +643,335 @@ void codon::Seq::insert_codon(codon::Codon codon_insert,
   }
 }
 
-void codon::Seq::insert_seq(codon::Seq other, codon::locator locator) {
-  // check if capacity is compromised
-  if ((this->seq.size() + other.seq.size()) < this->seq.capacity()) {
-    this->seq.reserve((this->seq.size() + other.seq.size()) * 1.2);
-    PLOGD << "RESERVING MORE MEMORY FOR SEQUENCE";
-  };
-  int bases_at_insert = this->seq[locator.index].get_bases_len();
+void codon::Seq::insert_seq(const codon::Seq& other, codon::locator locator) {
+  if (other.begin() == other.end()) return;
+  this->insert_seq(other.slice(other.get_first_loc(), other.get_last_loc()),
+                   locator);
+}
+
+void codon::Seq::insert_seq(codon::Seq&& other, codon::locator locator) {
+  locator.verify_shift();
+  if (&other == this || other.begin() == other.end() || this->seq.empty() ||
+      locator.index != this->get_last_idx() ||
+      locator.shift <= this->seq[locator.index].get_bases_len()) {
+    this->insert_seq(static_cast<const codon::Seq&>(other), locator);
+    return;
+  }
+  /* appending behind a partial last codon: that codon stays partial and the
+   * codons of other follow as they are, so nothing is re-framed. The larger
+   * side's storage is kept, other's if it is on the heap of the same upstream.
+   */
+  CODON_STATS_TIME(insert_seq);
+  if (this->liftover) {
+    this->liftover->record_insert(this->base_offset(locator),
+                                  other.get_seq_trulen("bp"));
+  }
+  this->invalidate_layout();
+  this->seq.erase(this->seq.begin() + locator.index + 1, this->seq.end());
+  if (!other.is_inline() && other.seq.size() > this->seq.size() &&
+      this->get_resource()->is_equal(*other.get_resource())) {
+    other.seq.insert(other.seq.begin(), this->seq.begin(), this->seq.end());
+    // INFO: growing may have moved other into its own inline buffer
+    if (other.is_inline()) {
+      this->reserve_for(other.seq.size());
+      this->seq.assign(other.seq.begin(), other.seq.end());
+    } else {
+      this->seq = std::move(other.seq);
+    }
+  } else {
+    this->reserve_for(this->seq.size() + other.seq.size());
+    this->seq.insert(this->seq.end(), other.seq.begin(), other.seq.end());
+  }
+  other.seq.clear();
+  other.liftover = nullptr;
+  other.invalidate_layout();
+  PLOGD << "Appended " << (this->seq.size() - locator.index - 1)
+        << " codons behind pos. " << locator.index;
+}
+
+void codon::Seq::insert_seq(const codon::SeqView& other,
+                            codon::locator locator) {
+  /* inserts the bases of other in front of the base at locator.
+   * Three cases, all linear in the touched part of the sequence:
+   *  1. locator at a codon border and other made of full codons: the codons
+   *     are spliced in as they are with one vector::insert.
+   *  2. insert length divisible by 3: only the codon at locator is split and
+   *     re-packed together with the insert, the tail keeps its frame.
+   *  3. otherwise the insert and the whole tail are re-framed in one pass.
+   */
+  CODON_STATS_TIME(insert_seq);
+  locator.verify_shift();
+  if (this->seq.empty() || locator < this->get_first_loc() ||
+      locator.index > this->get_last_idx()) {
+    throw std::invalid_argument(
+        "Passed codon::locator to insert_seq is outside of valid range.");
+  }
+  // INFO: like insert_base, a shift behind a partial codon is right after
+  // its last base, behind the last codon that appends
+  locator.shift =
+      std::min(locator.shift, this->seq[locator.index].get_bases_len() + 1);
+  const codon::Codon* src_first =
+      other.get_parent().seq.data() + other.get_first_idx();
+  const codon::Codon* src_last =
+      other.get_parent().seq.data() + other.get_last_idx() + 1;
+  bool is_aliased = (&other.get_parent() == this);
+  // a parent known to be canonical can only end on a partial codon
+  const codon::Seq& source = other.get_parent();
+  bool source_full =
+      (source.layout_valid.load(std::memory_order_acquire) &&
+       source.layout_canonical)
+          ? src_last[-1].is_full()
+          : std::all_of(src_first, src_last,
+                        [](const codon::Codon& curr_codon) {
+                          return curr_codon.is_full();
+                        });
+  if (this->liftover) {
+    this->liftover->record_insert(this->base_offset(locator),
+                                  other.get_seq_trulen("bp"));
+  }
+  this->invalidate_layout();
+
+  if (locator.shift == 1 && other.get_frame() == 0 &&
+      other.get_last_loc().shift == 3 && source_full) {
+    CODON_STATS_ADD(mid_inserts, 1);
+    CODON_STATS_ADD(mid_insert_codons, this->seq.size() - locator.index);
+    if (is_aliased) {
+      codon::Seq::storage_type block(src_first, src_last,
+                                     this->get_resource());
+      this->reserve_for(this->seq.size() + block.size());
+      this->seq.insert(this->seq.begin() + locator.index, block.begin(),
+                       block.end());
+    } else {
+      this->reserve_for(this->seq.size() + (src_last - src_first));
+      this->seq.insert(this->seq.begin() + locator.index, src_first,
+                       src_last);
+    }
+    PLOGD << "Spliced " << (src_last - src_first) << " codons at pos. "
+          << locator.index;
+    return;
+  }
+
+  std::size_t insert_len{other.get_seq_trulen("bp")};
+  codon::Seq::storage_type block{this->get_resource()};
+  block.reserve((insert_len % 3 == 0)
+                    ? insert_len / 3 + 1
+                    : insert_len / 3 + 2 + this->seq.size() - locator.index);
+  codon_packer packer{block};
+  const codon::Codon target{this->seq[locator.index]};
+  codon::base_iterator it_target(&target, &target + 1);
+  for (int shift{1}; shift < locator.shift; ++shift, ++it_target) {
+    packer.push(*it_target);
+  }
+  for (codon::base curr_base : other.bases()) packer.push(curr_base);
+
+  if (insert_len % 3 == 0) {
+    for (; it_target != codon::base_iterator(&target + 1, &target + 1);
+         ++it_target) {
+      packer.push(*it_target);
+    }
+    packer.flush();
+    this->reserve_for(this->seq.size() + block.size() - 1);
+    this->seq[locator.index] = block.front();
+    if (block.size() > 1) {
+      CODON_STATS_ADD(mid_inserts, 1);
+      CODON_STATS_ADD(mid_insert_codons, this->seq.size() - locator.index - 1);
+    }
+    this->seq.insert(this->seq.begin() + locator.index + 1, block.begin() + 1,
+                     block.end());
+    PLOGD << "Inserted " << insert_len << " bases in frame at pos. "
+          << locator.index;
+    return;
+  }
+
+  const codon::Codon* tail_last = this->seq.data() + this->seq.size();
+  for (codon::base curr_base : codon::base_range(
+           codon::base_iterator(this->seq.data() + locator.index, tail_last,
+                                locator.shift),
+           codon::base_iterator(tail_last, tail_last))) {
+    packer.push(curr_base);
+  }
+  packer.flush();
+  this->seq.erase(this->seq.begin() + locator.index, this->seq.end());
+  this->reserve_for(this->seq.size() + block.size());
+  this->seq.insert(this->seq.end(), block.begin(), block.end());
+  PLOGD << "Inserted " << insert_len << " bases at pos. " << locator.index
+        << " and re-framed the tail";
+}
+
+void codon::Seq::erase(codon::locator first, codon::locator last) {
+  /* removes every base from first to last (both inclusive) in one pass.
+   * The bases left of first and right of last in the border codons are
+   * merged; if they fill whole codons the tail keeps its frame and is moved
+   * with a single vector::erase, otherwise the tail is re-framed in place
+   * codon by codon.
+   */
+  CODON_STATS_TIME(erase);
+  first.verify_shift();
+  last.verify_shift();
+  for (const codon::locator &border : {first, last}) {
+    if (!this->is_locator_valid(border) ||
+        border.shift > this->seq[border.index].get_bases_len()) {
+      throw std::invalid_argument(
+          "Passed codon::locator to erase is outside of valid range.");
+    }
+  }
+  if (first > last) {
+    throw std::invalid_argument(
+        "erase expects the first locator to be in front of the last one.");
+  }
+  if (this->liftover) {
+    std::size_t offset_first{this->base_offset(first)};
+    this->liftover->record_erase(
+        offset_first, this->base_offset(last) - offset_first + 1);
+  }
+  this->invalidate_layout();
+
+  const codon::Codon head{this->seq[first.index]};
+  const codon::Codon tail{this->seq[last.index]};
+  int head_len = first.shift - 1;
+  int tail_len = tail.get_bases_len() - last.shift;
+  std::uint32_t head_bits = (head.get_bases_int() >>
+                             (2 * (head.get_bases_len() - head_len))) &
+                            ((1u << (2 * head_len)) - 1);
+  std::uint32_t tail_bits = tail.get_bases_int() & ((1u << (2 * tail_len)) - 1);
+
+  codon_reframer reframer(this->seq, first.index);
+  reframer.push(head_bits, head_len);
+  reframer.push(tail_bits, tail_len);
+  std::size_t tail_start{last.index + 1};
+
+  if (reframer.get_pending_len() == 0) {
+    this->seq.erase(this->seq.begin() + reframer.get_dest(),
+                    this->seq.begin() + tail_start);
+    PLOGD << "Erased codons " << first.index << " to " << last.index
+          << " keeping the frame of the tail";
+    return;
+  }
+  for (std::size_t idx{tail_start}; idx < this->seq.size(); ++idx) {
+    reframer.push(this->seq[idx]);
+  }
+  reframer.finish();
+  PLOGD << "Erased codons " << first.index << " to " << last.index
+        << " and re-framed the tail";
+}
+
+codon::LiftoverMap codon::Seq::apply_edits(
+    const std::vector<codon::Edit> &edits) {
+  /* single left to right sweep over the bases: unchanged bases are copied,
+   * edits are applied when the sweep reaches their locator. The result is
+   * packed into a new buffer, so the sequence stays untouched if an edit
+   * turns out to be invalid, and ends up canonical (only full codons
+   * except for the last one). Indels are collected as (offset, +/-length)
+   * in edited coordinates and only recorded once the sweep succeeded.
+   */
+  CODON_STATS_TIME(apply_edits);
+  std::size_t inserted{0};
+  for (const codon::Edit &edit : edits) inserted += edit.bases.length();
+  /* compares equal to inline_storage, so a block edited gets from the
+   * upstream changes hands below instead of being copied
+   */
+  codon::small_buffer_resource<CODON_SEQ_INLINE_CODONS> scratch{
+      this->get_resource()};
+  codon::Seq::storage_type edited{&scratch};
+  edited.reserve(this->seq.size() + inserted / 3 + 1);
+  codon_packer packer{edited};
+  std::vector<std::pair<std::size_t, std::ptrdiff_t>> indels;
+
+  const codon::Codon *data = this->seq.data();
+  const codon::Codon *limit = data + this->seq.size();
+  codon::base_iterator it_base(data, limit);
+  const codon::base_iterator past_last(limit, limit);
+  std::size_t orig_offset{0};
+  std::size_t new_offset{0};
+
+  for (const codon::Edit &edit : edits) {
+    codon::locator target{edit.locator};
+    target.verify_shift();
+    while (it_base != past_last &&
+           codon::locator(it_base.get_codon() - data, it_base.get_shift()) <
+               target) {
+      packer.push(*it_base);
+      ++it_base;
+      ++orig_offset;
+      ++new_offset;
+    }
+    // INFO: an insertion may also sit right behind the last base, which
+    // is {last, len + 1} behind a partial codon and {last + 1, 1} otherwise
+    bool at_end{false};
+    if (it_base == past_last && edit.type == codon::edit_type::insertion &&
+        !this->seq.empty()) {
+      std::size_t last{this->get_last_idx()};
+      int len = this->seq[last].get_bases_len();
+      at_end = (len < 3) ? target == codon::locator(last, len + 1)
+                         : target == codon::locator(last + 1, 1);
+    }
+    if (!at_end &&
+        (it_base == past_last ||
+         codon::locator(it_base.get_codon() - data, it_base.get_shift()) !=
+             target)) {
+      throw std::invalid_argument(
+          "apply_edits expects sorted, non-overlapping edits that point at "
+          "a base of the sequence.");
+    }
+
+    std::size_t amount = (edit.type == codon::edit_type::deletion)
+                             ? edit.length
+                             : edit.bases.length();
+    for (std::size_t pos{0}; pos < amount; ++pos) {
+      if (edit.type != codon::edit_type::insertion) {
+        if (it_base == past_last) {
+          throw std::invalid_argument(
+              "Edit passed to apply_edits reaches past the end of the "
+              "sequence.");
+        }
+        ++it_base;
+        ++orig_offset;
+      }
+      if (edit.type != codon::edit_type::deletion) {
+        codon::base new_base{codon::base::A};
+        if (!codon::kmer::char_to_base(edit.bases[pos], new_base)) {
+          throw std::invalid_argument(
+              std::string("apply_edits expects A, C, G or T but received '") +
+              edit.bases[pos] + "'.");
+        }
+        packer.push(new_base);
+        ++new_offset;
+      }
+    }
+    if (edit.type == codon::edit_type::insertion) {
+      indels.emplace_back(new_offset - amount,
+                          static_cast<std::ptrdiff_t>(amount));
+    } else if (edit.type == codon::edit_type::deletion) {
+      indels.emplace_back(new_offset, -static_cast<std::ptrdiff_t>(amount));
+    }
+  }
+
+  for (; it_base != past_last; ++it_base, ++orig_offset, ++new_offset) {
+    packer.push(*it_base);
+  }
+  packer.flush();
+  if (scratch.owns(edited.data())) {
+    // the scratch buffer dies with this frame, so its codons are copied
+    this->reserve_for(edited.size());
+    this->seq.assign(edited.begin(), edited.end());
+  } else {
+    this->seq = std::move(edited);
+  }
+  this->invalidate_layout();
 
-  // TODO: insert_seq() needs to be finished
+  codon::LiftoverMap liftover(orig_offset);
+  for (const auto &[offset, length] : indels) {
+    for (codon::LiftoverMap *map : {&liftover, this->liftover}) {
+      if (!map) continue;
+      if (length > 0)
+        map->record_insert(offset, length);
+      else
+        map->record_erase(offset, -length);
+    }
+  }
+  PLOGD << "Applied " << edits.size() << " edits, " << orig_offset
+        << " bp -> " << new_offset << " bp";
+  return liftover;
 }
 
 codon::Codon codon::Seq::get_codon_at(const codon::locator &locator) const {
@@ -307,22 +998,58 @@ std::size_t codon::Seq::get_seq_len() const {
 }
 
 std::size_t codon::Seq::get_seq_trulen(std::string how) const {
-  std::size_t idx_left{this->get_first_idx()};
-  std::size_t idx_right{this->get_last_idx()};
-  std::size_t bases{0};
+  // INFO: erase() can leave the sequence without any base
+  if (this->begin() == this->end() &&
+      (how == "codons" || how == "bp" || how == "bases"))
+    return 0;
+  if (how == "bp" || how == "bases") {
+    this->refresh_layout();
+    return this->layout_bases;
+  }
   if (how == "codons")
-    return idx_right - idx_left + 1;
-  else if (how == "bp" || how == "bases") {
-    std::for_each(this->seq.begin(), this->seq.end(),
-                  [&](const codon::Codon &curr_codon) {
-                    bases += curr_codon.get_bases_len();
-                  });
-  } else {
-    std::string message = "Expected 'codons', 'bp' or 'bases' but received ";
-    message += how;
-    throw std::invalid_argument(message);
+    return this->get_last_idx() - this->get_first_idx() + 1;
+  std::string message = "Expected 'codons', 'bp' or 'bases' but received ";
+  message += how;
+  throw std::invalid_argument(message);
+}
+
+codon::codon_iterator codon::Seq::begin() const {
+  // INFO: stops at end(), so an empty or all-VOID sequence has no codons
+  const codon::Codon* first = this->seq.data();
+  const codon::Codon* last = this->end().get_codon();
+  while (first != last && first->is_empty()) ++first;
+  return codon::codon_iterator(first, last);
+}
+
+codon::codon_iterator codon::Seq::end() const {
+  // trims trailing VOIDs
+  const codon::Codon* first = this->seq.data();
+  const codon::Codon* last = first + this->seq.size();
+  while (last != first && (last - 1)->is_empty()) --last;
+  return codon::codon_iterator(last, last);
+}
+
+codon::base_range codon::Seq::bases() const {
+  const codon::Codon* first = this->begin().get_codon();
+  const codon::Codon* last = this->end().get_codon();
+  return codon::base_range(codon::base_iterator(first, last),
+                           codon::base_iterator(last, last));
+}
+
+codon::kmer_range codon::Seq::kmers(int k, bool use_canonical) const {
+  if (k < 1 || k > 32) {
+    throw std::invalid_argument("Expected k between 1 and 32 but received " +
+                                std::to_string(k) + ".");
   }
-  return bases;
+  codon::base_range range{this->bases()};
+  return codon::kmer_range(
+      codon::kmer_iterator(range.begin(), range.end(), k, use_canonical),
+      codon::kmer_iterator(range.end(), range.end(), k, use_canonical));
+}
+
+codon::SeqView codon::Seq::slice(codon::locator first,
+                                 codon::locator last) const {
+  return codon::SeqView(*this, first, last);
 }
 
 std::size_t codon::Seq::get_first_idx() const {
@@ -330,6 +1057,7 @@ std::size_t codon::Seq::get_first_idx() const {
   while (!this->seq.at(idx_fwd).get_bases_len()) {
     ++idx_fwd;
   }
+  CODON_STATS_ADD(first_idx_scans, idx_fwd + 1);
   return idx_fwd;
 }
 std::size_t codon::Seq::get_last_idx() const {
@@ -337,6 +1065,7 @@ std::size_t codon::Seq::get_last_idx() const {
   while (!(this->seq.at(idx_rev).get_bases_len())) {
     --idx_rev;
   }
+  CODON_STATS_ADD(last_idx_scans, this->seq.size() - idx_rev);
   return idx_rev;
 }
 
@@ -346,12 +1075,17 @@ codon::base codon::Seq::pop_base(codon::locator locator) {
   // After removal seq will shift left to fill hole.
   //   [1] base_1 [2] base_2 [3] base_3
   //   any number above 3 will be treated as 3, squeezing out prior base 3.
+  CODON_STATS_TIME(pop_base);
   codon::base popped_base;
   if (this->get_codon_at(locator.index).is_empty()) {
     throw std::invalid_argument("Tried to use pop_base() on empty Codon");
   } else {
+    std::size_t offset{this->liftover ? this->pop_offset(locator) : 0};
+    this->invalidate_layout();
     popped_base = this->seq[locator.index].pop(locator.shift);
+    CODON_STATS_ADD(void_codons, this->seq[locator.index].is_empty());
     this->left_shift(locator.index);
+    if (this->liftover) this->liftover->record_erase(offset, 1);
   }
   return popped_base;
 }
@@ -360,6 +1094,7 @@ codon::Codon codon::Seq::pop_codon(codon::locator locator, int size_cut) {
   /* size_cut defaults to three but will remove less
    * if <3 bases are availabel
    */
+  CODON_STATS_TIME(pop_codon);
 
   // edge case: size_cut = 0
   codon::Codon popped_codon("VOID");
@@ -370,18 +1105,38 @@ codon::Codon codon::Seq::pop_codon(codon::locator locator, int size_cut) {
   int original_len = this->seq.at(locator.index).get_bases_len();
   int overflow = (locator.shift - 1) + (size_cut - original_len);
   if (overflow < 0) overflow = 0;
+  // a shift behind a partial codon leaves nothing to cut from it
+  if (overflow > size_cut) overflow = size_cut;
   int cut_main = size_cut - overflow;
   PLOGD << "Calculated overflow = " << overflow << " (shift = " << locator.shift
         << ", original_len = " << original_len << ", size_cut = " << size_cut
         << ") and cut main = " << cut_main;
+  // INFO: unlike pop_base() a shift behind the codon cuts from the next one
+  std::size_t offset{0};
+  if (this->liftover) {
+    offset = (locator.shift == 0) ? this->pop_offset(locator)
+                                  : this->base_offset(locator);
+  }
+  this->invalidate_layout();
 
   while (cut_main) {
     popped_codon.insert_right(this->seq[locator.index].pop(locator.shift));
     --cut_main;
   }
-  while (overflow && (locator.index < this->get_last_idx())) {
-    popped_codon.insert_right(this->seq[locator.index + 1].pop(1));
+  CODON_STATS_ADD(void_codons, this->seq[locator.index].is_empty());
+  // the overflow comes from the next codons that still hold bases
+  std::size_t next{locator.index + 1};
+  while (overflow && next <= this->get_last_idx()) {
+    if (this->seq[next].is_empty()) {
+      ++next;
+      continue;
+    }
+    popped_codon.insert_right(this->seq[next].pop(1));
     --overflow;
+    CODON_STATS_ADD(void_codons, this->seq[next].is_empty());
+  }
+  if (this->liftover) {
+    this->liftover->record_erase(offset, popped_codon.get_bases_len());
   }
 
   // early exit in case we end section was removed
@@ -415,7 +1170,7 @@ codon::locator codon::Seq::get_last_loc() const {
   return codon::locator(idx, shift);
 }
 
-bool codon::Seq::is_locator_valid(codon::locator locator) {
+bool codon::Seq::is_locator_valid(codon::locator locator) const {
   return (locator >= this->get_first_loc() && locator <= this->get_last_loc());
 }
 
@@ -430,3 +1185,185 @@ void codon::locator::verify_shift() {
     throw std::invalid_argument(
         "verify_shift for codon::locator failed => shift is out of scope.");
 }
+
+codon::Edit::Edit(codon::edit_type type, codon::locator locator,
+                  std::string bases, std::size_t length)
+    : type{type}, locator{locator}, bases{std::move(bases)}, length{length} {
+  if (type == codon::edit_type::deletion) {
+    if (this->length == 0)
+      throw std::invalid_argument("Deletion edit needs a length above 0.");
+    this->bases.clear();
+    return;
+  }
+  codon::base parsed{codon::base::A};
+  if (this->bases.empty() ||
+      !std::all_of(this->bases.begin(), this->bases.end(), [&](char curr) {
+        return codon::kmer::char_to_base(curr, parsed);
+      })) {
+    throw std::invalid_argument(
+        "Substitution and insertion edits expect a non-empty string of "
+        "A, C, G and T.");
+  }
+  this->length = this->bases.length();
+}
+
+codon::Edit codon::Edit::substitution(codon::locator locator,
+                                      std::string bases) {
+  return codon::Edit(codon::edit_type::substitution, locator,
+                     std::move(bases));
+}
+
+codon::Edit codon::Edit::insertion(codon::locator locator, std::string bases) {
+  return codon::Edit(codon::edit_type::insertion, locator, std::move(bases));
+}
+
+codon::Edit codon::Edit::deletion(codon::locator locator, std::size_t length) {
+  return codon::Edit(codon::edit_type::deletion, locator, "", length);
+}
+
+void codon::Seq::attach_liftover(codon::LiftoverMap &map) {
+  if (map.get_new_len() != this->get_seq_trulen("bp")) {
+    throw std::invalid_argument(
+        "Attached LiftoverMap has to cover the current sequence length.");
+  }
+  this->liftover = &map;
+}
+
+void codon::Seq::detach_liftover() { this->liftover = nullptr; }
+
+std::size_t codon::Seq::base_offset(const codon::locator &locator) const {
+  // bases in front of locator, a shift behind a partial codon points past it
+  int len = this->seq.at(locator.index).get_bases_len();
+  return this->bases_before(locator.index) +
+         std::min(std::max(locator.shift - 1, 0), len);
+}
+
+std::size_t codon::Seq::pop_offset(const codon::locator &locator) const {
+  // Codon::pop() takes the last base for shift 0 or a shift behind it
+  int len = this->seq.at(locator.index).get_bases_len();
+  int shift = (locator.shift == 0 || locator.shift > len) ? len : locator.shift;
+  return this->base_offset(codon::locator(locator.index, shift));
+}
+
+void codon::Seq::compact() {
+  /* one pass over the storage: VOIDs are dropped and partial codons are
+   * filled up from their right neighbours, in place. The full prefix is
+   * left untouched.
+   */
+  CODON_STATS_TIME(compact);
+  std::size_t first_gap{0};
+  while (first_gap < this->seq.size() && this->seq[first_gap].is_full()) {
+    ++first_gap;
+  }
+  codon_reframer reframer(this->seq, first_gap);
+  for (std::size_t idx{first_gap}; idx < this->seq.size(); ++idx) {
+    reframer.push(this->seq[idx]);
+  }
+  reframer.finish();
+  this->seq.shrink_to_fit();
+
+  this->invalidate_layout();
+  this->refresh_layout();
+  PLOGD << "Compacted sequence to " << this->seq.size() << " codons";
+}
+
+bool codon::Seq::is_canonical() const {
+  this->refresh_layout();
+  return this->layout_canonical;
+}
+
+codon::locator codon::Seq::locate(std::size_t base_pos) const {
+  CODON_STATS_TIME(locate);
+  this->refresh_layout();
+  if (base_pos >= this->layout_bases) {
+    throw std::invalid_argument("Base position " + std::to_string(base_pos) +
+                                " is behind the end of the sequence.");
+  }
+  if (this->layout_canonical) {
+    return codon::locator(base_pos / 3, static_cast<int>(base_pos % 3) + 1);
+  }
+  // descend the Fenwick tree, empty codons are skipped on the way
+  std::size_t size{this->seq.size()};
+  std::size_t idx{0};
+  std::size_t step{1};
+  while (step * 2 <= size) step *= 2;
+  for (; step; step /= 2) {
+    if (idx + step <= size && this->layout_tree[idx + step] <= base_pos) {
+      idx += step;
+      base_pos -= this->layout_tree[idx];
+    }
+  }
+  return codon::locator(idx, static_cast<int>(base_pos) + 1);
+}
+
+std::size_t codon::Seq::offset_of(const codon::locator &locator) const {
+  CODON_STATS_TIME(offset_of);
+  if (locator.index >= this->seq.size() || locator.shift < 1 ||
+      locator.shift > this->seq[locator.index].get_bases_len()) {
+    throw std::invalid_argument(
+        "Passed codon::locator to offset_of does not point at a base.");
+  }
+  return this->bases_before(locator.index) + locator.shift - 1;
+}
+
+void codon::Seq::refresh_layout() const {
+  if (this->layout_valid.load(std::memory_order_acquire)) return;
+  std::lock_guard<std::mutex> lock{layout_lock(this)};
+  if (this->layout_valid.load(std::memory_order_relaxed)) return;
+  std::size_t size{this->seq.size()};
+  this->layout_bases = 0;
+  this->layout_canonical = true;
+  for (std::size_t idx{0}; idx < size; ++idx) {
+    int len = this->seq[idx].get_bases_len();
+    this->layout_bases += len;
+    if ((len < 3 && idx + 1 < size) || len == 0)
+      this->layout_canonical = false;
+  }
+
+  this->layout_tree.clear();
+  if (!this->layout_canonical) {
+    // O(n) Fenwick construction, layout_tree[i] covers codons up to i - 1
+    this->layout_tree.resize(size + 1, 0);
+    for (std::size_t idx{1}; idx <= size; ++idx) {
+      this->layout_tree[idx] += this->seq[idx - 1].get_bases_len();
+      std::size_t parent = idx + (idx & (~idx + 1));
+      if (parent <= size) this->layout_tree[parent] += this->layout_tree[idx];
+    }
+  }
+  this->layout_valid.store(true, std::memory_order_release);
+}
+
+std::size_t codon::Seq::bases_before(std::size_t index) const {
+  this->refresh_layout();
+  if (this->layout_canonical) {
+    return (index < this->seq.size()) ? index * 3 : this->layout_bases;
+  }
+  std::size_t bases{0};
+  for (std::size_t idx{std::min(index, this->seq.size())}; idx;
+       idx &= idx - 1) {
+    bases += this->layout_tree[idx];
+  }
+  return bases;
+}
+
+codon::CapacityPolicy::CapacityPolicy(std::size_t reserve_codons,
+                                      double growth_factor)
+    : reserve_codons{reserve_codons}, growth_factor{growth_factor} {
+  if (!(growth_factor >= 1.0)) {
+    throw std::invalid_argument(
+        "CapacityPolicy expects a growth factor of at least 1.0 but received " +
+        std::to_string(growth_factor) + ".");
+  }
+}
+
+codon::CapacityPolicy codon::CapacityPolicy::exact() {
+  return codon::CapacityPolicy(0, 1.0);
+}
+
+codon::CapacityPolicy codon::CapacityPolicy::growth(double growth_factor) {
+  return codon::CapacityPolicy(0, growth_factor);
+}
+
+codon::CapacityPolicy codon::CapacityPolicy::reserve(std::size_t codons) {
+  return codon::CapacityPolicy(codons, 1.0);
+}
@@ -0,0 +1,133 @@
+#include "seq.h"
+
+#include <plog/Log.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "codon.h"
+
+namespace {
+
+// drops every base outside of the 1-based positions from..to
+codon::Codon clip_codon(codon::Codon codon_copy, int from, int to) {
+  while (codon_copy.get_bases_len() > to) codon_copy.pop();
+  for (int i{1}; i < from; ++i) codon_copy.pop(1);
+  return codon_copy;
+}
+
+}  // namespace
+
+codon::SeqView::SeqView(const codon::Seq& parent, codon::locator first,
+                        codon::locator last)
+    : parent{&parent}, first{first}, last{last} {
+  this->first.verify_shift();
+  this->last.verify_shift();
+  for (const codon::locator& border : {this->first, this->last}) {
+    if (border.index >= parent.seq.size() ||
+        border.shift > parent.seq[border.index].get_bases_len()) {
+      throw std::invalid_argument(
+          "Passed codon::locator to SeqView is outside of valid range.");
+    }
+  }
+  if (this->first > this->last) {
+    throw std::invalid_argument(
+        "SeqView expects the first locator to be in front of the last one.");
+  }
+  PLOGD << "Created SeqView from " << this->first.index << ":"
+        << this->first.shift << " to " << this->last.index << ":"
+        << this->last.shift;
+}
+
+std::string codon::SeqView::get_seq_str() const {
+  std::string annealed_str;
+  annealed_str.reserve(this->get_seq_len() * 3);
+  for (codon::base curr_base : this->bases()) {
+    annealed_str.push_back(codon::base_to_str(curr_base));
+  }
+  return annealed_str;
+}
+
+std::vector<std::bitset<8>> codon::SeqView::get_seq_bin() const {
+  std::vector<std::bitset<8>> arr_bin;
+  arr_bin.reserve(this->get_seq_len());
+  for (std::size_t idx{this->first.index}; idx <= this->last.index; ++idx) {
+    int from = (idx == this->first.index) ? this->first.shift : 1;
+    int to = (idx == this->last.index) ? this->last.shift : 3;
+    arr_bin.push_back(
+        clip_codon(this->parent->seq[idx], from, to).get_bases_bin());
+  }
+  return arr_bin;
+}
+
+codon::Codon codon::SeqView::get_codon_at(
+    const codon::locator& locator) const {
+  if (!this->is_locator_valid(locator)) {
+    throw std::invalid_argument(
+        "Passed codon::locator to SeqView::get_codon_at is outside of the "
+        "view.");
+  }
+  int to = (locator.index == this->last.index) ? this->last.shift : 3;
+  return clip_codon(this->parent->seq[locator.index], locator.shift, to);
+}
+
+std::size_t codon::SeqView::get_seq_len() const {
+  // amount of parent codons the view touches, including clipped ones
+  return this->last.index - this->first.index + 1;
+}
+
+std::size_t codon::SeqView::get_seq_trulen(std::string how) const {
+  if (how == "codons") return this->get_seq_len();
+  if (how != "bp" && how != "bases") {
+    std::string message = "Expected 'codons', 'bp' or 'bases' but received ";
+    message += how;
+    throw std::invalid_argument(message);
+  }
+  if (this->first.index == this->last.index)
+    return this->last.shift - this->first.shift + 1;
+
+  std::size_t bases = this->parent->seq[this->first.index].get_bases_len() -
+                      this->first.shift + 1 + this->last.shift;
+  for (std::size_t idx{this->first.index + 1}; idx < this->last.index; ++idx) {
+    bases += this->parent->seq[idx].get_bases_len();
+  }
+  return bases;
+}
+
+codon::base_range codon::SeqView::bases() const {
+  const codon::Codon* data = this->parent->seq.data();
+  const codon::Codon* limit = data + this->last.index + 1;
+  return codon::base_range(
+      codon::base_iterator(data + this->first.index, limit, this->first.shift),
+      codon::base_iterator(data + this->last.index, limit,
+                           this->last.shift + 1));
+}
+
+codon::kmer_range codon::SeqView::kmers(int k, bool use_canonical) const {
+  if (k < 1 || k > 32) {
+    throw std::invalid_argument("Expected k between 1 and 32 but received " +
+                                std::to_string(k) + ".");
+  }
+  codon::base_range range{this->bases()};
+  return codon::kmer_range(
+      codon::kmer_iterator(range.begin(), range.end(), k, use_canonical),
+      codon::kmer_iterator(range.end(), range.end(), k, use_canonical));
+}
+
+bool codon::SeqView::is_locator_valid(codon::locator locator) const {
+  return (locator >= this->first && locator <= this->last &&
+          locator.shift >= 1 &&
+          locator.shift <=
+              this->parent->seq[locator.index].get_bases_len());
+}
+
+codon::SeqView codon::SeqView::slice(codon::locator first,
+                                     codon::locator last) const {
+  if (!this->is_locator_valid(first) || !this->is_locator_valid(last)) {
+    throw std::invalid_argument(
+        "Passed codon::locator to SeqView::slice is outside of the view.");
+  }
+  return codon::SeqView(*this->parent, first, last);
+}
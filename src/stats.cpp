@@ -0,0 +1,87 @@
+#include "stats.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+namespace {
+
+constexpr std::array<const char*, codon::stats::NUM_COUNTERS> COUNTER_NAMES{
+    "shifted_codons",    "reallocations",   "mid_inserts",
+    "mid_insert_codons", "void_codons",     "first_idx_scans",
+    "last_idx_scans"};
+
+constexpr std::array<const char*, codon::stats::NUM_METHODS> METHOD_NAMES{
+    "insert_base", "insert_codon", "insert_seq",  "pop_base",
+    "pop_codon",   "erase",        "apply_edits", "left_shift",
+    "right_shift", "compact",      "locate",      "offset_of",
+    "get_seq_str", "count_bases"};
+
+}  // namespace
+
+std::array<std::atomic<std::uint64_t>, codon::stats::NUM_COUNTERS>
+    codon::stats::detail::counters{};
+std::array<std::atomic<std::uint64_t>, codon::stats::NUM_METHODS>
+    codon::stats::detail::calls{};
+std::array<std::atomic<std::uint64_t>, codon::stats::NUM_METHODS>
+    codon::stats::detail::nanoseconds{};
+
+codon::stats::Snapshot codon::stats::snapshot() {
+  codon::stats::Snapshot snap;
+  for (std::size_t idx{0}; idx < NUM_COUNTERS; ++idx) {
+    snap.counters[idx] = detail::counters[idx].load(std::memory_order_relaxed);
+  }
+  for (std::size_t idx{0}; idx < NUM_METHODS; ++idx) {
+    snap.methods[idx] = {
+        detail::calls[idx].load(std::memory_order_relaxed),
+        detail::nanoseconds[idx].load(std::memory_order_relaxed)};
+  }
+  return snap;
+}
+
+void codon::stats::reset() {
+  for (std::atomic<std::uint64_t>& curr : detail::counters) curr.store(0);
+  for (std::atomic<std::uint64_t>& curr : detail::calls) curr.store(0);
+  for (std::atomic<std::uint64_t>& curr : detail::nanoseconds) curr.store(0);
+}
+
+codon::stats::Snapshot codon::stats::Snapshot::operator-(
+    const codon::stats::Snapshot& earlier) const {
+  codon::stats::Snapshot delta;
+  for (std::size_t idx{0}; idx < NUM_COUNTERS; ++idx) {
+    delta.counters[idx] = this->counters[idx] - earlier.counters[idx];
+  }
+  for (std::size_t idx{0}; idx < NUM_METHODS; ++idx) {
+    delta.methods[idx] = {
+        this->methods[idx].calls - earlier.methods[idx].calls,
+        this->methods[idx].nanoseconds - earlier.methods[idx].nanoseconds};
+  }
+  return delta;
+}
+
+const char* codon::stats::name(codon::stats::counter which) {
+  return COUNTER_NAMES.at(static_cast<std::size_t>(which));
+}
+
+const char* codon::stats::name(codon::stats::method which) {
+  return METHOD_NAMES.at(static_cast<std::size_t>(which));
+}
+
+std::ostream& codon::stats::operator<<(std::ostream& out,
+                                       const codon::stats::Snapshot& snap) {
+  for (std::size_t idx{0}; idx < NUM_COUNTERS; ++idx) {
+    if (!snap.counters[idx]) continue;
+    out << std::left << std::setw(20) << COUNTER_NAMES[idx] << std::right
+        << snap.counters[idx] << "\n";
+  }
+  for (std::size_t idx{0}; idx < NUM_METHODS; ++idx) {
+    const codon::stats::MethodTiming& timing{snap.methods[idx]};
+    if (!timing.calls) continue;
+    out << std::left << std::setw(20) << METHOD_NAMES[idx] << std::right
+        << timing.calls << " calls, " << timing.nanoseconds << " ns\n";
+  }
+  return out;
+}
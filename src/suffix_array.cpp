@@ -0,0 +1,426 @@
+#include "suffix_array.h"
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fm_index.h"
+#include "mapped_file.h"
+#include "seq.h"
+
+constexpr char SA_MAGIC[8] = {'C', 'O', 'D', 'O', 'N', 'S', 'A', 'L'};
+constexpr std::uint64_t SA_VERSION = 1;
+
+// the terminator never equals any other text symbol in LCP comparisons
+constexpr std::uint8_t TEXT_TERMINATOR = 0xFF;
+
+constexpr int RADIX_BITS = 16;
+constexpr std::size_t RADIX_BUCKETS = std::size_t{1} << RADIX_BITS;
+// below this many suffixes spawning threads costs more than it saves
+constexpr std::size_t PARALLEL_MIN_LEN = 1 << 15;
+
+namespace {
+
+struct sa_header {
+  char magic[8];
+  std::uint64_t version;
+  std::uint64_t text_len;
+  std::uint64_t num_seqs;
+  std::uint64_t has_lcp;
+  std::uint64_t off_starts;
+  std::uint64_t off_sa;
+  std::uint64_t off_lcp;
+};
+
+inline std::size_t align_up(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// count aligned elements of T at byte offset inside image_len bytes
+template <typename T>
+bool section_fits(std::uint64_t offset, std::uint64_t count,
+                  std::size_t image_len) {
+  return offset % alignof(T) == 0 && offset <= image_len &&
+         count <= (image_len - offset) / sizeof(T);
+}
+
+// lexicographic rank of a base, independent of the codon::base encoding
+inline std::uint8_t lex_rank(codon::base base) {
+  switch (base) {
+    case codon::base::A:
+      return 0;
+    case codon::base::C:
+      return 1;
+    case codon::base::G:
+      return 2;
+    case codon::base::T:
+      return 3;
+  }
+  return 3;
+}
+
+inline void chunk_range(std::size_t len, unsigned chunks, unsigned chunk,
+                        std::size_t& begin, std::size_t& end) {
+  std::size_t size = (len + chunks - 1) / chunks;
+  begin = std::min(len, size * chunk);
+  end = std::min(len, begin + size);
+}
+
+/* Runs fn(chunk) for every chunk in [0, threads) with one std::thread per
+ * chunk (the calling thread takes chunk 0).
+ */
+template <typename Fn>
+void run_chunks(unsigned threads, Fn&& fn) {
+  if (threads <= 1) {
+    fn(0u);
+    return;
+  }
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned chunk{1}; chunk < threads; ++chunk) {
+    workers.emplace_back([&fn, chunk]() { fn(chunk); });
+  }
+  fn(0u);
+  for (std::thread& worker : workers) worker.join();
+}
+
+// book-keeping for the memory report in sa_stats
+struct memory_tracker {
+  std::size_t current{0};
+  std::size_t peak{0};
+
+  void add(std::size_t bytes) {
+    this->current += bytes;
+    this->peak = std::max(this->peak, this->current);
+  }
+  void remove(std::size_t bytes) { this->current -= bytes; }
+};
+
+template <typename T>
+void release(std::vector<T>& buffer, memory_tracker& memory) {
+  memory.remove(buffer.capacity() * sizeof(T));
+  std::vector<T>().swap(buffer);
+}
+
+/* Stable parallel LSD radix sort of (key, value) pairs with 16-bit digits.
+ * Every thread histograms and scatters its own contiguous chunk so the
+ * relative order inside a digit bucket is preserved. Digit passes in which
+ * all keys fall into the same bucket are skipped entirely.
+ */
+void radix_sort_pairs(std::vector<std::uint64_t>& keys,
+                      std::vector<std::uint32_t>& values,
+                      std::vector<std::uint64_t>& keys_tmp,
+                      std::vector<std::uint32_t>& values_tmp,
+                      unsigned threads) {
+  const std::size_t len = keys.size();
+  std::vector<std::size_t> histograms(threads * RADIX_BUCKETS);
+
+  for (int shift{0}; shift < 64; shift += RADIX_BITS) {
+    std::fill(histograms.begin(), histograms.end(), 0);
+    run_chunks(threads, [&](unsigned chunk) {
+      std::size_t begin, end;
+      chunk_range(len, threads, chunk, begin, end);
+      std::size_t* histogram = histograms.data() + chunk * RADIX_BUCKETS;
+      for (std::size_t i{begin}; i < end; ++i)
+        ++histogram[(keys[i] >> shift) & (RADIX_BUCKETS - 1)];
+    });
+
+    // exclusive prefix sum over (digit, chunk) turns counts into offsets
+    std::size_t running{0};
+    bool single_bucket{false};
+    for (std::size_t digit{0}; digit < RADIX_BUCKETS; ++digit) {
+      std::size_t digit_total{0};
+      for (unsigned chunk{0}; chunk < threads; ++chunk) {
+        std::size_t& slot = histograms[chunk * RADIX_BUCKETS + digit];
+        std::size_t count = slot;
+        slot = running;
+        running += count;
+        digit_total += count;
+      }
+      if (digit_total == len) single_bucket = true;
+    }
+    if (single_bucket) continue;
+
+    run_chunks(threads, [&](unsigned chunk) {
+      std::size_t begin, end;
+      chunk_range(len, threads, chunk, begin, end);
+      std::size_t* offsets = histograms.data() + chunk * RADIX_BUCKETS;
+      for (std::size_t i{begin}; i < end; ++i) {
+        std::size_t digit = (keys[i] >> shift) & (RADIX_BUCKETS - 1);
+        std::size_t target = offsets[digit]++;
+        keys_tmp[target] = keys[i];
+        values_tmp[target] = values[i];
+      }
+    });
+    keys.swap(keys_tmp);
+    values.swap(values_tmp);
+  }
+}
+
+}  // namespace
+
+codon::index::SuffixArray::SuffixArray(const std::vector<codon::Seq>& seqs,
+                                       codon::index::sa_options options) {
+  auto time_start = std::chrono::steady_clock::now();
+  memory_tracker memory;
+
+  // STEP 1 BUILD THE TEXT (one byte per base, terminator per sequence)
+  std::vector<std::uint64_t> starts;
+  starts.reserve(seqs.size() + 1);
+  std::vector<std::uint8_t> text;
+  for (const codon::Seq& curr_seq : seqs) {
+    starts.push_back(text.size());
+    for (codon::base base : curr_seq.bases()) text.push_back(lex_rank(base));
+    text.push_back(TEXT_TERMINATOR);
+  }
+  starts.push_back(text.size());
+  const std::size_t n = text.size();
+  if (n >= std::numeric_limits<std::uint32_t>::max()) {
+    throw std::length_error(
+        "SuffixArray supports at most 2^32 - 1 bases and separators.");
+  }
+  memory.add(text.capacity() + starts.capacity() * sizeof(std::uint64_t));
+
+  unsigned threads = options.threads;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if (n < PARALLEL_MIN_LEN) threads = 1;
+  this->stats.threads = threads;
+
+  PLOGD << "Building SuffixArray over " << seqs.size() << " sequences (" << n
+        << " symbols) with " << threads << " threads";
+
+  // STEP 2 PREFIX DOUBLING
+  // initial ranks: separators by sequence id, bases after all separators
+  const std::uint64_t num_seqs = seqs.size();
+  std::vector<std::uint32_t> rank(n);
+  std::vector<std::uint32_t> order(n);
+  std::vector<std::uint32_t> order_tmp(n);
+  std::vector<std::uint64_t> keys(n);
+  std::vector<std::uint64_t> keys_tmp(n);
+  memory.add(n * (3 * sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t)));
+  {
+    std::size_t seq_id{0};
+    for (std::size_t i{0}; i < n; ++i) {
+      order[i] = static_cast<std::uint32_t>(i);
+      rank[i] = (text[i] == TEXT_TERMINATOR)
+                    ? static_cast<std::uint32_t>(seq_id++)
+                    : static_cast<std::uint32_t>(num_seqs + text[i]);
+    }
+  }
+
+  std::vector<std::size_t> chunk_heads(threads);
+  std::vector<std::size_t> chunk_groups(threads);
+  for (std::size_t h{1}; n > 0; h *= 2) {
+    ++this->stats.rounds;
+    run_chunks(threads, [&](unsigned chunk) {
+      std::size_t begin, end;
+      chunk_range(n, threads, chunk, begin, end);
+      for (std::size_t i{begin}; i < end; ++i) {
+        std::size_t pos = order[i];
+        std::uint64_t second = (pos + h < n) ? rank[pos + h] + 1ULL : 0;
+        keys[i] = static_cast<std::uint64_t>(rank[pos]) << 32 | second;
+      }
+    });
+    radix_sort_pairs(keys, order, keys_tmp, order_tmp, threads);
+
+    /* New rank of a suffix = position of the first suffix with the same
+     * key. Pass one finds the last group head of every chunk, pass two
+     * writes the ranks with the head carried over from previous chunks.
+     */
+    run_chunks(threads, [&](unsigned chunk) {
+      std::size_t begin, end;
+      chunk_range(n, threads, chunk, begin, end);
+      std::size_t head{0};
+      std::size_t groups{0};
+      for (std::size_t i{begin}; i < end; ++i) {
+        if (i == 0 || keys[i] != keys[i - 1]) {
+          head = i;
+          ++groups;
+        }
+      }
+      chunk_heads[chunk] = head;
+      chunk_groups[chunk] = groups;
+    });
+    std::size_t distinct{0};
+    for (std::size_t groups : chunk_groups) distinct += groups;
+
+    run_chunks(threads, [&](unsigned chunk) {
+      std::size_t begin, end;
+      chunk_range(n, threads, chunk, begin, end);
+      std::size_t head{0};
+      for (unsigned prev{0}; prev < chunk; ++prev) {
+        std::size_t prev_begin, prev_end;
+        chunk_range(n, threads, prev, prev_begin, prev_end);
+        if (prev_begin < prev_end) head = std::max(head, chunk_heads[prev]);
+      }
+      for (std::size_t i{begin}; i < end; ++i) {
+        if (i == 0 || keys[i] != keys[i - 1]) head = i;
+        rank[order[i]] = static_cast<std::uint32_t>(head);
+      }
+    });
+
+    PLOGD << "Prefix doubling round " << this->stats.rounds << " (h = " << h
+          << "): " << distinct << " of " << n << " suffixes distinct";
+    if (distinct == n) break;
+  }
+  release(keys, memory);
+  release(keys_tmp, memory);
+
+  // STEP 3 LCP VIA PHI / PLCP IN INDEPENDENT TEXT CHUNKS
+  std::vector<std::uint32_t> lcp_values;
+  if (options.with_lcp && n > 0) {
+    std::vector<std::uint32_t>& phi = order_tmp;
+    std::vector<std::uint32_t>& plcp = rank;
+    run_chunks(threads, [&](unsigned chunk) {
+      std::size_t begin, end;
+      chunk_range(n, threads, chunk, begin, end);
+      for (std::size_t i{begin}; i < end; ++i)
+        phi[order[i]] = (i == 0) ? order[0] : order[i - 1];
+    });
+    run_chunks(threads, [&](unsigned chunk) {
+      std::size_t begin, end;
+      chunk_range(n, threads, chunk, begin, end);
+      std::size_t matched{0};
+      for (std::size_t pos{begin}; pos < end; ++pos) {
+        std::size_t other = phi[pos];
+        if (other == pos) {  // smallest suffix
+          plcp[pos] = 0;
+          matched = 0;
+          continue;
+        }
+        while (pos + matched < n && other + matched < n &&
+               text[pos + matched] == text[other + matched] &&
+               text[pos + matched] != TEXT_TERMINATOR) {
+          ++matched;
+        }
+        plcp[pos] = static_cast<std::uint32_t>(matched);
+        if (matched > 0) --matched;
+      }
+    });
+    lcp_values.resize(n);
+    memory.add(n * sizeof(std::uint32_t));
+    run_chunks(threads, [&](unsigned chunk) {
+      std::size_t begin, end;
+      chunk_range(n, threads, chunk, begin, end);
+      for (std::size_t i{begin}; i < end; ++i)
+        lcp_values[i] = (i == 0) ? 0 : plcp[order[i]];
+    });
+  }
+  release(rank, memory);
+  release(order_tmp, memory);
+  release(text, memory);
+
+  // STEP 4 WRITE THE IMAGE
+  bool has_lcp = options.with_lcp && n > 0;
+  std::size_t off_starts = align_up(sizeof(sa_header), 64);
+  std::size_t off_sa =
+      align_up(off_starts + starts.size() * sizeof(std::uint64_t), 64);
+  std::size_t off_lcp = align_up(off_sa + n * sizeof(std::uint32_t), 64);
+  std::size_t total =
+      (has_lcp) ? off_lcp + n * sizeof(std::uint32_t) : off_lcp;
+
+  this->owned_image.assign(align_up(total, 8) / 8, 0);
+  memory.add(this->owned_image.size() * sizeof(std::uint64_t));
+  std::uint8_t* bytes =
+      reinterpret_cast<std::uint8_t*>(this->owned_image.data());
+  sa_header* header = reinterpret_cast<sa_header*>(bytes);
+  std::memcpy(header->magic, SA_MAGIC, sizeof(SA_MAGIC));
+  header->version = SA_VERSION;
+  header->text_len = n;
+  header->num_seqs = num_seqs;
+  header->has_lcp = has_lcp;
+  header->off_starts = off_starts;
+  header->off_sa = off_sa;
+  header->off_lcp = off_lcp;
+  std::memcpy(bytes + off_starts, starts.data(),
+              starts.size() * sizeof(std::uint64_t));
+  std::memcpy(bytes + off_sa, order.data(), n * sizeof(std::uint32_t));
+  if (has_lcp)
+    std::memcpy(bytes + off_lcp, lcp_values.data(), n * sizeof(std::uint32_t));
+
+  this->attach(bytes, this->owned_image.size() * sizeof(std::uint64_t));
+
+  this->stats.peak_bytes = memory.peak;
+  this->stats.build_seconds = std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - time_start)
+                                  .count();
+  PLOGD << "SuffixArray built in " << this->stats.build_seconds << "s, peak "
+        << this->stats.peak_bytes << " bytes";
+}
+
+codon::index::SuffixArray::~SuffixArray() = default;
+
+void codon::index::SuffixArray::attach(const std::uint8_t* image,
+                                       std::size_t image_len) {
+  if (image_len < sizeof(sa_header))
+    throw std::runtime_error("SuffixArray image is too small for a header.");
+  const sa_header* header = reinterpret_cast<const sa_header*>(image);
+  if (std::memcmp(header->magic, SA_MAGIC, sizeof(SA_MAGIC)) != 0 ||
+      header->version != SA_VERSION) {
+    throw std::runtime_error("SuffixArray image has an unknown format.");
+  }
+  // header fields of a corrupt file can be anything, so no sums or products
+  if (header->has_lcp > 1 ||
+      header->num_seqs >= std::numeric_limits<std::uint64_t>::max() ||
+      !section_fits<std::uint64_t>(header->off_starts, header->num_seqs + 1,
+                                   image_len) ||
+      !section_fits<std::uint32_t>(header->off_sa, header->text_len,
+                                   image_len) ||
+      (header->has_lcp &&
+       !section_fits<std::uint32_t>(header->off_lcp, header->text_len,
+                                    image_len))) {
+    throw std::runtime_error("SuffixArray image is truncated or corrupted.");
+  }
+
+  this->image = image;
+  this->image_len = image_len;
+  this->text_len = header->text_len;
+  this->num_seqs = header->num_seqs;
+  this->seq_starts =
+      reinterpret_cast<const std::uint64_t*>(image + header->off_starts);
+  this->sa = reinterpret_cast<const std::uint32_t*>(image + header->off_sa);
+  this->lcp = (header->has_lcp) ? reinterpret_cast<const std::uint32_t*>(
+                                      image + header->off_lcp)
+                                : nullptr;
+  this->stats.image_bytes = image_len;
+}
+
+codon::index::SuffixArray codon::index::SuffixArray::load(
+    const std::string& path) {
+  SuffixArray suffix_array;
+  suffix_array.mapped_image = std::make_unique<codon::io::MappedFile>(path);
+  suffix_array.attach(suffix_array.mapped_image->data(),
+                      suffix_array.mapped_image->size());
+  return suffix_array;
+}
+
+void codon::index::SuffixArray::save(const std::string& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) throw std::runtime_error("Could not open '" + path + "'.");
+  file.write(reinterpret_cast<const char*>(this->image),
+             static_cast<std::streamsize>(this->image_len));
+  if (!file) throw std::runtime_error("Could not write '" + path + "'.");
+}
+
+codon::index::hit codon::index::SuffixArray::get_hit(
+    std::size_t text_pos) const {
+  if (text_pos >= this->text_len)
+    throw std::out_of_range("SuffixArray::get_hit() beyond end of text.");
+  const std::uint64_t* starts_end = this->seq_starts + this->num_seqs;
+  std::size_t seq_id = static_cast<std::size_t>(
+      std::upper_bound(this->seq_starts, starts_end, text_pos) -
+      this->seq_starts - 1);
+  return codon::index::hit{seq_id, text_pos - this->seq_starts[seq_id]};
+}
@@ -0,0 +1,157 @@
+#include "translate.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "codon.h"
+#include "parallel.h"
+#include "seq.h"
+#include "wild_seq.h"
+
+namespace {
+
+// NCBI table 1 with every position in T, C, A, G order
+constexpr char TCAG_TABLE[] =
+    "FFLLSSSSYY**CC*WLLLLPPPPHHQQRRRRIIIMTTTTNNKKSSRRVVVVAAAADDEEGGGG";
+
+constexpr int tcag_index(int base) {
+  // codon::base is A = 0, G = 1, C = 2, T = 3
+  constexpr int ORDER[4] = {2, 3, 1, 0};
+  return ORDER[base];
+}
+
+// indexed by the 6-bit payload of a full codon, first base highest
+constexpr std::array<char, 64> make_table() {
+  std::array<char, 64> table{};
+  for (int payload{0}; payload < 64; ++payload) {
+    table[payload] = TCAG_TABLE[16 * tcag_index((payload >> 4) & 3) +
+                                4 * tcag_index((payload >> 2) & 3) +
+                                tcag_index(payload & 3)];
+  }
+  return table;
+}
+
+constexpr std::array<char, 64> AMINO_ACIDS{make_table()};
+
+inline char lookup(int payload) { return AMINO_ACIDS[payload & 0x3F]; }
+
+/* fills the amino acids whose first base lies in codons [first, last),
+ * reading on into the codons behind last for a triplet that straddles it
+ */
+void translate_block(const codon::Seq& seq, const codon::Codon* codons,
+                     const codon::Codon* codons_end, std::size_t offset,
+                     std::size_t first, std::size_t last,
+                     std::string& protein) {
+  std::size_t start{seq.bases_before(offset + first)};
+  std::size_t next{(start + 2) / 3};
+  std::size_t stop{std::min((seq.bases_before(offset + last) + 2) / 3,
+                            protein.size())};
+  int skip = static_cast<int>(next * 3 - start);
+  int payload{0};
+  int filled{0};
+  for (const codon::Codon* curr{codons + first};
+       curr != codons_end && next < stop; ++curr) {
+    int bits = curr->get_bases_int();
+    for (int pos{curr->get_bases_len() - 1}; pos >= 0 && next < stop;
+         --pos) {
+      if (skip) {
+        --skip;
+        continue;
+      }
+      payload = (payload << 2) | ((bits >> (2 * pos)) & 3);
+      if (++filled == 3) {
+        protein[next++] = lookup(payload);
+        payload = 0;
+        filled = 0;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+char codon::translate_codon(const codon::Codon& codon) {
+  if (!codon.is_full()) {
+    throw std::invalid_argument(
+        "translate_codon expects a full codon but received " +
+        std::to_string(codon.get_bases_len()) + " bases.");
+  }
+  return lookup(codon.get_bases_int());
+}
+
+std::string codon::translate(const codon::Seq& seq) {
+  // storage positions, codon_iterator would skip interior VOIDs
+  const codon::Codon* codons{seq.begin().get_codon()};
+  const codon::Codon* codons_end{seq.end().get_codon()};
+  std::size_t count = codons_end - codons;
+  if (count == 0) return std::string();
+  std::size_t offset{seq.get_first_idx()};
+  // builds the layout before the fan-out, the blocks only read it
+  bool canonical{seq.is_canonical()};
+
+  // sized once from the layout, so blocks write their amino acids in place
+  std::string protein(seq.bases_before(seq.get_seq_len()) / 3, '*');
+  codon::parallel::for_each_block(
+      count, codon::parallel::MIN_BLOCK_CODONS,
+      [&](std::size_t first, std::size_t last) {
+        if (!canonical) {
+          translate_block(seq, codons, codons_end, offset, first, last,
+                          protein);
+          return;
+        }
+        // full codons from the start, only the last one may be partial
+        for (std::size_t idx{first}; idx < last; ++idx) {
+          if (codons[idx].is_full())
+            protein[idx] = lookup(codons[idx].get_bases_int());
+        }
+      });
+  return protein;
+}
+
+char codon::translate_codon(const codon::WildCodon& codon) {
+  if (!codon.is_full()) {
+    throw std::invalid_argument(
+        "translate_codon expects a full codon but received " +
+        std::to_string(codon.get_bases_len()) + " bases.");
+  }
+  if (!codon.is_wild()) return lookup(codon.to_codon().get_bases_int());
+  if (codon.get_bases_str() == "---") return '-';
+
+  // every base of the mask at each position, at most 4 * 4 * 4 codons
+  char amino_acid{0};
+  for (int first{0}; first < 4; ++first) {
+    if (!(codon.get_mask_at(1) & (1 << first))) continue;
+    for (int second{0}; second < 4; ++second) {
+      if (!(codon.get_mask_at(2) & (1 << second))) continue;
+      for (int third{0}; third < 4; ++third) {
+        if (!(codon.get_mask_at(3) & (1 << third))) continue;
+        char curr = lookup((first << 4) | (second << 2) | third);
+        if (amino_acid && curr != amino_acid) return 'X';
+        amino_acid = curr;
+      }
+    }
+  }
+  // no expansion at all, a gap next to bases
+  return amino_acid ? amino_acid : 'X';
+}
+
+std::string codon::translate(const codon::WildSeq& seq) {
+  std::string protein{codon::translate(seq.get_seq())};
+  for (const codon::wild_run& run : seq.get_runs()) {
+    std::size_t run_end{run.first + run.length};
+    std::size_t last{std::min((run_end + 2) / 3, protein.size())};
+    // codons inside the run all read the same, only its edges mix
+    char inside{codon::translate_codon(
+        codon::WildCodon(std::string(3, run.symbol)))};
+    for (std::size_t idx{run.first / 3}; idx < last; ++idx) {
+      bool is_inside{3 * idx >= run.first && 3 * idx + 3 <= run_end};
+      protein[idx] =
+          is_inside ? inside : codon::translate_codon(seq.get_codon_at(idx));
+    }
+  }
+  return protein;
+}
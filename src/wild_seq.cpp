@@ -0,0 +1,289 @@
+#include "wild_seq.h"
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "codon.h"
+#include "seq.h"
+
+namespace {
+
+// IUPAC symbol of every mask, bit 1 << codon::base per base
+constexpr char SYMBOL_OF_MASK[] = "-AGRCMSVTWKDYHBN";
+
+constexpr std::array<std::uint8_t, 256> make_mask_table() {
+  std::array<std::uint8_t, 256> table{};
+  for (std::uint8_t& entry : table) entry = codon::INVALID_MASK;
+  for (std::uint8_t mask{0}; mask < 16; ++mask) {
+    char symbol = SYMBOL_OF_MASK[mask];
+    table[static_cast<unsigned char>(symbol)] = mask;
+    if (symbol >= 'A' && symbol <= 'Z')
+      table[static_cast<unsigned char>(symbol - 'A' + 'a')] = mask;
+  }
+  return table;
+}
+
+constexpr std::array<std::uint8_t, 256> MASK_OF_CHAR{make_mask_table()};
+
+inline std::uint8_t mask_of(char symbol) {
+  return MASK_OF_CHAR[static_cast<unsigned char>(symbol)];
+}
+
+// exactly one base, which excludes gaps and INVALID_MASK
+inline bool is_base(std::uint8_t mask) {
+  return mask != 0 && (mask & (mask - 1)) == 0;
+}
+
+inline std::uint8_t mask_of(codon::base base) {
+  return static_cast<std::uint8_t>(1u << base);
+}
+
+}  // namespace
+
+std::uint8_t codon::iupac_mask(char symbol) { return mask_of(symbol); }
+
+char codon::iupac_symbol(std::uint8_t mask) {
+  if (mask > 0xF) {
+    throw std::invalid_argument(
+        "Expected an IUPAC mask below 16 but received " +
+        std::to_string(mask) + ".");
+  }
+  return SYMBOL_OF_MASK[mask];
+}
+
+codon::WildCodon::WildCodon(const std::string& symbols) {
+  if (symbols.length() > 3) {
+    throw std::invalid_argument(
+        "WildCodon expects up to 3 symbols but received " +
+        std::to_string(symbols.length()) + ".");
+  }
+  for (char symbol : symbols) {
+    std::uint8_t mask{mask_of(symbol)};
+    if (mask == codon::INVALID_MASK) {
+      throw std::invalid_argument(
+          std::string("WildCodon expects IUPAC nucleotide codes but "
+                      "received '") +
+          symbol + "'.");
+    }
+    this->masks[this->len++] = mask;
+  }
+}
+
+codon::WildCodon::WildCodon(const codon::Codon& codon)
+    : len{static_cast<std::uint8_t>(codon.get_bases_len())} {
+  for (int shift{1}; shift <= this->len; ++shift) {
+    this->masks[shift - 1] = mask_of(codon.get_base_at(shift));
+  }
+}
+
+codon::WildCodon codon::WildCodon::from_masks(
+    const std::array<std::uint8_t, 3>& masks, int len) {
+  if (len < 0 || len > 3) {
+    throw std::invalid_argument(
+        "WildCodon expects up to 3 symbols but received " +
+        std::to_string(len) + ".");
+  }
+  codon::WildCodon built{std::string()};
+  for (int idx{0}; idx < len; ++idx) {
+    // validates the mask
+    codon::iupac_symbol(masks[idx]);
+    built.masks[idx] = masks[idx];
+  }
+  built.len = static_cast<std::uint8_t>(len);
+  return built;
+}
+
+bool codon::WildCodon::is_wild() const {
+  for (int idx{0}; idx < this->len; ++idx) {
+    if (!is_base(this->masks[idx])) return true;
+  }
+  return false;
+}
+
+std::string codon::WildCodon::get_bases_str() const {
+  std::string symbols(this->len, 'N');
+  for (int idx{0}; idx < this->len; ++idx) {
+    symbols[idx] = SYMBOL_OF_MASK[this->masks[idx]];
+  }
+  return symbols;
+}
+
+std::uint8_t codon::WildCodon::get_mask_at(int shift) const {
+  if (shift < 1 || shift > this->len) {
+    throw std::invalid_argument(
+        "Expected shift for codon to be between 1 and " +
+        std::to_string(this->len) + " but received " + std::to_string(shift) +
+        ".");
+  }
+  return this->masks[shift - 1];
+}
+
+char codon::WildCodon::get_symbol_at(int shift) const {
+  return SYMBOL_OF_MASK[this->get_mask_at(shift)];
+}
+
+int codon::WildCodon::count_expansions() const {
+  int count{1};
+  for (int idx{0}; idx < this->len; ++idx) {
+    std::uint8_t mask{this->masks[idx]};
+    count *= (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + (mask >> 3);
+  }
+  return count;
+}
+
+bool codon::WildCodon::matches(const codon::Codon& codon) const {
+  if (codon.get_bases_len() != this->len) return false;
+  for (int shift{1}; shift <= this->len; ++shift) {
+    if (!(this->masks[shift - 1] & mask_of(codon.get_base_at(shift))))
+      return false;
+  }
+  return true;
+}
+
+codon::Codon codon::WildCodon::to_codon() const {
+  if (this->is_wild()) {
+    throw std::invalid_argument("WildCodon '" + this->get_bases_str() +
+                                "' stands for more than one Codon.");
+  }
+  return codon::Codon(this->get_bases_str());
+}
+
+codon::WildSeq::WildSeq(std::string_view input,
+                        std::pmr::memory_resource* resource)
+    : seq{std::string(), resource} {
+  this->assign(input);
+}
+
+void codon::WildSeq::assign(std::string_view input) {
+  this->runs.clear();
+  this->length = input.length();
+  this->num_wild = 0;
+
+  // pure A, C, G and T goes to the Seq as is
+  std::size_t pos{0};
+  while (pos < input.length() && is_base(mask_of(input[pos]))) ++pos;
+  if (pos == input.length()) {
+    this->seq.assign(input);
+    return;
+  }
+
+  std::string backbone(input);
+  for (; pos < input.length(); ++pos) {
+    std::uint8_t mask{mask_of(input[pos])};
+    if (is_base(mask)) continue;
+    if (mask == codon::INVALID_MASK) {
+      this->runs.clear();
+      this->length = 0;
+      this->num_wild = 0;
+      this->seq.assign(std::string_view());
+      throw std::invalid_argument(
+          std::string("WildSeq expects IUPAC nucleotide codes but received "
+                      "'") +
+          input[pos] + "'.");
+    }
+    char symbol = SYMBOL_OF_MASK[mask];
+    if (!this->runs.empty() && this->runs.back().symbol == symbol &&
+        this->runs.back().first + this->runs.back().length == pos) {
+      ++this->runs.back().length;
+    } else {
+      this->runs.push_back(codon::wild_run{pos, 1, symbol});
+    }
+    backbone[pos] = 'A';
+    ++this->num_wild;
+  }
+  this->seq.assign(backbone);
+  PLOGD << "WildSeq of " << this->length << " bases with "
+        << this->runs.size() << " ambiguous runs";
+}
+
+std::string codon::WildSeq::get_seq_str() const {
+  std::string seq_str{this->seq.get_seq_str()};
+  for (const codon::wild_run& run : this->runs) {
+    std::fill_n(seq_str.begin() + run.first, run.length, run.symbol);
+  }
+  return seq_str;
+}
+
+std::array<std::size_t, 4> codon::WildSeq::count_bases() const {
+  std::array<std::size_t, 4> counts{this->seq.count_bases()};
+  // every ambiguous position holds an A
+  counts[codon::base::A] -= this->num_wild;
+  return counts;
+}
+
+std::vector<codon::wild_run>::const_iterator codon::WildSeq::run_after(
+    std::size_t pos) const {
+  return std::upper_bound(this->runs.begin(), this->runs.end(), pos,
+                          [](std::size_t curr, const codon::wild_run& run) {
+                            return curr < run.first + run.length;
+                          });
+}
+
+char codon::WildSeq::get_symbol_at(std::size_t pos) const {
+  if (pos >= this->length) {
+    throw std::out_of_range("WildSeq::get_symbol_at() beyond end of sequence.");
+  }
+  auto run = this->run_after(pos);
+  if (run != this->runs.end() && run->first <= pos) return run->symbol;
+  // get_codon_at() would cut the codon at the shift, so read all of it
+  codon::locator locator{this->seq.locate(pos)};
+  return codon::base_to_str(
+      this->seq.get_codon_at(codon::locator(locator.index, 1))
+          .get_base_at(locator.shift));
+}
+
+codon::WildCodon codon::WildSeq::get_codon_at(std::size_t index) const {
+  std::size_t first{3 * index};
+  if (first >= this->length) {
+    throw std::out_of_range("WildSeq::get_codon_at() beyond end of sequence.");
+  }
+  std::size_t last{std::min(first + 3, this->length)};
+  codon::WildCodon placeholders{
+      this->seq.get_codon_at(this->seq.locate(first))};
+  std::array<std::uint8_t, 3> masks{};
+  for (int shift{1}; shift <= placeholders.get_bases_len(); ++shift) {
+    masks[shift - 1] = placeholders.get_mask_at(shift);
+  }
+  for (auto run = this->run_after(first);
+       run != this->runs.end() && run->first < last; ++run) {
+    std::size_t from{std::max(first, run->first)};
+    std::size_t to{std::min(last, run->first + run->length)};
+    for (std::size_t pos{from}; pos < to; ++pos) {
+      masks[pos - first] = mask_of(run->symbol);
+    }
+  }
+  return codon::WildCodon::from_masks(masks, static_cast<int>(last - first));
+}
+
+bool codon::WildSeq::is_pure(std::size_t first, std::size_t last) const {
+  if (first >= last) return true;
+  auto run = this->run_after(first);
+  return run == this->runs.end() || run->first >= last;
+}
+
+std::vector<codon::SeqView> codon::WildSeq::pure_slices(
+    std::size_t min_bases) const {
+  min_bases = std::max<std::size_t>(min_bases, 1);
+  std::vector<codon::SeqView> slices;
+  std::size_t start{0};
+  auto add_slice = [&](std::size_t end) {
+    if (end - start < min_bases) return;
+    slices.push_back(
+        this->seq.slice(this->seq.locate(start), this->seq.locate(end - 1)));
+  };
+  for (const codon::wild_run& run : this->runs) {
+    add_slice(run.first);
+    start = run.first + run.length;
+  }
+  add_slice(this->length);
+  return slices;
+}
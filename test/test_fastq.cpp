@@ -0,0 +1,106 @@
+#include <plog/Log.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fastq.h"
+#include "random.h"
+#include "seq.h"
+#include "testing.h"
+
+int test::fastq_test() {
+  codon::Seq seq{std::string()};
+  seq.assign("acgTTGa");
+  REQUIRE(seq.get_seq_str() == "ACGTTGA");
+  REQUIRE_THROWS_AS(seq.assign("ACGN"), std::invalid_argument);
+  REQUIRE(seq.get_seq_str().empty());
+
+  check_fastq_parsing();
+  PLOGD << "FASTQ parsing passed";
+
+  std::ostringstream fastq;
+  std::vector<std::string> names;
+  std::vector<std::string> bases;
+  std::vector<std::string> qualities;
+  for (int idx{0}; idx < 300; ++idx) {
+    names.push_back("read_" + std::to_string(idx) + " lane=1");
+    // the first batch holds the longest reads, later ones fit its storage
+    bases.push_back(
+        test::random_bases((idx < 32) ? 250 : randomiser::get_int(100, 250)));
+    std::string curr_qualities;
+    for (std::size_t pos{0}; pos < bases.back().length(); ++pos) {
+      curr_qualities.push_back(static_cast<char>(randomiser::get_int(33, 74)));
+    }
+    qualities.push_back(curr_qualities);
+    fastq << '@' << names.back() << '\n'
+          << bases.back() << "\n+\n"
+          << qualities.back() << '\n';
+  }
+  // buffers smaller than a record make lines cross block boundaries
+  for (std::size_t buffer_bytes : {std::size_t{64}, std::size_t{1000},
+                                   codon::io::FastqReader::DEFAULT_BUFFER}) {
+    check_fastq_stream(fastq.str(), names, bases, qualities, buffer_bytes);
+  }
+  PLOGD << "FASTQ streaming and batches passed";
+  return 0;
+}
+
+void test::check_fastq_parsing() {
+  // multi-line records, CRLF, blank lines and no final line break
+  std::istringstream in(
+      "@r1 first\r\nACGTA\r\nCG\r\n+r1\r\nII#!\r\n~~I\r\n\n@r2\nac\n+\n5?");
+  codon::io::FastqReader reader(in);
+  codon::io::SeqRecord record;
+  REQUIRE(reader.next(record));
+  REQUIRE(record.name == "r1 first");
+  REQUIRE(record.seq.get_seq_str() == "ACGTACG");
+  REQUIRE(record.get_quality_str() == "II#!~~I");
+  REQUIRE(record.qualities[3] == 0);
+  REQUIRE(record.qualities[4] == codon::io::MAX_PHRED);
+  REQUIRE(reader.next(record));
+  REQUIRE(record.seq.get_seq_str() == "AC");
+  REQUIRE(record.mean_quality() == (20.0 + 30.0) / 2);
+  REQUIRE(!reader.next(record));
+  REQUIRE(reader.records_read() == 2);
+
+  for (const char *malformed :
+       {"ACGT\n+\nIIII\n", "@r\nACGT\nIIII\n", "@r\nACGT\n+\nIII\n",
+        "@r\nACNT\n+\nIIII\n", "@r\nACGT\n+\nII I\n"}) {
+    std::istringstream bad_in(malformed);
+    codon::io::FastqReader bad_reader(bad_in);
+    REQUIRE_THROWS_AS(bad_reader.next(record), std::invalid_argument);
+  }
+  REQUIRE_THROWS_AS(codon::io::FastqReader("/nonexistent/reads.fastq"),
+                    std::runtime_error);
+}
+
+void test::check_fastq_stream(const std::string &fastq,
+                              const std::vector<std::string> &names,
+                              const std::vector<std::string> &bases,
+                              const std::vector<std::string> &qualities,
+                              std::size_t buffer_bytes) {
+  std::istringstream in(fastq);
+  codon::io::FastqReader reader(in, buffer_bytes);
+  std::vector<codon::io::SeqRecord> batch;
+  std::size_t idx{0};
+  std::size_t allocations{0};
+  while (std::size_t count{reader.next_batch(batch, 32)}) {
+    REQUIRE(count <= 32);
+    REQUIRE(batch.size() == 32);
+    // refilled records keep their storage once it is large enough
+    if (idx > 0) REQUIRE(allocations == batch[0].seq.get_num_allocations());
+    allocations = batch[0].seq.get_num_allocations();
+    for (std::size_t curr{0}; curr < count; ++curr, ++idx) {
+      REQUIRE(batch[curr].name == names[idx]);
+      REQUIRE(batch[curr].seq.get_seq_str() == bases[idx]);
+      REQUIRE(batch[curr].get_quality_str() == qualities[idx]);
+    }
+  }
+  REQUIRE(idx == names.size());
+  REQUIRE(reader.records_read() == names.size());
+}
@@ -0,0 +1,154 @@
+#include <plog/Log.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fm_index.h"
+#include "random.h"
+#include "seq.h"
+#include "testing.h"
+
+std::string test::random_bases(std::size_t len) {
+  constexpr char BASES[4] = {'A', 'G', 'C', 'T'};
+  std::string bases;
+  bases.reserve(len);
+  for (std::size_t i{0}; i < len; ++i) {
+    bases.push_back(BASES[randomiser::get_int(0, 3)]);
+  }
+  return bases;
+}
+
+int test::fm_index_test() {
+  std::vector<std::string> arr_seq{test::random_bases(1000),
+                                   test::random_bases(77), "ACGTACGTAAAA",
+                                   test::random_bases(2)};
+  std::vector<codon::Seq> vec_seq{seq_build(arr_seq)};
+
+  codon::index::FMIndex fm_index(vec_seq, 4);
+  REQUIRE(fm_index.get_num_seqs() == arr_seq.size());
+  for (std::size_t i{0}; i < arr_seq.size(); ++i) {
+    REQUIRE(fm_index.get_seq_len(i) == arr_seq[i].size());
+  }
+
+  check_fm_index_queries(fm_index, arr_seq);
+  PLOGD << "FMIndex queries passed";
+
+  const std::string path{"codon_test_fm_index.bin"};
+  fm_index.save(path);
+  {
+    codon::index::FMIndex loaded{codon::index::FMIndex::load(path)};
+    REQUIRE(loaded.get_text_len() == fm_index.get_text_len());
+    check_fm_index_queries(loaded, arr_seq);
+  }
+  std::remove(path.c_str());
+  PLOGD << "FMIndex save/load roundtrip passed";
+
+  check_corrupt_fm_index(fm_index);
+  PLOGD << "FMIndex corrupt images rejected";
+
+  codon::index::FMIndex single(codon::Seq("AAAAAA"));
+  REQUIRE(single.count("AA") == 5);
+  REQUIRE(single.count("AAAAAAA") == 0);
+  REQUIRE(single.count("N") == 0);
+  return 0;
+}
+
+void test::check_corrupt_fm_index(const codon::index::FMIndex &fm_index) {
+  const std::string path{"codon_test_fm_index_corrupt.bin"};
+  fm_index.save(path);
+  std::string image;
+  {
+    std::ifstream file(path, std::ios::binary);
+    image.assign(std::istreambuf_iterator<char>(file),
+                 std::istreambuf_iterator<char>());
+  }
+  // writes image with the 64-bit header field at offset replaced, see
+  // fm_header, and cut to image_len bytes
+  auto write_corrupt = [&](std::size_t offset, std::uint64_t value,
+                           std::size_t image_len) {
+    std::string corrupt{image.substr(0, image_len)};
+    std::memcpy(corrupt.data() + offset, &value, sizeof(value));
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(corrupt.data(), static_cast<std::streamsize>(image_len));
+  };
+  auto read_field = [&](std::size_t offset) {
+    std::uint64_t value{0};
+    std::memcpy(&value, image.data() + offset, sizeof(value));
+    return value;
+  };
+  const std::size_t num_seqs{24};
+  const std::size_t sa_rate{32};
+  const std::size_t sentinel_row{40};
+  const std::size_t num_samples{120};
+  const std::size_t off_starts{128};
+  const std::size_t off_occ{136};
+  const std::size_t off_marks{144};
+  const std::size_t off_samples{152};
+  const std::uint64_t image_len{image.size()};
+  const std::uint64_t occ{read_field(off_occ)};
+
+  // sizes that wrap around 2^64 once multiplied by the element size
+  const std::vector<std::pair<std::size_t, std::uint64_t>> fields{
+      {num_seqs, 1ULL << 61},
+      {num_seqs, ~0ULL},
+      {num_samples, 1ULL << 61},
+      {sa_rate, 0},
+      {sentinel_row, fm_index.get_text_len()},
+      {off_starts, image_len - 8},
+      {off_starts, ~0ULL - 7},
+      {off_occ, occ + 8},
+      {off_marks, image_len - 16},
+      {off_marks, occ + 4},
+      {off_samples, 1ULL << 63},
+      {off_samples, image_len}};
+  for (const auto &[offset, value] : fields) {
+    write_corrupt(offset, value, image.size());
+    REQUIRE_THROWS_AS(codon::index::FMIndex::load(path), std::runtime_error);
+  }
+  write_corrupt(num_seqs, read_field(num_seqs), image.size() - 64);
+  REQUIRE_THROWS_AS(codon::index::FMIndex::load(path), std::runtime_error);
+  write_corrupt(num_seqs, read_field(num_seqs), image.size());
+  REQUIRE(codon::index::FMIndex::load(path).get_num_seqs() ==
+          fm_index.get_num_seqs());
+  std::remove(path.c_str());
+}
+
+void test::check_fm_index_queries(const codon::index::FMIndex &fm_index,
+                                  const std::vector<std::string> &arr_seq) {
+  std::vector<std::string> patterns{"A", "GA", "ACG", "TTT", "ACGTACGT"};
+  for (int i{0}; i < 20; ++i) {
+    const std::string &source = arr_seq[0];
+    std::size_t len = randomiser::get_int(1, 12);
+    std::size_t start = randomiser::get_int(0, source.size() - len);
+    patterns.emplace_back(source.substr(start, len));
+  }
+
+  for (const std::string &pattern : patterns) {
+    std::vector<codon::index::hit> expected;
+    for (std::size_t seq_id{0}; seq_id < arr_seq.size(); ++seq_id) {
+      std::size_t pos = arr_seq[seq_id].find(pattern);
+      while (pos != std::string::npos) {
+        expected.push_back(codon::index::hit{seq_id, pos});
+        pos = arr_seq[seq_id].find(pattern, pos + 1);
+      }
+    }
+
+    REQUIRE(fm_index.count(pattern) == expected.size());
+    REQUIRE(fm_index.count(codon::Seq(pattern)) == expected.size());
+    std::vector<codon::index::hit> hits{fm_index.locate(pattern)};
+    REQUIRE(hits.size() == expected.size());
+    for (std::size_t i{0}; i < hits.size(); ++i) {
+      REQUIRE(hits[i].seq_id == expected[i].seq_id);
+      REQUIRE(hits[i].offset == expected[i].offset);
+    }
+  }
+}
@@ -0,0 +1,216 @@
+#include <plog/Log.h>
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fastq.h"
+#include "gzip.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "testing.h"
+
+#if CODON_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+std::string read_all(std::istream& in) {
+  return std::string(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+}
+
+const unsigned char* bytes_of(const std::string& str) {
+  return reinterpret_cast<const unsigned char*>(str.data());
+}
+
+#if CODON_ZLIB
+// a single gzip member as gzip(1) writes it, without the 'BC' field
+std::string gzip_member(const std::string& data) {
+  z_stream stream{};
+  REQUIRE(deflateInit2(&stream, 6, Z_DEFLATED, 16 + MAX_WBITS, 8,
+                       Z_DEFAULT_STRATEGY) == Z_OK);
+  std::string out(deflateBound(&stream, data.length()), '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.length());
+  stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  stream.avail_out = static_cast<uInt>(out.length());
+  REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return out;
+}
+#endif
+
+}  // namespace
+
+int test::gzip_test() {
+  std::string text{"@r1\nACGT\n+\nIIII\n"};
+  REQUIRE(codon::io::detect_compression(bytes_of(text), text.length()) ==
+          codon::io::compression::none);
+  REQUIRE(codon::io::detect_compression(nullptr, 0) ==
+          codon::io::compression::none);
+  {
+    // uncompressed input passes through, also below the header length
+    for (const std::string& plain : {text, std::string("@r"), std::string()}) {
+      std::istringstream in(plain);
+      codon::io::DecompressStreambuf buffer(in);
+      std::istream decompressed(&buffer);
+      REQUIRE(buffer.get_format() == codon::io::compression::none);
+      REQUIRE(read_all(decompressed) == plain);
+    }
+  }
+
+  std::string fastq;
+  for (int idx{0}; idx < 4000; ++idx) {
+    fastq += "@read_" + std::to_string(idx) + '\n' + test::random_bases(150) +
+             "\n+\n" + std::string(150, 'F') + '\n';
+  }
+  if (!codon::io::has_zlib) {
+    REQUIRE_THROWS_AS(codon::io::bgzf_compress(fastq), std::runtime_error);
+    PLOGD << "Built without zlib, skipping decompression";
+    return 0;
+  }
+
+  std::string bgzf{codon::io::bgzf_compress(fastq)};
+  REQUIRE(codon::io::detect_compression(bytes_of(bgzf), bgzf.length()) ==
+          codon::io::compression::bgzf);
+  // the 28 byte end-of-file block bgzip writes as well
+  REQUIRE(bgzf.substr(bgzf.length() - 28, 4) == "\x1f\x8b\x08\x04");
+  for (unsigned threads : {1u, 2u, 3u, 0u}) {
+    check_decompression(bgzf, fastq, codon::io::compression::bgzf, threads);
+  }
+  PLOGD << "BGZF decompression passed";
+
+  check_gzip(fastq);
+  PLOGD << "gzip decompression passed";
+
+  check_corrupt_bgzf(bgzf);
+  PLOGD << "corrupt BGZF detection passed";
+
+  // readers opening a path detect the compression themselves
+  const std::string path{"codon_test_reads.fastq.gz"};
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << bgzf;
+  }
+  {
+    codon::io::FastqReader reader(path, 1000, 2);
+    codon::io::SeqRecord record;
+    std::size_t count{0};
+    while (reader.next(record)) {
+      REQUIRE(record.name == "read_" + std::to_string(count));
+      ++count;
+    }
+    REQUIRE(count == 4000);
+
+    codon::pipeline::Options options;
+    options.threads = 2;
+    options.decompress_threads = 2;
+    std::string written;
+    codon::pipeline::run(
+        path, [](codon::pipeline::Record&& curr) { return curr; },
+        [&](codon::pipeline::Record&& curr) {
+          std::ostringstream out;
+          codon::pipeline::write_record(out, curr);
+          written += out.str();
+        },
+        options);
+    REQUIRE(written == fastq);
+  }
+  std::remove(path.c_str());
+  PLOGD << "compressed FASTQ files passed";
+
+  // readers opened inside shared-pool tasks must not wait on that pool
+  std::vector<std::string> paths;
+  for (int idx{0}; idx < 4; ++idx) {
+    paths.push_back("codon_test_reads_" + std::to_string(idx) + ".fastq.gz");
+    std::ofstream out(paths.back(), std::ios::binary);
+    out << bgzf;
+  }
+  std::atomic<std::size_t> records{0};
+  codon::parallel::for_each_seq(
+      paths,
+      [&](const std::string& curr) {
+        codon::io::FastqReader reader(curr);
+        codon::io::SeqRecord record;
+        while (reader.next(record)) ++records;
+      },
+      0);
+  REQUIRE(records == 4 * 4000);
+  for (const std::string& curr : paths) std::remove(curr.c_str());
+  PLOGD << "compressed FASTQ files inside pool tasks passed";
+  return 0;
+}
+
+void test::check_decompression(const std::string& compressed,
+                               const std::string& expected,
+                               codon::io::compression format,
+                               unsigned threads) {
+  std::istringstream in(compressed);
+  codon::io::DecompressStreambuf buffer(in, threads);
+  std::istream decompressed(&buffer);
+  decompressed.exceptions(std::ios::badbit);
+  REQUIRE(buffer.get_format() == format);
+  REQUIRE(read_all(decompressed) == expected);
+
+  // dropped halfway, the background thread has to stop cleanly
+  std::istringstream again(compressed);
+  codon::io::DecompressStreambuf partial(again, threads);
+  std::istream partial_in(&partial);
+  std::string line;
+  REQUIRE(std::getline(partial_in, line));
+  REQUIRE(line == expected.substr(0, line.length()));
+}
+
+void test::check_gzip(const std::string& data) {
+#if CODON_ZLIB
+  std::string gzip{gzip_member(data)};
+  REQUIRE(codon::io::detect_compression(bytes_of(gzip), gzip.length()) ==
+          codon::io::compression::gzip);
+  for (unsigned threads : {1u, 0u}) {
+    check_decompression(gzip, data, codon::io::compression::gzip, threads);
+  }
+  // concatenated members read as one file, like `cat a.gz b.gz`
+  std::string first{data.substr(0, 1001)};
+  std::string second{data.substr(1001, 5000)};
+  check_decompression(gzip_member(first) + gzip_member(second),
+                      first + second, codon::io::compression::gzip, 0);
+
+  std::istringstream in(gzip.substr(0, gzip.length() / 2));
+  codon::io::DecompressStreambuf buffer(in);
+  std::istream truncated(&buffer);
+  truncated.exceptions(std::ios::badbit);
+  REQUIRE_THROWS_AS(read_all(truncated), std::runtime_error);
+#else
+  (void)data;
+#endif
+}
+
+void test::check_corrupt_bgzf(const std::string& bgzf) {
+  // a flipped data byte in the second block fails its CRC32
+  std::size_t second{(bgzf[16] & 0xff) + ((bgzf[17] & 0xff) << 8) + 1u};
+  std::string flipped{bgzf};
+  flipped[second + 40] ^= 0x01;
+  // cut in the middle of the last data block
+  std::string truncated{bgzf.substr(0, bgzf.length() - 100)};
+
+  for (const std::string& corrupt : {flipped, truncated}) {
+    for (unsigned threads : {1u, 2u}) {
+      std::istringstream in(corrupt);
+      codon::io::DecompressStreambuf buffer(in, threads);
+      std::istream decompressed(&buffer);
+      decompressed.exceptions(std::ios::badbit);
+      REQUIRE_THROWS_AS(read_all(decompressed), std::runtime_error);
+    }
+  }
+}
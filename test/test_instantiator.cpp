@@ -20,3 +20,94 @@ TEST_CASE("seq", "[seq]") {
   SECTION("testing seq.cpp - Seq") { REQUIRE(test::seq_test() == 0); }
   PLOGD << "Passed seq main test";
 }
+
+TEST_CASE("seq_iterator", "[seq]") {
+  SECTION("testing seq.cpp - iterators") {
+    REQUIRE(test::seq_iterator_test() == 0);
+  }
+  PLOGD << "Passed seq subtest iterators";
+}
+
+TEST_CASE("seq_view", "[seq]") {
+  SECTION("testing seq_view.cpp - SeqView") {
+    REQUIRE(test::seq_view_test() == 0);
+  }
+  PLOGD << "Passed seq subtest views";
+}
+
+TEST_CASE("liftover", "[seq]") {
+  SECTION("testing liftover.cpp - LiftoverMap") {
+    REQUIRE(test::liftover_test() == 0);
+  }
+  PLOGD << "Passed liftover test";
+}
+
+TEST_CASE("stats", "[seq]") {
+  SECTION("testing stats.cpp - operation counters") {
+    REQUIRE(test::stats_test() == 0);
+  }
+  PLOGD << "Passed stats test";
+}
+
+TEST_CASE("translate", "[seq]") {
+  SECTION("testing translate.cpp - genetic code") {
+    REQUIRE(test::translate_test() == 0);
+  }
+  PLOGD << "Passed translate test";
+}
+
+TEST_CASE("wild_seq", "[seq]") {
+  SECTION("testing wild_seq.cpp - WildCodon/WildSeq") {
+    REQUIRE(test::wild_seq_test() == 0);
+  }
+  PLOGD << "Passed wild_seq test";
+}
+
+TEST_CASE("parallel", "[parallel]") {
+  SECTION("testing parallel.cpp - ThreadPool/for_each_seq") {
+    REQUIRE(test::parallel_test() == 0);
+  }
+  PLOGD << "Passed parallel test";
+}
+
+TEST_CASE("fastq", "[io]") {
+  SECTION("testing fastq.cpp - FastqReader/SeqRecord") {
+    REQUIRE(test::fastq_test() == 0);
+  }
+  PLOGD << "Passed fastq test";
+}
+
+TEST_CASE("gzip", "[io]") {
+  SECTION("testing gzip.cpp - DecompressStreambuf/InputFile") {
+    REQUIRE(test::gzip_test() == 0);
+  }
+  PLOGD << "Passed gzip test";
+}
+
+TEST_CASE("pipeline", "[parallel]") {
+  SECTION("testing pipeline.cpp - queues/RecordReader/run") {
+    REQUIRE(test::pipeline_test() == 0);
+  }
+  PLOGD << "Passed pipeline test";
+}
+
+TEST_CASE("fm_index", "[index]") {
+  SECTION("testing fm_index.cpp - FMIndex") {
+    REQUIRE(test::fm_index_test() == 0);
+  }
+  PLOGD << "Passed fm_index test";
+}
+
+TEST_CASE("suffix_array", "[index]") {
+  SECTION("testing suffix_array.cpp - SuffixArray") {
+    REQUIRE(test::suffix_array_test() == 0);
+  }
+  PLOGD << "Passed suffix_array test";
+}
+
+TEST_CASE("kmer_filter", "[filter]") {
+  SECTION("testing kmer_filter.cpp - KmerBloom/KmerCuckoo") {
+    REQUIRE(test::kmer_filter_test() == 0);
+  }
+  PLOGD << "Passed kmer_filter test";
+}
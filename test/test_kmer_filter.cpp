@@ -0,0 +1,211 @@
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kmer.h"
+#include "kmer_filter.h"
+#include "random.h"
+#include "seq.h"
+#include "testing.h"
+
+int test::kmer_filter_test() {
+  check_kmer_packing();
+  PLOGD << "K-mer packing passed";
+
+  const std::string reference_str{test::random_bases(20000)};
+  codon::Seq reference(reference_str);
+  std::vector<codon::Seq> host_reads;
+  std::vector<codon::Seq> foreign_reads;
+  for (int i{0}; i < 200; ++i) {
+    std::size_t start = randomiser::get_int(0, reference_str.size() - 150);
+    host_reads.emplace_back(reference_str.substr(start, 150));
+    foreign_reads.emplace_back(test::random_bases(150));
+  }
+
+  codon::filter::KmerBloom bloom(reference_str.size(), 0.01, 25);
+  bloom.insert_seq(reference);
+  check_kmer_filter(bloom, host_reads, foreign_reads);
+
+  codon::filter::KmerBloom bloom_concurrent(reference_str.size(), 0.01, 25);
+  std::vector<std::thread> workers;
+  for (int part{0}; part < 4; ++part) {
+    workers.emplace_back([&, part]() {
+      bloom_concurrent.insert_seq_concurrent(
+          codon::Seq(reference_str.substr(part * 5000, 5000 + 24)));
+    });
+  }
+  for (std::thread &worker : workers) worker.join();
+  check_kmer_filter(bloom_concurrent, host_reads, foreign_reads);
+
+  const std::string path{"codon_test_kmer_filter.bin"};
+  bloom.save(path);
+  codon::filter::KmerBloom bloom_loaded{codon::filter::KmerBloom::load(path)};
+  REQUIRE(bloom_loaded.get_num_hashes() == bloom.get_num_hashes());
+  for (const codon::Seq &read : foreign_reads) {
+    REQUIRE(bloom_loaded.count_hits(read) == bloom.count_hits(read));
+  }
+  PLOGD << "KmerBloom passed";
+
+  codon::filter::KmerCuckoo cuckoo(reference_str.size(), 0.001, 25);
+  REQUIRE(cuckoo.insert_seq(reference) == 0);
+  check_kmer_filter(cuckoo, host_reads, foreign_reads);
+
+  codon::filter::KmerCuckoo cuckoo_concurrent(reference_str.size(), 0.001, 25);
+  workers.clear();
+  for (int part{0}; part < 4; ++part) {
+    workers.emplace_back([&, part]() {
+      cuckoo_concurrent.insert_seq_concurrent(
+          codon::Seq(reference_str.substr(part * 5000, 5000 + 24)));
+    });
+  }
+  for (std::thread &worker : workers) worker.join();
+  REQUIRE(cuckoo_concurrent.get_size() == cuckoo.get_size());
+  check_kmer_filter(cuckoo_concurrent, host_reads, foreign_reads);
+
+  cuckoo.save(path);
+  codon::filter::KmerCuckoo cuckoo_loaded{
+      codon::filter::KmerCuckoo::load(path)};
+  REQUIRE(cuckoo_loaded.get_size() == cuckoo.get_size());
+  check_kmer_filter(cuckoo_loaded, host_reads, foreign_reads);
+  std::remove(path.c_str());
+
+  std::uint64_t kmer{0};
+  codon::kmer::for_each_kmer(host_reads[0], 25, true,
+                             [&](std::uint64_t curr) { kmer = curr; });
+  REQUIRE(cuckoo.contains(kmer));
+  REQUIRE(cuckoo.erase(kmer));
+  REQUIRE_FALSE(cuckoo.erase(kmer));
+
+  // repeats are members once and never fill their buckets
+  codon::filter::KmerCuckoo repeats(100000, 0.001, 31);
+  codon::Seq poly_a(std::string(5000, 'A'));
+  REQUIRE(repeats.insert_seq(poly_a) == 0);
+  REQUIRE(repeats.insert_seq_concurrent(poly_a) == 0);
+  REQUIRE(repeats.get_size() == 1);
+
+  // 16-bit fingerprints cannot get below about 1e-3
+  REQUIRE_THROWS_AS(codon::filter::KmerCuckoo(1000, 1e-5),
+                    std::invalid_argument);
+  check_cuckoo_collision();
+  PLOGD << "KmerCuckoo passed";
+
+  check_corrupt_filters(bloom, cuckoo);
+  PLOGD << "Corrupt filter files passed";
+  return 0;
+}
+
+void test::check_cuckoo_collision() {
+  // a single bucket and 7-bit fingerprints, collisions are easy to find
+  codon::filter::KmerCuckoo cuckoo(1, 0.5, 25);
+  REQUIRE(cuckoo.get_fingerprint_bits() == 7);
+  std::uint64_t first{0};
+  REQUIRE(cuckoo.insert_counted(first));
+  std::uint64_t second{1};
+  while (!cuckoo.contains(second)) ++second;
+
+  // a set insert takes the shared fingerprint as membership
+  REQUIRE(cuckoo.insert(second));
+  REQUIRE(cuckoo.get_size() == 1);
+
+  // counted ones keep their own entries
+  REQUIRE(cuckoo.insert_counted(second));
+  REQUIRE(cuckoo.get_size() == 2);
+  REQUIRE(cuckoo.erase(first));
+  REQUIRE(cuckoo.contains(second));
+  REQUIRE(cuckoo.erase(second));
+  REQUIRE(cuckoo.get_size() == 0);
+
+  // a k-mer inserted twice needs two erases
+  REQUIRE(cuckoo.insert_counted(first));
+  REQUIRE(cuckoo.insert_counted(first));
+  REQUIRE(cuckoo.erase(first));
+  REQUIRE(cuckoo.contains(first));
+  REQUIRE(cuckoo.erase(first));
+  REQUIRE_FALSE(cuckoo.erase(first));
+}
+
+void test::check_corrupt_filters(const codon::filter::KmerBloom &bloom,
+                                 const codon::filter::KmerCuckoo &cuckoo) {
+  const std::string path{"codon_test_kmer_filter_corrupt.bin"};
+  // overwrites the 64-bit header field at offset, see filter_header
+  auto corrupt = [&](std::size_t offset, std::uint64_t value) {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  };
+  const std::size_t parameter{32};
+  const std::size_t num_units{40};
+
+  for (std::uint64_t hashes : {0ULL, 17ULL, ~0ULL}) {
+    bloom.save(path);
+    corrupt(parameter, hashes);
+    REQUIRE_THROWS_AS(codon::filter::KmerBloom::load(path), std::runtime_error);
+  }
+  bloom.save(path);
+  corrupt(num_units, 1ULL << 40);
+  REQUIRE_THROWS_AS(codon::filter::KmerBloom::load(path), std::runtime_error);
+
+  for (std::uint64_t bits : {0ULL, 3ULL, 17ULL, 64ULL}) {
+    cuckoo.save(path);
+    corrupt(parameter, bits);
+    REQUIRE_THROWS_AS(codon::filter::KmerCuckoo::load(path),
+                      std::runtime_error);
+  }
+  cuckoo.save(path);
+  corrupt(num_units, 1ULL << 40);
+  REQUIRE_THROWS_AS(codon::filter::KmerCuckoo::load(path), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+void test::check_kmer_packing() {
+  const std::string bases{"ACGTTGCAAGGC"};
+  std::string reverse{bases.rbegin(), bases.rend()};
+  for (char &character : reverse) {
+    character = (character == 'A')   ? 'T'
+                : (character == 'T') ? 'A'
+                : (character == 'G') ? 'C'
+                                     : 'G';
+  }
+
+  std::vector<std::uint64_t> forward_kmers;
+  std::vector<std::uint64_t> reverse_kmers;
+  codon::kmer::for_each_kmer(bases, 5, false, [&](std::uint64_t kmer) {
+    forward_kmers.push_back(kmer);
+  });
+  codon::kmer::for_each_kmer(reverse, 5, false, [&](std::uint64_t kmer) {
+    reverse_kmers.push_back(kmer);
+  });
+  REQUIRE(forward_kmers.size() == bases.size() - 4);
+  REQUIRE(forward_kmers.size() == reverse_kmers.size());
+  for (std::size_t i{0}; i < forward_kmers.size(); ++i) {
+    REQUIRE(codon::kmer::reverse_complement(forward_kmers[i], 5) ==
+            reverse_kmers[reverse_kmers.size() - 1 - i]);
+  }
+
+  // canonical k-mers of a sequence and its reverse complement agree
+  std::vector<std::uint64_t> canonical_forward;
+  std::vector<std::uint64_t> canonical_reverse;
+  codon::kmer::for_each_kmer(bases, 5, true, [&](std::uint64_t kmer) {
+    canonical_forward.push_back(kmer);
+  });
+  codon::kmer::for_each_kmer(reverse, 5, true, [&](std::uint64_t kmer) {
+    canonical_reverse.push_back(kmer);
+  });
+  std::reverse(canonical_reverse.begin(), canonical_reverse.end());
+  REQUIRE(canonical_forward == canonical_reverse);
+
+  std::size_t count{0};
+  codon::kmer::for_each_kmer("ACGTNACGTA", 4, true,
+                             [&](std::uint64_t) { ++count; });
+  REQUIRE(count == 3);
+  REQUIRE_THROWS(codon::kmer::verify_k(33));
+}
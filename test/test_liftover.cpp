@@ -0,0 +1,119 @@
+#include <plog/Log.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "liftover.h"
+#include "random.h"
+#include "seq.h"
+#include "testing.h"
+
+int test::liftover_test() {
+  for (std::size_t len : {0, 1, 5, 100}) {
+    check_liftover_ops(len, 60);
+  }
+  PLOGD << "LiftoverMap against a model of random operations passed";
+
+  codon::LiftoverMap liftover(9);
+  liftover.record_insert(3, 2);  // ACG++TTGCAT
+  liftover.record_erase(6, 2);   // ACG++T--CAT
+  REQUIRE(liftover.get_new_len() == 9);
+  REQUIRE(liftover.to_edited(2) == std::optional<std::size_t>(2));
+  REQUIRE(liftover.to_edited(3) == std::optional<std::size_t>(5));
+  REQUIRE(liftover.to_edited(4) == std::nullopt);
+  REQUIRE(liftover.to_edited(6) == std::optional<std::size_t>(6));
+  REQUIRE(liftover.to_original(4) == std::nullopt);
+  REQUIRE(liftover.to_original(8) == std::optional<std::size_t>(8));
+  REQUIRE(liftover.to_edited(9) == std::nullopt);
+  REQUIRE_THROWS(liftover.record_insert(10, 1));
+  REQUIRE_THROWS(liftover.record_erase(8, 2));
+  REQUIRE_THROWS(liftover.to_edited(std::vector<std::size_t>{3, 2}));
+
+  check_seq_liftover(test::random_bases(90));
+  PLOGD << "LiftoverMap attached to a Seq passed";
+  return 0;
+}
+
+void test::check_liftover_ops(std::size_t len, int num_ops) {
+  // model: origin of every base in edited order, -1 for inserted bases
+  std::vector<long> origin(len);
+  for (std::size_t pos{0}; pos < len; ++pos) origin[pos] = pos;
+  codon::LiftoverMap liftover(len);
+
+  for (int op{0}; op < num_ops; ++op) {
+    std::size_t offset = randomiser::get_int(0, origin.size());
+    std::size_t amount = randomiser::get_int(1, 5);
+    if (randomiser::get_int(0, 1) || offset == origin.size()) {
+      liftover.record_insert(offset, amount);
+      origin.insert(origin.begin() + offset, amount, -1);
+    } else {
+      if (offset + amount > origin.size()) amount = origin.size() - offset;
+      liftover.record_erase(offset, amount);
+      origin.erase(origin.begin() + offset, origin.begin() + offset + amount);
+    }
+    REQUIRE(liftover.get_new_len() == origin.size());
+  }
+
+  std::vector<std::optional<std::size_t>> expected_edited(len);
+  std::vector<std::optional<std::size_t>> expected_original(origin.size());
+  std::vector<std::size_t> new_offsets(origin.size());
+  for (std::size_t pos{0}; pos < origin.size(); ++pos) {
+    new_offsets[pos] = pos;
+    if (origin[pos] < 0) continue;
+    expected_original[pos] = origin[pos];
+    expected_edited[origin[pos]] = pos;
+  }
+  std::vector<std::size_t> orig_offsets(len);
+  for (std::size_t pos{0}; pos < len; ++pos) {
+    orig_offsets[pos] = pos;
+    REQUIRE(liftover.to_edited(pos) == expected_edited[pos]);
+  }
+  for (std::size_t pos{0}; pos < origin.size(); ++pos) {
+    REQUIRE(liftover.to_original(pos) == expected_original[pos]);
+  }
+  REQUIRE(liftover.to_edited(orig_offsets) == expected_edited);
+  REQUIRE(liftover.to_original(new_offsets) == expected_original);
+  REQUIRE(liftover.get_orig_len() == len);
+}
+
+void test::check_seq_liftover(const std::string &bases_str) {
+  codon::Seq seq(bases_str);
+  codon::LiftoverMap too_short(1);
+  REQUIRE_THROWS(seq.attach_liftover(too_short));
+  codon::LiftoverMap liftover(bases_str.length());
+  seq.attach_liftover(liftover);
+
+  seq.insert_seq(codon::Seq("GATTACA"), codon::locator(4, 2));
+  seq.erase(codon::locator(10, 1), codon::locator(12, 3));
+  seq.pop_base(codon::locator(2, 3));
+  seq.insert_base(codon::base::T, codon::locator(0, 1));
+  seq.insert_codon(codon::Codon("CCG"), codon::locator(20, 2));
+  seq.pop_codon(codon::locator(5, 1), 3);
+  seq.apply_edits({codon::Edit::insertion(codon::locator(1, 1), "AA"),
+                   codon::Edit::deletion(codon::locator(3, 1), 4)});
+  std::string edited{seq.get_seq_str()};
+
+  // copies and detached sequences do not record
+  codon::Seq copy_seq{seq};
+  copy_seq.erase(copy_seq.get_first_loc(), copy_seq.get_last_loc());
+  seq.detach_liftover();
+  seq.pop_base(seq.get_first_loc());
+
+  REQUIRE(liftover.get_new_len() == edited.length());
+  std::size_t mapped{0};
+  for (std::size_t pos{0}; pos < edited.length(); ++pos) {
+    std::optional<std::size_t> orig{liftover.to_original(pos)};
+    if (!orig) continue;
+    ++mapped;
+    REQUIRE(edited[pos] == bases_str[*orig]);
+    REQUIRE(liftover.to_edited(*orig) == std::optional<std::size_t>(pos));
+  }
+  std::size_t kept{0};
+  for (std::size_t pos{0}; pos < bases_str.length(); ++pos) {
+    if (liftover.to_edited(pos)) ++kept;
+  }
+  REQUIRE(mapped == kept);
+}
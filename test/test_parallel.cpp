@@ -0,0 +1,161 @@
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "parallel.h"
+#include "random.h"
+#include "seq.h"
+#include "testing.h"
+#include "translate.h"
+
+int test::parallel_test() {
+  check_chunking();
+  PLOGD << "Chunking by sequence length passed";
+
+  // many short reads next to a single long contig
+  std::vector<std::string> inputs;
+  for (int idx{0}; idx < 200; ++idx) {
+    inputs.push_back(test::random_bases(randomiser::get_int(0, 150)));
+  }
+  inputs.push_back(test::random_bases(20000));
+  for (unsigned threads : {1u, 2u, 4u, 0u}) {
+    check_parallel_ops(inputs, threads);
+  }
+  PLOGD << "Parallel batch operations passed";
+
+  check_large_seq(test::random_bases(3 * CODON_PARALLEL_MIN_CODONS + 2));
+  PLOGD << "Single-sequence operations split into blocks passed";
+
+  codon::parallel::ThreadPool pool(3);
+  REQUIRE(pool.size() == 3);
+  std::vector<codon::Seq> seqs{codon::parallel::parse(inputs, pool.size())};
+  std::atomic<std::size_t> visited{0};
+  codon::parallel::for_each_seq(
+      seqs, [&](const codon::Seq &) { ++visited; }, pool);
+  REQUIRE(visited == seqs.size());
+
+  // the first exception reaches the caller and the pool stays usable
+  REQUIRE_THROWS_AS(codon::parallel::for_each_seq(
+                        seqs,
+                        [](const codon::Seq &seq) {
+                          if (seq.get_seq_len() > 1000)
+                            throw std::invalid_argument("too long");
+                        },
+                        pool),
+                    std::invalid_argument);
+  std::atomic<std::size_t> nested{0};
+  pool.run(8, [&](std::size_t) {
+    pool.run(4, [&](std::size_t) { ++nested; });
+  });
+  REQUIRE(nested == 32);
+  PLOGD << "Thread pool passed";
+  return 0;
+}
+
+void test::check_chunking() {
+  REQUIRE(codon::parallel::detail::make_chunks({}, 4).empty());
+  std::vector<std::size_t> costs(100, 1);
+  costs[40] = 1000;
+  std::vector<codon::parallel::detail::chunk> chunks{
+      codon::parallel::detail::make_chunks(costs, 4)};
+  // consecutive, covering every element once
+  std::size_t next{0};
+  for (const codon::parallel::detail::chunk &curr : chunks) {
+    REQUIRE(curr.first == next);
+    REQUIRE(curr.last > curr.first);
+    next = curr.last;
+    if (curr.first <= 40 && 40 < curr.last) {
+      REQUIRE(curr.first == 40);
+      REQUIRE(curr.last == 41);
+    }
+  }
+  REQUIRE(next == costs.size());
+  // the short elements on either side stay below total / 16 each
+  REQUIRE(chunks.size() == 3);
+  REQUIRE(codon::parallel::detail::make_chunks(
+              std::vector<std::size_t>(100, 1), 4)
+              .size() == 17);
+}
+
+void test::check_parallel_ops(const std::vector<std::string> &inputs,
+                              unsigned threads) {
+  std::vector<codon::Seq> seqs{codon::parallel::parse(inputs, threads)};
+  REQUIRE(seqs.size() == inputs.size());
+  std::size_t gc{0};
+  std::size_t bases{0};
+  std::unordered_map<std::uint64_t, std::uint64_t> kmers;
+  for (std::size_t idx{0}; idx < inputs.size(); ++idx) {
+    REQUIRE(seqs[idx].get_seq_str() == inputs[idx]);
+    for (char curr : inputs[idx]) gc += (curr == 'G' || curr == 'C');
+    std::array<std::size_t, 4> counts{seqs[idx].count_bases()};
+    REQUIRE(counts[codon::base::G] + counts[codon::base::C] ==
+            static_cast<std::size_t>(std::count_if(
+                inputs[idx].begin(), inputs[idx].end(),
+                [](char curr) { return curr == 'G' || curr == 'C'; })));
+    bases += inputs[idx].length();
+    for (std::uint64_t kmer : seqs[idx].kmers(5, true)) ++kmers[kmer];
+  }
+
+  std::vector<std::string> proteins{
+      codon::parallel::translate(seqs, threads)};
+  for (std::size_t idx{0}; idx < seqs.size(); ++idx) {
+    REQUIRE(proteins[idx] == codon::translate(seqs[idx]));
+  }
+  REQUIRE(codon::parallel::count_kmers(seqs, 5, true, threads) == kmers);
+  REQUIRE(codon::parallel::gc_content(seqs, threads) ==
+          static_cast<double>(gc) / bases);
+
+  // reduce runs in range order, so a non-commutative one is deterministic
+  std::string joined{codon::parallel::transform_reduce(
+      inputs, std::string{},
+      [](std::string lhs, const std::string &rhs) { return lhs + rhs; },
+      [](const std::string &input) { return input.substr(0, 1); },
+      threads)};
+  std::string expected;
+  for (const std::string &input : inputs) expected += input.substr(0, 1);
+  REQUIRE(joined == expected);
+}
+
+void test::check_large_seq(const std::string &bases_str) {
+  std::array<std::size_t, 4> expected_counts{};
+  for (char curr : bases_str) {
+    ++expected_counts[codon::Codon(std::string(1, curr)).get_bases_int() & 3];
+  }
+  std::string expected_protein;
+  for (std::size_t idx{0}; idx + 3 <= bases_str.length(); idx += 3) {
+    expected_protein.push_back(
+        codon::translate_codon(codon::Codon(bases_str.substr(idx, 3))));
+  }
+
+  codon::Seq seq(bases_str);
+  REQUIRE(seq.get_seq_len() >= CODON_PARALLEL_MIN_CODONS);
+  REQUIRE(seq.get_seq_str() == bases_str);
+  REQUIRE(seq.count_bases() == expected_counts);
+  REQUIRE(codon::translate(seq) == expected_protein);
+
+  // VOIDs and partial codons shift the output offsets of every block
+  seq.right_shift(0);
+  for (std::size_t pos : {bases_str.length() / 3, bases_str.length() / 2}) {
+    codon::locator middle{seq.locate(pos)};
+    seq.insert_base(codon::base::T, middle);
+    seq.pop_base(middle);
+  }
+  REQUIRE(!seq.is_canonical());
+  REQUIRE(seq.get_seq_str() == bases_str);
+  REQUIRE(seq.count_bases() == expected_counts);
+  REQUIRE(codon::translate(seq) == expected_protein);
+
+  // a serial batch keeps nested single-sequence work on its thread
+  std::vector<codon::Seq> seqs;
+  seqs.push_back(seq);
+  REQUIRE(codon::parallel::translate(seqs, 1).front() == expected_protein);
+}
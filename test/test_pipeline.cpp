@@ -0,0 +1,147 @@
+#include <plog/Log.h>
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pipeline.h"
+#include "queue.h"
+#include "random.h"
+#include "seq.h"
+#include "testing.h"
+
+int test::pipeline_test() {
+  check_queue<codon::queue::SpscQueue<std::size_t>>(1, 1);
+  check_queue<codon::queue::MpmcQueue<std::size_t>>(1, 1);
+  check_queue<codon::queue::MpmcQueue<std::size_t>>(4, 3);
+  PLOGD << "Bounded queues passed";
+
+  check_record_reader();
+  PLOGD << "FASTA/FASTQ record reader passed";
+
+  std::ostringstream fasta;
+  std::ostringstream fastq;
+  for (int idx{0}; idx < 500; ++idx) {
+    std::string bases{test::random_bases(randomiser::get_int(0, 200))};
+    fasta << ">read_" << idx << " sample\n";
+    for (std::size_t pos{0}; pos < bases.length(); pos += 60) {
+      fasta << bases.substr(pos, 60) << '\n';
+    }
+    fastq << "@read_" << idx << '\n'
+          << bases << "\n+\n"
+          << std::string(bases.length(), 'I') << '\n';
+  }
+  for (unsigned threads : {1u, 3u}) {
+    check_pipeline(fasta.str(), threads);
+    check_pipeline(fastq.str(), threads);
+  }
+  PLOGD << "Ordered pipeline passed";
+  return 0;
+}
+
+void test::check_record_reader() {
+  std::istringstream fasta(
+      "\n>first one\nACGT\nacg\r\n>second\n>third\nTTT\n");
+  codon::pipeline::RecordReader fasta_reader(fasta);
+  std::vector<codon::pipeline::RawRecord> batch;
+  REQUIRE(fasta_reader.read_batch(batch, 2) == 2);
+  REQUIRE(batch[0].name == "first one");
+  REQUIRE(batch[0].bases == "ACGTacg");
+  REQUIRE(batch[0].qualities.empty());
+  REQUIRE(batch[1].name == "second");
+  REQUIRE(batch[1].bases.empty());
+  REQUIRE(fasta_reader.read_batch(batch, 2) == 1);
+  REQUIRE(batch[0].name == "third");
+  REQUIRE(fasta_reader.read_batch(batch, 2) == 0);
+
+  codon::pipeline::Record parsed{codon::pipeline::parse_record(batch[0], 7)};
+  REQUIRE(parsed.index == 7);
+  REQUIRE(parsed.seq.get_seq_str() == "TTT");
+
+  // quality lines may start with '@' or '+'
+  std::istringstream fastq("@r1\nACG\nT\n+\n@+I\nI\n@r2\nA\n+r2\n!\n");
+  codon::pipeline::RecordReader fastq_reader(fastq);
+  codon::pipeline::RawRecord record;
+  REQUIRE(fastq_reader.next(record));
+  REQUIRE(record.bases == "ACGT");
+  REQUIRE(record.qualities == "@+II");
+  REQUIRE(fastq_reader.next(record));
+  REQUIRE(record.name == "r2");
+  REQUIRE(record.qualities == "!");
+  REQUIRE(!fastq_reader.next(record));
+
+  std::istringstream truncated("@r1\nACGT\n+\nII\n");
+  codon::pipeline::RecordReader truncated_reader(truncated);
+  REQUIRE_THROWS_AS(truncated_reader.next(record), std::invalid_argument);
+  std::istringstream no_header("ACGT\n");
+  codon::pipeline::RecordReader no_header_reader(no_header);
+  REQUIRE_THROWS_AS(no_header_reader.next(record), std::invalid_argument);
+  codon::pipeline::RawRecord wild{"n", "ACNT", ""};
+  REQUIRE_THROWS_AS(codon::pipeline::parse_record(wild, 0),
+                    std::invalid_argument);
+}
+
+void test::check_pipeline(const std::string &input, unsigned threads) {
+  // serial reference: read, parse and write one record after the other
+  std::istringstream serial_in(input);
+  codon::pipeline::RecordReader reader(serial_in);
+  codon::pipeline::RawRecord raw;
+  std::ostringstream expected;
+  std::size_t num_records{0};
+  while (reader.next(raw)) {
+    codon::pipeline::write_record(
+        expected, codon::pipeline::parse_record(raw, num_records++));
+  }
+
+  // tiny batches and queues so that backpressure and reordering kick in
+  codon::pipeline::Options options;
+  options.threads = threads;
+  options.batch_records = 7;
+  options.queue_batches = 2;
+  std::istringstream in(input);
+  std::ostringstream out;
+  std::size_t next_index{0};
+  codon::pipeline::Summary summary{codon::pipeline::run(
+      in,
+      [](codon::pipeline::Record &&record) {
+        // uneven work per record
+        if (record.index % 13 == 0) std::this_thread::yield();
+        return std::move(record);
+      },
+      [&](codon::pipeline::Record &&record) {
+        REQUIRE(record.index == next_index++);
+        codon::pipeline::write_record(out, record);
+      },
+      options)};
+  REQUIRE(summary.records == num_records);
+  REQUIRE(summary.batches == (num_records + 6) / 7);
+  REQUIRE(out.str() == expected.str());
+
+  // the first failure stops every stage and reaches the caller
+  std::istringstream failing_in(input);
+  REQUIRE_THROWS_AS(
+      codon::pipeline::run(
+          failing_in,
+          [](codon::pipeline::Record &&record) {
+            if (record.index == 100) throw std::runtime_error("transform");
+            return record.seq.get_seq_len();
+          },
+          [](std::size_t) {}, options),
+      std::runtime_error);
+  std::istringstream sink_in(input);
+  REQUIRE_THROWS_AS(codon::pipeline::run(
+                        sink_in,
+                        [](codon::pipeline::Record &&record) {
+                          return record.index;
+                        },
+                        [](std::size_t index) {
+                          if (index == 42) throw std::runtime_error("sink");
+                        },
+                        options),
+                    std::runtime_error);
+}
@@ -1,13 +1,19 @@
 #include <plog/Log.h>
 
 #include <algorithm>
+#include <atomic>
 #include <catch2/catch_test_macros.hpp>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <memory_resource>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "codon.h"
@@ -49,6 +55,45 @@ int test::seq_test() {
     test::check_insertions_codons(test_sequences, vec_codon);
     PLOGD << "Check insertions_codons completed";
 
+    test::check_insertions_seqs(test_sequences);
+    PLOGD << "Check insertions_seqs completed";
+
+    test::check_erasures(test_sequences);
+    PLOGD << "Check erasures completed";
+
+    for (int len : {1, 2, 3, 10, 67, 200}) {
+      test::check_apply_edits(test::random_bases(len));
+    }
+    PLOGD << "Check apply_edits completed";
+
+    test::check_locate(test_sequences);
+    PLOGD << "Check locate completed";
+
+    for (const codon::Seq &curr_seq : test_sequences) {
+      codon::Seq fragmented{curr_seq};
+      test::check_compact(fragmented);
+      fragmented.right_shift(0);
+      fragmented.insert_base(codon::base::G, codon::locator(3, 1));
+      fragmented.pop_base(codon::locator(7, 2));
+      test::check_compact(fragmented);
+      fragmented.right_shift(0);
+      fragmented.right_shift(0);
+      test::check_compact(fragmented);
+    }
+    PLOGD << "Check compact completed";
+
+    test::check_arena(arr_seq);
+    PLOGD << "Check arena completed";
+
+    test::check_small_buffer();
+    PLOGD << "Check small buffer completed";
+
+    test::check_capacity_policy();
+    PLOGD << "Check capacity policy completed";
+
+    test::check_move();
+    PLOGD << "Check move completed";
+
   } catch (std::invalid_argument &exception) {
     PLOGF << "Invalid argument supplied: " << exception.what();
     std::cerr << "Invalid argument supplied: " << exception.what();
@@ -70,7 +115,7 @@ std::vector<codon::Seq> test::seq_build(
   for (const std::string &seq : arr_sequences) {
     codon::Seq test_seq_temp = codon::Seq(seq);
     REQUIRE(test_seq_temp.get_seq_str() == seq);
-    vec_seq.push_back(test_seq_temp);
+    vec_seq.push_back(std::move(test_seq_temp));
   }
   // INFO: does not RVO in debug mode
   return vec_seq;
@@ -208,11 +253,17 @@ void test::check_insertions_codons(std::vector<codon::Seq> &vec_seq,
 
   int counter_seq{0};
   for (codon::Seq &curr_seq : vec_seq) {
+    // INFO: per sequence, a shorter one has no room for the earlier indices
+    vec_locators.clear();
     for (int i{0}; i < inserts.size(); ++i) {
+      std::size_t idx = randomiser::get_int(curr_seq.get_first_idx(),
+                                            curr_seq.get_last_idx());
+      // nothing is valid behind the last base
+      int max_shift{(idx == curr_seq.get_last_idx())
+                        ? curr_seq.get_codon_at(idx).get_bases_len()
+                        : 3};
       vec_locators.emplace_back(
-          codon::locator(randomiser::get_int(curr_seq.get_first_idx(),
-                                             curr_seq.get_last_idx()),
-                         randomiser::get_int(1, 3)));
+          codon::locator(idx, randomiser::get_int(1, max_shift)));
     }
 
     std::string message;
@@ -295,3 +346,515 @@ void test::check_insertion_codon(codon::Seq &seq, codon::Codon insert,
     REQUIRE(codonstr_before_insert == codonstr_post_removal);
   }
 }
+
+void test::check_insertions_seqs(const std::vector<codon::Seq> &vec_seq) {
+  for (const codon::Seq &curr_seq : vec_seq) {
+    for (int insert_len{1}; insert_len <= 7; ++insert_len) {
+      codon::Seq insert(test::random_bases(insert_len));
+      std::size_t idx = randomiser::get_int(curr_seq.get_first_idx(),
+                                            curr_seq.get_last_idx());
+      int len = curr_seq.get_codon_at(idx).get_bases_len();
+      if (len == 0) continue;
+      codon::locator locator(idx, randomiser::get_int(1, len));
+      check_insertion_seq(curr_seq, insert, locator);
+      // codon border, spliced as whole codons when the length fits
+      check_insertion_seq(curr_seq, insert,
+                          codon::locator(locator.index, 1));
+      check_insertion_seq(curr_seq, insert, curr_seq.get_last_loc());
+    }
+  }
+
+  // every overload, views with an offset frame and self insertion
+  codon::Seq test_seq("ACGTTGCAT");
+  codon::Seq insert("GGATCC");
+  std::string expected{"ACGTGGATCCTGCAT"};
+  codon::Seq copy_seq{test_seq};
+  copy_seq.insert_seq(insert, codon::locator(1, 2));
+  REQUIRE(copy_seq.get_seq_str() == expected);
+  copy_seq = test_seq;
+  copy_seq.insert_seq(codon::Seq("GGATCC"), codon::locator(1, 2));
+  REQUIRE(copy_seq.get_seq_str() == expected);
+  copy_seq = test_seq;
+  copy_seq.insert_seq(insert.slice(codon::locator(0, 2), codon::locator(1, 1)),
+                      codon::locator(0, 1));
+  REQUIRE(copy_seq.get_seq_str() == "GATACGTTGCAT");
+  copy_seq.insert_seq(copy_seq, copy_seq.get_first_loc());
+  REQUIRE(copy_seq.get_seq_str() == "GATACGTTGCATGATACGTTGCAT");
+  copy_seq.insert_seq(
+      copy_seq.slice(codon::locator(0, 2), codon::locator(0, 3)),
+      codon::locator(1, 1));
+  REQUIRE(copy_seq.get_seq_str() == "GATATACGTTGCATGATACGTTGCAT");
+  copy_seq.insert_seq(codon::Seq(""), codon::locator(1, 1));
+  REQUIRE(copy_seq.get_seq_str() == "GATATACGTTGCATGATACGTTGCAT");
+  REQUIRE_THROWS(copy_seq.insert_seq(insert, codon::locator(100, 1)));
+
+  // behind a partial last codon appends, like insert_base does
+  codon::Seq partial_seq("ACGTA");
+  check_insertion_seq(partial_seq, insert, codon::locator(1, 3));
+  REQUIRE_THROWS(partial_seq.insert_seq(insert, codon::locator(1, 0)));
+  codon::Seq appended{partial_seq};
+  appended.insert_seq(codon::Seq("GGA"), codon::locator(1, 3));
+  REQUIRE(appended.get_seq_str() == "ACGTAGGA");
+  std::string long_str(300, 'C');
+  codon::Seq long_seq(long_str);
+  appended.insert_seq(std::move(long_seq), appended.get_last_loc());
+  REQUIRE(appended.get_seq_str() == "ACGTAGG" + long_str + "A");
+  codon::Seq taken_over("ACGTA");
+  std::size_t num_allocations{taken_over.get_num_allocations()};
+  taken_over.insert_seq(codon::Seq(long_str), codon::locator(1, 3));
+  REQUIRE(taken_over.get_seq_str() == "ACGTA" + long_str);
+  REQUIRE(taken_over.get_seq_trulen("bp") == 305);
+  // the rvalue's heap block is taken over instead of allocating a new one
+  REQUIRE(taken_over.get_num_allocations() == num_allocations);
+  REQUIRE(!taken_over.is_inline());
+}
+
+void test::check_insertion_seq(codon::Seq seq, const codon::Seq &insert,
+                               codon::locator locator) {
+  std::size_t offset = locator.shift - 1;
+  for (std::size_t idx{0}; idx < locator.index; ++idx) {
+    offset += seq.get_codon_at(idx).get_bases_len();
+  }
+  std::string expected{seq.get_seq_str()};
+  expected.insert(offset, insert.get_seq_str());
+  PLOGD << "Inserting '" << insert.get_seq_str() << "' into location "
+        << locator.index << " with shift " << locator.shift;
+
+  seq.insert_seq(insert, locator);
+  REQUIRE(seq.get_seq_str() == expected);
+  REQUIRE(seq.get_seq_trulen("bp") == expected.length());
+}
+
+void test::check_erasures(const std::vector<codon::Seq> &vec_seq) {
+  for (const codon::Seq &curr_seq : vec_seq) {
+    for (int i{0}; i < 20; ++i) {
+      std::size_t first_idx = randomiser::get_int(curr_seq.get_first_idx(),
+                                                  curr_seq.get_last_idx());
+      std::size_t last_idx =
+          randomiser::get_int(first_idx, curr_seq.get_last_idx());
+      int first_len = curr_seq.get_codon_at(first_idx).get_bases_len();
+      int last_len = curr_seq.get_codon_at(last_idx).get_bases_len();
+      if (first_len == 0 || last_len == 0) continue;
+      codon::locator first(first_idx, randomiser::get_int(1, first_len));
+      codon::locator last(last_idx, randomiser::get_int(1, last_len));
+      if (first > last) std::swap(first, last);
+      check_erasure(curr_seq, first, last);
+    }
+    check_erasure(curr_seq, curr_seq.get_first_loc(), curr_seq.get_last_loc());
+    check_erasure(curr_seq, curr_seq.get_last_loc(), curr_seq.get_last_loc());
+  }
+
+  codon::Seq test_seq("ACGTTGCATGGA");
+  codon::Seq copy_seq{test_seq};
+  copy_seq.erase(codon::locator(1, 1), codon::locator(2, 3));
+  REQUIRE(copy_seq.get_seq_str() == "ACGGGA");
+  REQUIRE(copy_seq.get_seq_len() == 2);
+  copy_seq = test_seq;
+  copy_seq.erase(codon::locator(0, 2), codon::locator(0, 2));
+  REQUIRE(copy_seq.get_seq_str() == "AGTTGCATGGA");
+  REQUIRE(copy_seq.get_codon_at(codon::locator(0, 1)).is_full());
+  REQUIRE_THROWS(copy_seq.erase(codon::locator(1, 2), codon::locator(1, 1)));
+  REQUIRE_THROWS(copy_seq.erase(codon::locator(0, 1), codon::locator(9, 1)));
+}
+
+void test::check_erasure(codon::Seq seq, codon::locator first,
+                         codon::locator last) {
+  std::size_t offset_first = first.shift - 1;
+  std::size_t offset_last = last.shift - 1;
+  for (std::size_t idx{0}; idx < last.index; ++idx) {
+    std::size_t len = seq.get_codon_at(idx).get_bases_len();
+    if (idx < first.index) offset_first += len;
+    offset_last += len;
+  }
+  std::string expected{seq.get_seq_str()};
+  expected.erase(offset_first, offset_last - offset_first + 1);
+  PLOGD << "Erasing " << first.index << ":" << first.shift << " to "
+        << last.index << ":" << last.shift;
+
+  seq.erase(first, last);
+  REQUIRE(seq.get_seq_str() == expected);
+  REQUIRE(seq.get_seq_trulen("bp") == expected.length());
+}
+
+void test::check_apply_edits(const std::string &bases_str) {
+  /* random sorted edits on a fresh sequence, compared against the same
+   * edits applied to a string that also remembers where every base came
+   * from (-1 for inserted bases)
+   */
+  const std::string alphabet{"ACGT"};
+  std::vector<codon::Edit> edits;
+  std::string expected;
+  std::vector<long> origin;
+  std::size_t pos{0};
+  while (pos < bases_str.length()) {
+    codon::locator locator(pos / 3, pos % 3 + 1);
+    int choice = randomiser::get_int(0, 5);
+    std::size_t len = randomiser::get_int(1, 4);
+    if (choice == 0) {
+      std::string inserted;
+      for (std::size_t i{0}; i < len; ++i) {
+        inserted.push_back(alphabet[randomiser::get_int(0, 3)]);
+        origin.push_back(-1);
+      }
+      expected.append(inserted);
+      edits.push_back(codon::Edit::insertion(locator, inserted));
+      continue;  // the base at pos is still unprocessed
+    }
+    len = std::min(len, bases_str.length() - pos);
+    if (choice == 1) {
+      edits.push_back(codon::Edit::deletion(locator, len));
+    } else if (choice == 2) {
+      std::string substituted;
+      for (std::size_t i{0}; i < len; ++i) {
+        substituted.push_back(alphabet[randomiser::get_int(0, 3)]);
+        origin.push_back(pos + i);
+      }
+      expected.append(substituted);
+      edits.push_back(codon::Edit::substitution(locator, substituted));
+    } else {
+      expected.append(bases_str.substr(pos, len));
+      for (std::size_t i{0}; i < len; ++i) origin.push_back(pos + i);
+    }
+    pos += len;
+  }
+  // an insertion anchored behind the last base, as a VCF one on it would be
+  if (randomiser::get_int(0, 1)) {
+    std::size_t len = randomiser::get_int(1, 4);
+    std::string inserted;
+    for (std::size_t i{0}; i < len; ++i) {
+      inserted.push_back(alphabet[randomiser::get_int(0, 3)]);
+      origin.push_back(-1);
+    }
+    expected.append(inserted);
+    edits.push_back(codon::Edit::insertion(
+        codon::locator(pos / 3, pos % 3 + 1), inserted));
+  }
+
+  codon::Seq seq(bases_str);
+  codon::LiftoverMap liftover{seq.apply_edits(edits)};
+  REQUIRE(seq.get_seq_str() == expected);
+  REQUIRE(liftover.get_orig_len() == bases_str.length());
+  REQUIRE(liftover.get_new_len() == expected.length());
+
+  std::vector<std::optional<std::size_t>> expected_edited(bases_str.length());
+  for (std::size_t new_offset{0}; new_offset < origin.size(); ++new_offset) {
+    if (origin[new_offset] >= 0)
+      expected_edited[origin[new_offset]] = new_offset;
+    REQUIRE(liftover.to_original(new_offset) ==
+            ((origin[new_offset] >= 0)
+                 ? std::optional<std::size_t>(origin[new_offset])
+                 : std::nullopt));
+  }
+  std::vector<std::size_t> all_offsets(bases_str.length());
+  for (std::size_t offset{0}; offset < bases_str.length(); ++offset) {
+    all_offsets[offset] = offset;
+    REQUIRE(liftover.to_edited(offset) == expected_edited[offset]);
+  }
+  REQUIRE(liftover.to_edited(all_offsets) == expected_edited);
+
+  // unsorted or overlapping edits leave the sequence untouched
+  if (bases_str.length() >= 6) {
+    codon::Seq unchanged(bases_str);
+    REQUIRE_THROWS(unchanged.apply_edits(
+        {codon::Edit::substitution(codon::locator(1, 1), "A"),
+         codon::Edit::substitution(codon::locator(0, 1), "A")}));
+    REQUIRE_THROWS(unchanged.apply_edits(
+        {codon::Edit::deletion(codon::locator(0, 1), 4),
+         codon::Edit::insertion(codon::locator(1, 1), "A")}));
+    REQUIRE_THROWS(unchanged.apply_edits(
+        {codon::Edit::deletion(codon::locator(1, 1), bases_str.length())}));
+    REQUIRE(unchanged.get_seq_str() == bases_str);
+  }
+  codon::Seq appended("ACGTA");
+  appended.apply_edits({codon::Edit::insertion(codon::locator(1, 3), "GG")});
+  REQUIRE(appended.get_seq_str() == "ACGTAGG");
+  appended.apply_edits({codon::Edit::insertion(codon::locator(2, 2), "TG")});
+  REQUIRE(appended.get_seq_str() == "ACGTAGGTG");
+  appended.apply_edits({codon::Edit::substitution(codon::locator(0, 1), "T"),
+                        codon::Edit::insertion(codon::locator(3, 1), "C")});
+  REQUIRE(appended.get_seq_str() == "TCGTAGGTGC");
+  REQUIRE_THROWS(appended.apply_edits(
+      {codon::Edit::insertion(codon::locator(3, 3), "C")}));
+  REQUIRE_THROWS(appended.apply_edits(
+      {codon::Edit::substitution(codon::locator(3, 2), "C")}));
+  codon::Edit tampered{codon::Edit::substitution(codon::locator(0, 1), "A")};
+  tampered.bases = "N";
+  REQUIRE_THROWS_AS(appended.apply_edits({tampered}), std::invalid_argument);
+  REQUIRE(appended.get_seq_str() == "TCGTAGGTGC");
+  REQUIRE_THROWS(codon::Edit::insertion(codon::locator(0, 1), "ANT"));
+  REQUIRE_THROWS(codon::Edit::deletion(codon::locator(0, 1), 0));
+}
+
+void test::check_locate(const std::vector<codon::Seq> &vec_seq) {
+  for (const codon::Seq &curr_seq : vec_seq) {
+    codon::Seq shifted{curr_seq};
+    check_locate_seq(shifted);
+    // partial codons and a leading VOID switch to the Fenwick tree
+    shifted.right_shift(0);
+    shifted.insert_base(codon::base::T, codon::locator(5, 1));
+    check_locate_seq(shifted);
+    shifted.right_shift(0);
+    shifted.right_shift(0);
+    check_locate_seq(shifted);
+  }
+  codon::Seq empty_seq("");
+  REQUIRE_THROWS(empty_seq.locate(0));
+
+  // the first const calls after a change rebuild the layout together
+  codon::Seq shared_seq(test::random_bases(3000));
+  for (int round{0}; round < 20; ++round) {
+    // right_shift() leaves a partial codon, the layout is not canonical
+    shared_seq.right_shift(round * 7);
+    check_locate_concurrent(shared_seq);
+  }
+}
+
+void test::check_locate_concurrent(const codon::Seq &seq) {
+  std::atomic<std::size_t> failures{0};
+  std::vector<std::thread> workers;
+  for (int worker{0}; worker < 4; ++worker) {
+    workers.emplace_back([&, worker]() {
+      std::size_t len{seq.get_seq_trulen("bp")};
+      if (seq.is_canonical()) ++failures;
+      for (std::size_t pos = worker; pos < len; pos += 97) {
+        if (seq.offset_of(seq.locate(pos)) != pos) ++failures;
+      }
+      if (seq.bases_before(seq.get_seq_len()) != len) ++failures;
+    });
+  }
+  for (std::thread &worker : workers) worker.join();
+  // Catch2 assertions are not thread-safe, so they are checked here
+  REQUIRE(failures == 0);
+}
+
+void test::check_locate_seq(const codon::Seq &seq) {
+  std::string bases_str;
+  for (codon::base curr_base : seq.bases()) {
+    bases_str.push_back(codon::base_to_str(curr_base));
+  }
+  for (std::size_t pos{0}; pos < bases_str.length(); ++pos) {
+    codon::locator locator{seq.locate(pos)};
+    REQUIRE(seq.offset_of(locator) == pos);
+    REQUIRE(codon::base_to_str(seq.get_codon_at(locator).get_base_at(1)) ==
+            bases_str[pos]);
+  }
+  REQUIRE_THROWS(seq.locate(bases_str.length()));
+  REQUIRE_THROWS(seq.offset_of(codon::locator(seq.get_seq_len(), 1)));
+}
+
+void test::check_compact(codon::Seq seq) {
+  std::string bases_str;
+  for (codon::base curr_base : seq.bases()) {
+    bases_str.push_back(codon::base_to_str(curr_base));
+  }
+  seq.compact();
+  REQUIRE(seq.is_canonical());
+  REQUIRE(seq.get_seq_len() == (bases_str.length() + 2) / 3);
+  REQUIRE(seq.get_seq_trulen("bp") == bases_str.length());
+  REQUIRE(seq.get_seq_str() == bases_str);
+  check_locate_seq(seq);
+
+  // a second pass has nothing left to do
+  seq.compact();
+  REQUIRE(seq.get_seq_str() == bases_str);
+  codon::Seq spliced{seq};
+  spliced.insert_seq(seq, codon::locator(0, 1));
+  REQUIRE(spliced.get_seq_str() == bases_str + bases_str);
+}
+
+void test::check_arena(const std::vector<std::string> &vec_str) {
+  // the upstream refuses every request, so all storage must fit the buffer
+  alignas(std::max_align_t) static std::byte buffer[1 << 16];
+  std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                            std::pmr::null_memory_resource());
+  std::vector<codon::Seq> batch;
+  batch.reserve(vec_str.size());
+  for (const std::string &bases_str : vec_str) {
+    batch.emplace_back(bases_str, &arena);
+  }
+
+  for (std::size_t pos{0}; pos < batch.size(); ++pos) {
+    codon::Seq &arena_seq = batch[pos];
+    codon::Seq heap_seq(vec_str[pos]);
+    REQUIRE(arena_seq.get_resource() == &arena);
+    for (codon::Seq *seq : {&arena_seq, &heap_seq}) {
+      seq->insert_seq(codon::Seq("GATTACA"), codon::locator(1, 2));
+      seq->insert_seq(*seq, codon::locator(0, 1));
+      seq->erase(codon::locator(3, 2), codon::locator(6, 1));
+      seq->right_shift(0);
+      seq->locate(10);
+      seq->apply_edits(
+          {codon::Edit::substitution(codon::locator(2, 1), "TT"),
+           codon::Edit::insertion(codon::locator(4, 1), "C")});
+      seq->compact();
+    }
+    REQUIRE(arena_seq.get_seq_str() == heap_seq.get_seq_str());
+    REQUIRE(arena_seq.get_resource() == &arena);
+  }
+
+  // copies use the default resource unless told otherwise
+  codon::Seq heap_copy{batch.front()};
+  codon::Seq arena_copy(batch.front(), &arena);
+  REQUIRE(heap_copy.get_resource() == std::pmr::get_default_resource());
+  REQUIRE(arena_copy.get_resource() == &arena);
+  REQUIRE(arena_copy.get_seq_str() == batch.front().get_seq_str());
+}
+
+void test::check_small_buffer() {
+  constexpr std::size_t inline_codons{CODON_SEQ_INLINE_CODONS};
+  // short sequences never reach the resource, which would throw here
+  std::string primer_str{test::random_bases(3 * (inline_codons / 2))};
+  if (inline_codons >= 8) {
+    codon::Seq primer(primer_str, std::pmr::null_memory_resource());
+    primer.erase(codon::locator(0, 1), codon::locator(0, 2));
+    primer_str.erase(0, 2);
+    REQUIRE(primer.get_seq_str() == primer_str);
+    REQUIRE(primer.is_canonical());
+    REQUIRE(primer.locate(4) == codon::locator(1, 2));
+    REQUIRE(primer.is_inline());
+  }
+
+  // growing past the buffer spills over and compacting can move back
+  std::string bases_str{test::random_bases(3 * inline_codons / 2 + 6)};
+  codon::Seq seq(bases_str);
+  std::string long_str{test::random_bases(3 * inline_codons + 4)};
+  seq.insert_seq(codon::Seq(long_str), seq.get_last_loc());
+  bases_str.insert(bases_str.length() - 1, long_str);
+  REQUIRE(seq.get_seq_str() == bases_str);
+  REQUIRE(!seq.is_inline());
+  seq.erase(seq.locate(3), seq.locate(bases_str.length() - 4));
+  bases_str.erase(3, bases_str.length() - 6);
+  seq.compact();
+  REQUIRE(seq.get_seq_str() == bases_str);
+  REQUIRE(seq.is_inline() == (inline_codons > 0));
+
+  // copies own their buffer, the original stays intact
+  codon::Seq copy_seq{seq};
+  copy_seq.pop_base(copy_seq.get_first_loc());
+  REQUIRE(copy_seq.is_inline() == (inline_codons > 0));
+  REQUIRE(seq.get_seq_str() == bases_str);
+  copy_seq = codon::Seq(primer_str);
+  REQUIRE(copy_seq.get_seq_str() == primer_str);
+}
+
+void test::check_capacity_policy() {
+  constexpr std::size_t inline_codons{CODON_SEQ_INLINE_CODONS};
+  std::string bases_str{test::random_bases(3 * inline_codons + 18)};
+  codon::Seq grown(bases_str);
+  codon::Seq exact(bases_str, codon::CapacityPolicy::exact());
+  codon::Seq reserved(bases_str,
+                      codon::CapacityPolicy::reserve(inline_codons + 16));
+  // beyond the inline block construction never over-reserves
+  REQUIRE(grown.get_capacity() == inline_codons + 6);
+  REQUIRE(exact.get_capacity() == inline_codons + 6);
+  REQUIRE(reserved.get_capacity() == inline_codons + 16);
+  for (codon::Seq *seq : {&grown, &exact, &reserved}) {
+    REQUIRE(seq->get_num_allocations() == 1);
+  }
+
+  // every base ripples to the back and eventually needs a new codon
+  for (int round{0}; round < 30; ++round) {
+    for (codon::Seq *seq : {&grown, &exact, &reserved}) {
+      seq->insert_base(codon::base::G, codon::locator(0, 1));
+    }
+    bases_str.insert(0, "G");
+  }
+  for (codon::Seq *seq : {&grown, &exact, &reserved}) {
+    REQUIRE(seq->get_seq_str() == bases_str);
+    REQUIRE(seq->get_seq_len() == inline_codons + 16);
+  }
+  REQUIRE(grown.get_num_allocations() == 2);
+  REQUIRE(grown.get_capacity() ==
+          static_cast<std::size_t>(std::ceil((inline_codons + 7) * 1.2)));
+  REQUIRE(exact.get_num_allocations() == 11);
+  REQUIRE(exact.get_capacity() == inline_codons + 16);
+  REQUIRE(reserved.get_num_allocations() == 1);
+
+  // insert_codon grows a sequence without room left
+  codon::Seq full_seq(test::random_bases(3 * inline_codons + 18));
+  full_seq.insert_codon(codon::Codon("TTA"), codon::locator(10, 2));
+  REQUIRE(full_seq.get_seq_len() == inline_codons + 7);
+  REQUIRE(full_seq.get_capacity() ==
+          static_cast<std::size_t>(std::ceil((inline_codons + 7) * 1.2)));
+
+  // a short read takes the whole inline block and grows inside it
+  if constexpr (inline_codons >= 12) {
+    for (codon::CapacityPolicy policy :
+         {codon::CapacityPolicy::growth(), codon::CapacityPolicy::exact()}) {
+      codon::Seq short_read(test::random_bases(30), policy);
+      codon::Seq short_copy{short_read};
+      short_read.right_shift(0);
+      short_read.insert_base(codon::base::G, codon::locator(9, 3));
+      short_copy.insert_codon(codon::Codon("TTA"), codon::locator(4, 2));
+      for (codon::Seq *seq : {&short_read, &short_copy}) {
+        REQUIRE(seq->is_inline());
+        REQUIRE(seq->get_num_allocations() == 1);
+      }
+    }
+    codon::Seq refilled{std::string()};
+    refilled.assign(test::random_bases(30));
+    refilled.insert_codon(codon::Codon("TTA"), codon::locator(4, 2));
+    REQUIRE(refilled.is_inline());
+    REQUIRE(refilled.get_num_allocations() == 1);
+  }
+
+  full_seq.set_capacity_policy(codon::CapacityPolicy::reserve(200));
+  REQUIRE(full_seq.get_capacity() >= 200);
+  REQUIRE(full_seq.get_capacity_policy().growth_factor == 1.0);
+  REQUIRE_THROWS(codon::CapacityPolicy::growth(0.5));
+}
+
+void test::check_move() {
+  constexpr std::size_t inline_codons{CODON_SEQ_INLINE_CODONS};
+  std::string short_str{test::random_bases(inline_codons)};
+  std::string long_str{test::random_bases(3 * inline_codons + 30)};
+
+  // heap storage changes hands, inline codons are copied over
+  codon::Seq long_seq(long_str);
+  codon::Seq moved_long{std::move(long_seq)};
+  REQUIRE(moved_long.get_seq_str() == long_str);
+  REQUIRE(moved_long.get_num_allocations() == 0);
+  REQUIRE(long_seq.get_seq_len() == 0);
+  codon::Seq short_seq(short_str);
+  codon::Seq moved_short{std::move(short_seq)};
+  REQUIRE(moved_short.get_seq_str() == short_str);
+  REQUIRE(moved_short.is_inline() == (inline_codons > 0));
+
+  // assignment across memory resources falls back to copying
+  std::pmr::monotonic_buffer_resource arena;
+  codon::Seq arena_seq(short_str, &arena);
+  arena_seq = std::move(moved_long);
+  REQUIRE(arena_seq.get_seq_str() == long_str);
+  REQUIRE(arena_seq.get_resource() == &arena);
+  moved_short = std::move(arena_seq);
+  REQUIRE(moved_short.get_seq_str() == long_str);
+  REQUIRE(moved_short.get_resource() == std::pmr::get_default_resource());
+
+  // apply_edits() hands its result over instead of allocating again
+  codon::Seq edited_seq(long_str, codon::CapacityPolicy::exact());
+  std::size_t allocations{edited_seq.get_num_allocations()};
+  edited_seq.apply_edits(
+      {codon::Edit::insertion(codon::locator(1, 2), std::string(30, 'G'))});
+  REQUIRE(edited_seq.get_seq_str() ==
+          long_str.substr(0, 4) + std::string(30, 'G') + long_str.substr(4));
+  REQUIRE(edited_seq.get_num_allocations() == allocations);
+  codon::Seq edited_short(short_str);
+  edited_short.apply_edits({codon::Edit::deletion(codon::locator(0, 1), 3)});
+  REQUIRE(edited_short.get_seq_str() == short_str.substr(3));
+  REQUIRE(edited_short.is_inline() == (inline_codons > 0));
+
+  // an attached LiftoverMap follows the content
+  codon::LiftoverMap liftover(long_str.length());
+  moved_short.attach_liftover(liftover);
+  codon::Seq recorder{std::move(moved_short)};
+  recorder.pop_base(recorder.get_first_loc());
+  REQUIRE(liftover.get_new_len() == long_str.length() - 1);
+
+  // growing a vector relocates sequences instead of copying them
+  std::vector<codon::Seq> batch;
+  for (int count{0}; count < 40; ++count) batch.emplace_back(long_str);
+  for (const codon::Seq &seq : batch) {
+    REQUIRE(seq.get_seq_str() == long_str);
+  }
+  REQUIRE(batch.front().get_num_allocations() == 0);
+}
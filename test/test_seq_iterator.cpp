@@ -0,0 +1,101 @@
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "codon.h"
+#include "kmer.h"
+#include "random.h"
+#include "seq.h"
+#include "testing.h"
+
+int test::seq_iterator_test() {
+  for (int len{1}; len < 40; ++len) {
+    std::string bases_str{test::random_bases(len)};
+    codon::Seq curr_seq(bases_str);
+    check_seq_iteration(curr_seq, bases_str);
+
+    // leading VOID after a right_shift is skipped by every iterator
+    if (curr_seq.get_seq_len() > 1) {
+      curr_seq.right_shift(0);
+      check_seq_iteration(curr_seq, curr_seq.get_seq_str());
+    }
+  }
+  PLOGD << "Seq iteration over random sequences passed";
+
+  codon::Seq empty_seq("");
+  REQUIRE(empty_seq.begin() == empty_seq.end());
+  REQUIRE(empty_seq.bases().begin() == empty_seq.bases().end());
+  REQUIRE(empty_seq.kmers(3).begin() == empty_seq.kmers(3).end());
+
+  codon::Seq short_seq("ACG");
+  REQUIRE(short_seq.kmers(4).begin() == short_seq.kmers(4).end());
+  REQUIRE_THROWS(short_seq.kmers(33));
+
+  codon::Seq sorted_seq("TTTGGGAAA");
+  REQUIRE(std::is_sorted(sorted_seq.begin(), sorted_seq.end(),
+                         [](const codon::Codon &left,
+                            const codon::Codon &right) {
+                           return left.get_bases_str() > right.get_bases_str();
+                         }));
+  REQUIRE(std::count(sorted_seq.bases().begin(), sorted_seq.bases().end(),
+                     codon::base::A) == 3);
+
+  // popping a whole codon can leave an interior VOID: A VOID TTG CA GGA
+  codon::Seq popped_seq("ACGTTTGCAGGA");
+  popped_seq.right_shift(2);
+  popped_seq.right_shift(2);
+  popped_seq.pop_codon(codon::locator(1, 1), 3);
+  REQUIRE(popped_seq.get_codon_at(codon::locator(1, 1)).is_empty());
+  REQUIRE(popped_seq.get_seq_str() == "ATTGCAGGA");
+  std::string forward;
+  for (const codon::Codon &curr_codon : popped_seq) {
+    REQUIRE(!curr_codon.is_empty());
+    forward.append(curr_codon.get_bases_str());
+  }
+  REQUIRE(forward == "ATTGCAGGA");
+  REQUIRE(std::distance(popped_seq.begin(), popped_seq.end()) == 4);
+  std::string backward;
+  for (codon::codon_iterator it{popped_seq.end()}; it != popped_seq.begin();) {
+    backward.append((--it)->get_bases_str());
+  }
+  REQUIRE(backward == "GGACATTGA");
+  PLOGD << "Seq iteration edge cases passed";
+  return 0;
+}
+
+void test::check_seq_iteration(const codon::Seq &seq,
+                               const std::string &expected) {
+  std::string from_bases;
+  for (codon::base curr_base : seq.bases()) {
+    from_bases.push_back(codon::base_to_str(curr_base));
+  }
+  REQUIRE(from_bases == expected);
+
+  std::string from_codons;
+  for (const codon::Codon &curr_codon : seq) {
+    from_codons.append(curr_codon.get_bases_str());
+  }
+  REQUIRE(from_codons == expected);
+  REQUIRE(static_cast<std::size_t>(std::distance(seq.begin(), seq.end())) ==
+          seq.get_seq_trulen("codons"));
+  REQUIRE(seq.begin()->get_bases_str() ==
+          seq.get_codon_at(seq.get_first_idx()).get_bases_str());
+
+  for (int k : {1, 3, 7}) {
+    for (bool use_canonical : {false, true}) {
+      std::vector<std::uint64_t> expected_kmers;
+      codon::kmer::for_each_kmer(
+          expected, k, use_canonical,
+          [&](std::uint64_t kmer) { expected_kmers.push_back(kmer); });
+      codon::kmer_range range{seq.kmers(k, use_canonical)};
+      std::vector<std::uint64_t> kmers(range.begin(), range.end());
+      REQUIRE(kmers == expected_kmers);
+    }
+  }
+}
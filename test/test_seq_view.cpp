@@ -0,0 +1,93 @@
+#include <plog/Log.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "codon.h"
+#include "kmer.h"
+#include "seq.h"
+#include "testing.h"
+
+int test::seq_view_test() {
+  for (std::size_t len{1}; len < 25; ++len) {
+    std::string bases_str{test::random_bases(len)};
+    codon::Seq curr_seq(bases_str);
+    for (std::size_t first_base{0}; first_base < len; ++first_base) {
+      for (std::size_t last_base{first_base}; last_base < len; ++last_base) {
+        check_seq_view(curr_seq, bases_str, first_base, last_base);
+      }
+    }
+  }
+  PLOGD << "SeqView over every window of random sequences passed";
+
+  codon::Seq test_seq("ACGTTGCA");
+  codon::SeqView window{test_seq.slice(codon::locator(0, 2),
+                                       codon::locator(2, 1))};
+  REQUIRE(window.get_frame() == 1);
+  REQUIRE(window.get_seq_str() == "CGTTGC");
+  REQUIRE(window.get_codon_at(codon::locator(0, 2)).get_bases_str() == "CG");
+  REQUIRE(window.get_codon_at(codon::locator(2, 1)).get_bases_str() == "C");
+  REQUIRE(window.get_seq_bin().size() == 3);
+  REQUIRE(window.slice(codon::locator(1, 1), codon::locator(1, 3))
+              .get_seq_str() == "TTG");
+  REQUIRE(&window.get_parent() == &test_seq);
+
+  // locators outside of the parent, the view or in reversed order
+  REQUIRE_THROWS(test_seq.slice(codon::locator(0, 1), codon::locator(2, 3)));
+  REQUIRE_THROWS(test_seq.slice(codon::locator(3, 1), codon::locator(3, 1)));
+  REQUIRE_THROWS(test_seq.slice(codon::locator(1, 2), codon::locator(1, 1)));
+  REQUIRE_THROWS(test_seq.slice(codon::locator(0, 0), codon::locator(1, 1)));
+  REQUIRE_THROWS(window.get_codon_at(codon::locator(0, 1)));
+  REQUIRE_THROWS(window.slice(codon::locator(0, 2), codon::locator(2, 2)));
+  REQUIRE_THROWS(window.get_seq_trulen("nucleotides"));
+
+  // partial codon after a right_shift: only the bases it holds are valid
+  test_seq.right_shift(0);
+  codon::locator first_loc{test_seq.get_first_loc()};
+  REQUIRE_THROWS(test_seq.slice(codon::locator(0, 3), codon::locator(1, 1)));
+  REQUIRE(test_seq.slice(first_loc, test_seq.get_last_loc()).get_seq_str() ==
+          test_seq.get_seq_str());
+  PLOGD << "SeqView edge cases passed";
+  return 0;
+}
+
+void test::check_seq_view(const codon::Seq &seq, const std::string &bases_str,
+                          std::size_t first_base, std::size_t last_base) {
+  // freshly built sequences hold full codons, so positions map directly
+  codon::locator first(first_base / 3, first_base % 3 + 1);
+  codon::locator last(last_base / 3, last_base % 3 + 1);
+  std::string expected{
+      bases_str.substr(first_base, last_base - first_base + 1)};
+  codon::SeqView view{seq.slice(first, last)};
+
+  REQUIRE(view.get_seq_str() == expected);
+  REQUIRE(view.get_frame() == static_cast<int>(first_base % 3));
+  REQUIRE(view.get_seq_trulen("bp") == expected.length());
+  REQUIRE(view.get_seq_len() == last.index - first.index + 1);
+  REQUIRE(view.get_codon_at(first).get_bases_len() ==
+          ((first.index == last.index) ? last.shift : 3) - first.shift + 1);
+
+  std::string from_bin;
+  for (const std::bitset<8> &bits : view.get_seq_bin()) {
+    std::uint8_t raw = static_cast<std::uint8_t>(bits.to_ulong());
+    int len = (raw >= 0b01000000) ? 3 : (raw >= 0b00010000) ? 2 : 1;
+    for (int pos{len - 1}; pos >= 0; --pos) {
+      from_bin.push_back(
+          codon::base_to_str(static_cast<codon::base>((raw >> (2 * pos)) & 3)));
+    }
+  }
+  REQUIRE(from_bin == expected);
+
+  for (int k : {1, 4}) {
+    std::vector<std::uint64_t> expected_kmers;
+    codon::kmer::for_each_kmer(
+        expected, k, true,
+        [&](std::uint64_t kmer) { expected_kmers.push_back(kmer); });
+    codon::kmer_range range{view.kmers(k, true)};
+    std::vector<std::uint64_t> kmers(range.begin(), range.end());
+    REQUIRE(kmers == expected_kmers);
+  }
+}
@@ -0,0 +1,84 @@
+#include <plog/Log.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "seq.h"
+#include "stats.h"
+#include "testing.h"
+
+int test::stats_test() {
+  codon::stats::reset();
+  codon::stats::Snapshot empty{codon::stats::snapshot()};
+  for (std::uint64_t curr : empty.counters) REQUIRE(curr == 0);
+  REQUIRE(std::string(codon::stats::name(codon::stats::counter::void_codons)) ==
+          "void_codons");
+  REQUIRE(std::string(codon::stats::name(codon::stats::method::pop_codon)) ==
+          "pop_codon");
+
+  check_stats_counters();
+  PLOGD << "Seq operation counters passed";
+  check_stats_threads(4, 50);
+  PLOGD << "Seq operation counters across threads passed";
+  return 0;
+}
+
+void test::check_stats_counters() {
+  using codon::stats::counter;
+  using codon::stats::method;
+  codon::Seq seq("ATGCATGCATGCATGCATGCATGCATGCAT",
+                 codon::CapacityPolicy::exact());
+  codon::stats::Snapshot before{codon::stats::snapshot()};
+
+  // three shifts empty the first codon and grow the storage once
+  for (int idx{0}; idx < 3; ++idx) seq.right_shift(0);
+  seq.insert_codon(codon::Codon("GAT"), codon::locator(4, 2));
+  codon::stats::Snapshot delta{codon::stats::snapshot() - before};
+
+  if (!codon::stats::enabled) {
+    for (std::uint64_t curr : delta.counters) REQUIRE(curr == 0);
+    REQUIRE(delta.get(method::right_shift).calls == 0);
+    return;
+  }
+  REQUIRE(delta.get(counter::shifted_codons) >= 3 * 10);
+  REQUIRE(delta.get(counter::void_codons) >= 1);
+  REQUIRE(delta.get(counter::reallocations) >= 1);
+  REQUIRE(delta.get(counter::mid_inserts) >= 1);
+  REQUIRE(delta.get(counter::mid_insert_codons) >=
+          delta.get(counter::mid_inserts));
+  // the VOID in front is skipped by every scan from the first shift on
+  REQUIRE(delta.get(counter::first_idx_scans) >= 2);
+  REQUIRE(delta.get(method::right_shift).calls == 3);
+  REQUIRE(delta.get(method::insert_codon).calls == 1);
+  REQUIRE(delta.get(method::pop_base).calls == 0);
+
+  std::ostringstream out;
+  out << delta;
+  REQUIRE(out.str().find("right_shift") != std::string::npos);
+  REQUIRE(out.str().find("pop_base") == std::string::npos);
+}
+
+void test::check_stats_threads(unsigned threads, int shifts) {
+  codon::stats::Snapshot before{codon::stats::snapshot()};
+  // the random generator is shared, so inputs are drawn up front
+  std::vector<std::string> inputs;
+  for (unsigned idx{0}; idx < threads; ++idx) {
+    inputs.push_back(test::random_bases(300));
+  }
+  std::vector<std::thread> workers;
+  for (unsigned idx{0}; idx < threads; ++idx) {
+    workers.emplace_back([shifts, &input = inputs[idx]] {
+      codon::Seq seq(input);
+      for (int shift{0}; shift < shifts; ++shift) seq.right_shift(0);
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  codon::stats::Snapshot delta{codon::stats::snapshot() - before};
+  std::uint64_t expected = codon::stats::enabled ? threads * shifts : 0;
+  REQUIRE(delta.get(codon::stats::method::right_shift).calls == expected);
+}
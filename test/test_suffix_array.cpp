@@ -0,0 +1,161 @@
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "random.h"
+#include "seq.h"
+#include "suffix_array.h"
+#include "testing.h"
+
+int test::suffix_array_test() {
+  std::vector<std::string> arr_seq{"GATTACA", "ACGTACGT", "", "AAAAAAAA",
+                                   test::random_bases(500)};
+  check_suffix_array(arr_seq, 1);
+  PLOGD << "SuffixArray small collection passed";
+
+  // large enough to run the radix sorts with several threads
+  std::vector<std::string> arr_large;
+  for (int i{0}; i < 400; ++i) {
+    arr_large.emplace_back(test::random_bases(randomiser::get_int(0, 300)));
+  }
+  arr_large.emplace_back(std::string(2000, 'A'));
+  check_suffix_array(arr_large, 4);
+  PLOGD << "SuffixArray parallel construction passed";
+
+  std::vector<codon::Seq> vec_seq{seq_build(arr_seq)};
+  codon::index::SuffixArray suffix_array(vec_seq);
+  const std::string path{"codon_test_suffix_array.bin"};
+  suffix_array.save(path);
+  {
+    codon::index::SuffixArray loaded{codon::index::SuffixArray::load(path)};
+    REQUIRE(loaded.size() == suffix_array.size());
+    REQUIRE(loaded.has_lcp());
+    for (std::size_t i{0}; i < loaded.size(); ++i) {
+      REQUIRE(loaded.get_sa(i) == suffix_array.get_sa(i));
+      REQUIRE(loaded.get_lcp(i) == suffix_array.get_lcp(i));
+    }
+  }
+  std::remove(path.c_str());
+  PLOGD << "SuffixArray save/load roundtrip passed";
+
+  check_corrupt_suffix_array(suffix_array);
+  PLOGD << "SuffixArray corrupt images rejected";
+  return 0;
+}
+
+void test::check_corrupt_suffix_array(
+    const codon::index::SuffixArray &suffix_array) {
+  const std::string path{"codon_test_suffix_array_corrupt.bin"};
+  suffix_array.save(path);
+  std::string image;
+  {
+    std::ifstream file(path, std::ios::binary);
+    image.assign(std::istreambuf_iterator<char>(file),
+                 std::istreambuf_iterator<char>());
+  }
+  // writes image with the 64-bit header field at offset replaced, see
+  // sa_header, and cut to image_len bytes
+  auto write_corrupt = [&](std::size_t offset, std::uint64_t value,
+                           std::size_t image_len) {
+    std::string corrupt{image.substr(0, image_len)};
+    std::memcpy(corrupt.data() + offset, &value, sizeof(value));
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(corrupt.data(), static_cast<std::streamsize>(image_len));
+  };
+  const std::size_t text_len{16};
+  const std::size_t num_seqs{24};
+  const std::size_t has_lcp{32};
+  const std::size_t off_starts{40};
+  const std::size_t off_sa{48};
+  const std::size_t off_lcp{56};
+  const std::uint64_t image_len{image.size()};
+
+  // the large sizes wrap around 2^64 once multiplied by the element size
+  const std::vector<std::pair<std::size_t, std::uint64_t>> fields{
+      {text_len, 1ULL << 62},
+      {text_len, image_len},
+      {num_seqs, 1ULL << 61},
+      {num_seqs, ~0ULL},
+      {num_seqs, image_len / 8},
+      {has_lcp, 2},
+      {off_starts, image_len - 8},
+      {off_starts, 4},
+      {off_sa, ~0ULL - 3},
+      {off_sa, 66},
+      {off_lcp, image_len - 4},
+      {off_lcp, 1ULL << 63}};
+  for (const auto &[offset, value] : fields) {
+    write_corrupt(offset, value, image.size());
+    REQUIRE_THROWS_AS(codon::index::SuffixArray::load(path),
+                      std::runtime_error);
+  }
+  write_corrupt(has_lcp, 1, image.size() - 4);
+  REQUIRE_THROWS_AS(codon::index::SuffixArray::load(path), std::runtime_error);
+  write_corrupt(has_lcp, 1, image.size());
+  REQUIRE(codon::index::SuffixArray::load(path).size() == suffix_array.size());
+  std::remove(path.c_str());
+}
+
+void test::check_suffix_array(const std::vector<std::string> &arr_seq,
+                              unsigned threads) {
+  // reference text: separators rank by sequence id below every base
+  std::vector<std::uint32_t> text;
+  for (std::size_t seq_id{0}; seq_id < arr_seq.size(); ++seq_id) {
+    for (char character : arr_seq[seq_id]) {
+      std::uint32_t lex = (character == 'A')   ? 0
+                          : (character == 'C') ? 1
+                          : (character == 'G') ? 2
+                                               : 3;
+      text.push_back(static_cast<std::uint32_t>(arr_seq.size()) + lex);
+    }
+    text.push_back(static_cast<std::uint32_t>(seq_id));
+  }
+
+  std::vector<std::size_t> expected(text.size());
+  for (std::size_t i{0}; i < expected.size(); ++i) expected[i] = i;
+  std::sort(expected.begin(), expected.end(),
+            [&](std::size_t left, std::size_t right) {
+              return std::lexicographical_compare(
+                  text.begin() + left, text.end(), text.begin() + right,
+                  text.end());
+            });
+
+  std::vector<codon::Seq> vec_seq;
+  for (const std::string &seq : arr_seq) vec_seq.emplace_back(seq);
+  codon::index::sa_options options;
+  options.threads = threads;
+  codon::index::SuffixArray suffix_array(vec_seq, options);
+
+  REQUIRE(suffix_array.size() == text.size());
+  REQUIRE(suffix_array.get_stats().peak_bytes > 0);
+  if (text.size() > 40000) REQUIRE(suffix_array.get_stats().threads == threads);
+  for (std::size_t rank{0}; rank < expected.size(); ++rank) {
+    REQUIRE(suffix_array.get_sa(rank) == expected[rank]);
+    std::size_t lcp{0};
+    if (rank > 0) {
+      std::size_t left = expected[rank - 1];
+      std::size_t right = expected[rank];
+      while (left + lcp < text.size() && right + lcp < text.size() &&
+             text[left + lcp] == text[right + lcp] &&
+             text[left + lcp] >= arr_seq.size()) {
+        ++lcp;
+      }
+    }
+    REQUIRE(suffix_array.get_lcp(rank) == lcp);
+  }
+
+  codon::index::hit last = suffix_array.get_hit(text.size() - 1);
+  REQUIRE(last.seq_id == arr_seq.size() - 1);
+  REQUIRE(last.offset == arr_seq.back().size());
+}
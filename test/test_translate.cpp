@@ -0,0 +1,55 @@
+#include <plog/Log.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "codon.h"
+#include "seq.h"
+#include "testing.h"
+#include "translate.h"
+
+int test::translate_test() {
+  REQUIRE(codon::translate_codon(codon::Codon("ATG")) == 'M');
+  REQUIRE(codon::translate_codon(codon::Codon("TGG")) == 'W');
+  REQUIRE(codon::translate_codon(codon::Codon("TAA")) == '*');
+  REQUIRE(codon::translate_codon(codon::Codon("TAG")) == '*');
+  REQUIRE(codon::translate_codon(codon::Codon("TGA")) == '*');
+  REQUIRE(codon::translate_codon(codon::Codon("GGC")) == 'G');
+  REQUIRE(codon::translate_codon(codon::Codon("CTT")) == 'L');
+  REQUIRE_THROWS_AS(codon::translate_codon(codon::Codon("AT")),
+                    std::invalid_argument);
+
+  REQUIRE(codon::translate(codon::Seq("ATGGCCATTGTAATGGGCCGCTGA")) ==
+          "MAIVMGR*");
+  // a trailing partial codon is dropped
+  REQUIRE(codon::translate(codon::Seq("ATGTTTAA")) == "MF");
+  REQUIRE(codon::translate(codon::Seq("AT")).empty());
+
+  for (std::size_t len : {3, 30, 31, 32, 299}) {
+    check_translation(test::random_bases(len));
+  }
+  PLOGD << "Translation passed";
+  return 0;
+}
+
+void test::check_translation(const std::string &bases_str) {
+  codon::Seq seq(bases_str);
+  std::string expected{codon::translate(seq)};
+  REQUIRE(expected.length() == bases_str.length() / 3);
+  for (std::size_t idx{0}; idx < expected.length(); ++idx) {
+    REQUIRE(expected[idx] ==
+            codon::translate_codon(codon::Codon(bases_str.substr(3 * idx, 3))));
+  }
+
+  // shifted layouts are re-framed from the first base
+  codon::Seq fragmented{seq};
+  fragmented.right_shift(0);
+  codon::locator middle{fragmented.locate(bases_str.length() / 2)};
+  fragmented.insert_base(codon::base::G, middle);
+  fragmented.pop_base(middle);
+  REQUIRE(fragmented.get_seq_str() == bases_str);
+  REQUIRE(codon::translate(fragmented) == expected);
+}
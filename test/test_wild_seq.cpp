@@ -0,0 +1,203 @@
+#include <plog/Log.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "codon.h"
+#include "parallel.h"
+#include "random.h"
+#include "seq.h"
+#include "testing.h"
+#include "translate.h"
+#include "wild_seq.h"
+
+namespace {
+
+bool is_acgt(char symbol) {
+  switch (std::toupper(static_cast<unsigned char>(symbol))) {
+    case 'A':
+    case 'C':
+    case 'G':
+    case 'T':
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::string to_upper(std::string symbols) {
+  for (char& curr : symbols) {
+    curr = static_cast<char>(std::toupper(static_cast<unsigned char>(curr)));
+  }
+  return symbols;
+}
+
+}  // namespace
+
+int test::wild_seq_test() {
+  check_wild_codon();
+  PLOGD << "WildCodon passed";
+
+  // pure input keeps no runs at all
+  codon::WildSeq pure("ACGTTGCA");
+  REQUIRE(!pure.is_wild());
+  REQUIRE(pure.get_seq_str() == "ACGTTGCA");
+
+  codon::WildSeq wild("ACNNNNNNNNGTRYa-c");
+  REQUIRE(wild.get_runs().size() == 4);
+  REQUIRE(wild.get_runs()[0].first == 2);
+  REQUIRE(wild.get_runs()[0].length == 8);
+  REQUIRE(wild.get_runs()[0].symbol == 'N');
+  REQUIRE(wild.get_num_wild() == 11);
+  REQUIRE(wild.get_seq_str() == "ACNNNNNNNNGTRYA-C");
+  REQUIRE(wild.get_seq().get_seq_str() == "ACAAAAAAAAGTAAAAC");
+  REQUIRE(wild.count_bases() == std::array<std::size_t, 4>{2, 1, 2, 1});
+
+  REQUIRE_THROWS_AS(wild.assign("ACGXT"), std::invalid_argument);
+  REQUIRE(wild.get_seq_len() == 0);
+  REQUIRE(wild.get_seq_str().empty());
+  REQUIRE_THROWS_AS(codon::WildSeq("AC GT"), std::invalid_argument);
+
+  // short stretches around runs, N-runs like in assemblies and all of it
+  const std::string symbols{"ACGTRYSWKMBDHVN-acgtn"};
+  for (int round{0}; round < 20; ++round) {
+    std::string input;
+    while (input.length() < 300) {
+      int kind = randomiser::get_int(0, 9);
+      if (kind < 6) {
+        input += test::random_bases(randomiser::get_int(1, 40));
+      } else if (kind < 8) {
+        input += std::string(randomiser::get_int(1, 30), 'N');
+      } else {
+        input += symbols[randomiser::get_int(0, symbols.length() - 1)];
+      }
+    }
+    check_wild_seq(input);
+  }
+  check_wild_seq("");
+  check_wild_seq("N");
+  check_wild_seq("NNNNNNN");
+  check_wild_seq(test::random_bases(100));
+  PLOGD << "WildSeq against its input passed";
+
+  // long enough for the block-parallel kernels underneath
+  std::string large{test::random_bases(3 * CODON_PARALLEL_MIN_CODONS)};
+  large.replace(1000, 50000, 50000, 'N');
+  large.replace(400001, 7, "RYKMSW-");
+  check_wild_seq(large);
+  PLOGD << "Large WildSeq passed";
+  return 0;
+}
+
+void test::check_wild_codon() {
+  for (char symbol : std::string("-AGRCMSVTWKDYHBN")) {
+    REQUIRE(codon::iupac_symbol(codon::iupac_mask(symbol)) == symbol);
+  }
+  REQUIRE(codon::iupac_mask('y') == codon::iupac_mask('Y'));
+  REQUIRE(codon::iupac_mask('X') == codon::INVALID_MASK);
+
+  codon::WildCodon ctn("CTN");
+  REQUIRE(ctn.is_wild());
+  REQUIRE(ctn.get_bases_str() == "CTN");
+  REQUIRE(ctn.count_expansions() == 4);
+  REQUIRE(ctn.matches(codon::Codon("CTG")));
+  REQUIRE(!ctn.matches(codon::Codon("CAG")));
+  REQUIRE(!ctn.matches(codon::Codon("CT")));
+  REQUIRE_THROWS_AS(ctn.to_codon(), std::invalid_argument);
+  REQUIRE(codon::WildCodon("rY").get_bases_str() == "RY");
+  REQUIRE(codon::WildCodon("A-G").count_expansions() == 0);
+
+  codon::WildCodon exact{codon::Codon("GAT")};
+  REQUIRE(!exact.is_wild());
+  REQUIRE(exact.to_codon().get_bases_str() == "GAT");
+  REQUIRE_THROWS_AS(codon::WildCodon("ACGT"), std::invalid_argument);
+  REQUIRE_THROWS_AS(codon::WildCodon("AXG"), std::invalid_argument);
+  REQUIRE_THROWS_AS(exact.get_mask_at(4), std::invalid_argument);
+  // Codon no longer drops what it cannot store
+  REQUIRE_THROWS_AS(codon::Codon("ANG"), std::invalid_argument);
+
+  REQUIRE(codon::translate_codon(ctn) == 'L');
+  REQUIRE(codon::translate_codon(codon::WildCodon("TAR")) == '*');
+  REQUIRE(codon::translate_codon(codon::WildCodon("YTA")) == 'L');
+  REQUIRE(codon::translate_codon(codon::WildCodon("ATN")) == 'X');
+  REQUIRE(codon::translate_codon(codon::WildCodon("NNN")) == 'X');
+  REQUIRE(codon::translate_codon(codon::WildCodon("---")) == '-');
+  REQUIRE(codon::translate_codon(codon::WildCodon("CT-")) == 'X');
+  REQUIRE(codon::translate_codon(exact) == 'D');
+  REQUIRE_THROWS_AS(codon::translate_codon(codon::WildCodon("CN")),
+                    std::invalid_argument);
+}
+
+void test::check_wild_seq(const std::string &input) {
+  codon::WildSeq seq(input);
+  std::string expected{to_upper(input)};
+  REQUIRE(seq.get_seq_len() == input.length());
+  REQUIRE(seq.get_seq_str() == expected);
+
+  std::array<std::size_t, 4> counts{};
+  std::size_t num_wild{0};
+  for (char symbol : expected) {
+    if (is_acgt(symbol)) {
+      ++counts[codon::iupac_mask(symbol) == 1   ? codon::base::A
+               : codon::iupac_mask(symbol) == 2 ? codon::base::G
+               : codon::iupac_mask(symbol) == 4 ? codon::base::C
+                                                : codon::base::T];
+    } else {
+      ++num_wild;
+    }
+  }
+  REQUIRE(seq.count_bases() == counts);
+  REQUIRE(seq.get_num_wild() == num_wild);
+
+  // single positions and codons are checked on a sample for large inputs
+  std::size_t step{std::max<std::size_t>(1, input.length() / 5000)};
+  for (std::size_t pos{0}; pos < input.length(); pos += step) {
+    REQUIRE(seq.get_symbol_at(pos) == expected[pos]);
+  }
+  for (std::size_t idx{0}; 3 * idx < input.length(); idx += step) {
+    REQUIRE(seq.get_codon_at(idx).get_bases_str() ==
+            expected.substr(3 * idx, 3));
+  }
+  REQUIRE_THROWS_AS(seq.get_symbol_at(input.length()), std::out_of_range);
+
+  for (int round{0}; round < 200 && !input.empty(); ++round) {
+    std::size_t first = randomiser::get_int(0, input.length() - 1);
+    std::size_t last = first + randomiser::get_int(0, 60);
+    last = std::min(last, input.length());
+    bool pure{true};
+    for (std::size_t pos{first}; pos < last; ++pos) {
+      pure = pure && is_acgt(expected[pos]);
+    }
+    REQUIRE(seq.is_pure(first, last) == pure);
+  }
+
+  // the stretches between runs, at least 4 bases long
+  std::vector<std::string> stretches;
+  std::string curr;
+  for (char symbol : expected + '-') {
+    if (is_acgt(symbol)) {
+      curr += symbol;
+      continue;
+    }
+    if (curr.length() >= 4) stretches.push_back(curr);
+    curr.clear();
+  }
+  std::vector<codon::SeqView> slices{seq.pure_slices(4)};
+  REQUIRE(slices.size() == stretches.size());
+  for (std::size_t idx{0}; idx < slices.size(); ++idx) {
+    REQUIRE(slices[idx].get_seq_str() == stretches[idx]);
+  }
+
+  std::string protein{codon::translate(seq)};
+  REQUIRE(protein.length() == input.length() / 3);
+  for (std::size_t idx{0}; idx < protein.length(); idx += step) {
+    REQUIRE(protein[idx] == codon::translate_codon(codon::WildCodon(
+                                expected.substr(3 * idx, 3))));
+  }
+}